@@ -0,0 +1,126 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "slam_viewer/core/PointTypes.h"
+#include "slam_viewer/ui/CloudUI.hpp"
+
+using namespace slam_viewer;
+
+/// 改造前的颜色映射，int转为无符号数后取模，负数同样落在颜色表内；超出int范围或非有限的输入为未定义行为
+static Vec4 LegacyIntensityToRgbPCL(const float &intensity) {
+    int index = int(intensity * 6);
+    index = index % intensity_table_.size();
+    return intensity_table_[index];
+}
+
+/// 改造前的PCL颜色工厂，使用索引数组驱动并行for_each
+template <typename PointType> class LegacyPCLColor : public ColorFactory<PointType> {
+public:
+    typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
+
+    LegacyPCLColor(PointCloudPtr cloud)
+        : ColorFactory<PointType>(cloud) {}
+
+    void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
+        cloud_color.resize(this->cloud_->size());
+
+        std::vector<int> idx(this->cloud_->size());
+        std::iota(idx.begin(), idx.end(), 0);
+
+        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
+            cloud_color[id] = LegacyIntensityToRgbPCL(this->cloud_->points[id].intensity);
+        });
+    }
+};
+
+/// 改造前的height颜色工厂
+template <typename PointType> class LegacyHeightColor : public ColorFactory<PointType> {
+public:
+    typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
+
+    LegacyHeightColor(PointCloudPtr cloud)
+        : ColorFactory<PointType>(cloud) {}
+
+    void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
+        cloud_color.resize(this->cloud_->size());
+
+        std::vector<int> idx(this->cloud_->size());
+        std::iota(idx.begin(), idx.end(), 0);
+
+        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
+            cloud_color[id] = LegacyIntensityToRgbPCL(this->cloud_->points[id].z * 10);
+        });
+    }
+};
+
+/**
+ * @brief 重复执行func，返回每秒处理的点数（百万点）
+ *
+ * @param func          输入的待测函数
+ * @param point_num     输入的单次处理的点数
+ * @param repeat        输入的重复次数
+ * @return double       输出的吞吐量，单位为百万点每秒
+ */
+template <typename Func> double MeasureThroughput(Func func, std::size_t point_num, int repeat) {
+    func();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i)
+        func();
+    std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+    return point_num * repeat / cost.count() * 1e-6;
+}
+
+int main(int argc, char **argv) {
+    std::size_t point_num = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    int repeat = argc > 2 ? std::stoi(argv[2]) : 50;
+
+    /// 1. 构造模拟的激光点云，高度可以为负数
+    pcl::PointCloud<PointXYZI>::Ptr cloud = pcl::make_shared<pcl::PointCloud<PointXYZI>>();
+    cloud->resize(point_num);
+
+    std::mt19937 engine(0);
+    std::uniform_real_distribution<float> xy_dist(-100.f, 100.f), z_dist(-5.f, 20.f), intensity_dist(0.f, 255.f);
+    for (auto &pt : cloud->points) {
+        pt.x = xy_dist(engine);
+        pt.y = xy_dist(engine);
+        pt.z = z_dist(engine);
+        pt.intensity = intensity_dist(engine);
+    }
+
+    std::vector<Vec3> cloud_xyz;
+    std::vector<Vec4> cloud_color;
+
+    /// 2. 对比改造前的工厂、改造后的工厂和直接调用Colorize三种方式
+    auto benchmark = [&](const std::string &name, ColorFactory<PointXYZI>::Ptr legacy,
+                         ColorFactory<PointXYZI>::Ptr factory, auto colorizer) {
+        double legacy_speed = MeasureThroughput([&]() { legacy->CreateColor(cloud_xyz, cloud_color); }, point_num,
+                                                repeat);
+        double factory_speed = MeasureThroughput([&]() { factory->CreateColor(cloud_xyz, cloud_color); }, point_num,
+                                                 repeat);
+        double colorize_speed = MeasureThroughput([&]() { Colorize<PointXYZI>(*cloud, cloud_color, colorizer); },
+                                                  point_num, repeat);
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8) << name << "  legacy: " << legacy_speed
+                  << " Mpts/s  factory: " << factory_speed << " Mpts/s  colorize: " << colorize_speed
+                  << " Mpts/s  speedup: " << colorize_speed / legacy_speed << "x" << std::endl;
+    };
+
+    /// 3. 校验改造后的映射与改造前逐位一致，高度包含负数
+    BuildIntensityTable();
+    std::size_t mismatch = 0;
+    for (const auto &pt : cloud->points) {
+        if (LegacyIntensityToRgbPCL(pt.intensity) != IntensityToRgbPCL(pt.intensity) ||
+            LegacyIntensityToRgbPCL(pt.z * 10) != IntensityToRgbPCL(pt.z * 10))
+            ++mismatch;
+    }
+    std::cout << "mismatched colors: " << mismatch << std::endl;
+
+    benchmark("PCL", std::make_shared<LegacyPCLColor<PointXYZI>>(cloud), std::make_shared<PCLColor<PointXYZI>>(cloud),
+              PCLColorizer());
+    benchmark("Height", std::make_shared<LegacyHeightColor<PointXYZI>>(cloud),
+              std::make_shared<HeightColor<PointXYZI>>(cloud), HeightColorizer());
+
+    return 0;
+}
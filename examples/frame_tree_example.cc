@@ -0,0 +1,42 @@
+#include "slam_viewer/ui/FrameTreeUI.h"
+#include "slam_viewer/core/WindowImpl.h"
+
+using namespace slam_viewer;
+
+int main(int argc, char **argv) {
+    /// 1. 创建坐标系树，车体坐标系下挂载雷达和相机，另有500个静止的路标坐标系
+    auto frame_tree = std::make_shared<FrameTreeUI>(3.0);
+    frame_tree->AddFrame("base", "", SE3(), 2.0);
+    frame_tree->AddFrame("lidar", "base", SE3(SO3(), Vec3(0.0, 0.0, 1.5)), 0.5);
+    frame_tree->AddFrame("camera", "lidar", SE3(SO3(), Vec3(0.5, 0.0, -0.3)), 0.3);
+    for (int i = 0; i < 500; ++i) {
+        Vec3 position(20.0 * std::cos(i * 0.1), 20.0 * std::sin(i * 0.1), 0.05 * i);
+        frame_tree->AddFrame("landmark_" + std::to_string(i), "", SE3(SO3(), position), 0.5);
+    }
+
+    /// 2. 创建一个可视化窗口
+    auto viewer = std::make_shared<WindowImpl>();
+    auto camera = std::make_shared<Camera>("camera");
+    auto view3d = std::make_shared<View3D>("view3d");
+    viewer->AddView(view3d, 0, 1, 0, 1);
+
+    view3d->SetCamera(camera);
+    view3d->AddUIItem(frame_tree);
+
+    std::thread viewer_thread(&WindowImpl::Run, viewer);
+
+    /// 3. 只修改车体坐标系，雷达和相机随子树一起更新，路标坐标系不会被重新计算和上传
+    int base_id = frame_tree->FindFrame("base");
+    Eigen::AngleAxisf delta_r(0.01 * M_PI, Vec3(0.0, 0.0, 1.0));
+    SE3 Twb;
+    for (int i = 0; i < 1000; ++i) {
+        Twb.so3() = Twb.so3() * SO3(delta_r.toRotationMatrix());
+        Twb.translation() += Vec3(0.01, 0, 0);
+        frame_tree->SetTransform(base_id, Twb);
+        std::this_thread::sleep_for(10ms);
+    }
+
+    viewer_thread.join();
+
+    return 0;
+}
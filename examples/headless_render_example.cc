@@ -0,0 +1,36 @@
+#include "slam_viewer/core/WindowImpl.h"
+#include "slam_viewer/ui/BoxUI.h"
+
+using namespace slam_viewer;
+
+int main(int argc, char **argv) {
+    std::string output_dir = argc > 1 ? argv[1] : ".";
+
+    /// 1. 创建一个Bounding Box
+    SE3 Twi;
+    BoxUI::Ptr box_ui = std::make_shared<BoxUI>(Twi, 5, 2, 1.5);
+
+    /// 2. 创建一个无窗口的可视化后端，不需要显示器，可以使用Mesa的软件渲染
+    auto viewer = std::make_shared<WindowImpl>("Headless", 640, 480, WindowImpl::Backend::Headless);
+    auto view3d = std::make_shared<View3D>("3D View");
+    auto camera = std::make_shared<Camera>("Camera", SE3(), true, 640, 480);
+    viewer->AddView(view3d, 0, 1, 0, 1);
+    view3d->AddUIItem(box_ui);
+    view3d->SetCamera(camera);
+
+    /// 3. 在当前线程中逐帧渲染并保存图像，不经过事件循环
+    Eigen::AngleAxisf delta_r(0.02 * M_PI, Vec3(0.0, 0.0, 1.0));
+    SO3 delta_R(delta_r.toRotationMatrix());
+    cv::Mat image;
+    for (int i = 0; i < 100; ++i) {
+        Twi.so3() = Twi.so3() * delta_R;
+        box_ui->ResetTwi(Twi);
+        viewer->RenderOnce(image);
+
+        char filename[32];
+        std::snprintf(filename, sizeof(filename), "/frame_%04d.png", i);
+        cv::imwrite(output_dir + filename, image);
+    }
+
+    return 0;
+}
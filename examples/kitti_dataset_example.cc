@@ -1,19 +1,19 @@
 #include <pcl/filters/impl/voxel_grid.hpp>
 
-#include "slam_viewer/ui/CloudUI.hpp"
 #include "slam_viewer/ui/CoordinateUI.h"
-#include "slam_viewer/ui/FrameUI.h"
+#include "slam_viewer/ui/KeyframeSetUI.h"
 #include "slam_viewer/core/ImageShower.h"
 #include "KittiHelper/KittiHelper.h"
 #include "slam_viewer/core/PointTypes.h"
+#include "slam_viewer/ui/ScanWindowUI.hpp"
 #include "slam_viewer/ui/TrajectoryUI.h"
 #include "slam_viewer/core/WindowImpl.h"
 
 using namespace slam_viewer;
 
 /// 配置菜单函数
-void ConfigMenu(Menu::Ptr menu, Camera::Ptr camera) {
-    assert(menu && camera && "menu or camera is nullptr!");
+void ConfigMenu(Menu::Ptr menu, Camera::Ptr camera, View3D::Ptr view_3d) {
+    assert(menu && camera && view_3d && "menu, camera or view_3d is nullptr!");
 
     /// 4.1 follow 相机跟踪模式
     menu->AddCheckBoxItem("Follow", [=](bool checked) {
@@ -40,6 +40,9 @@ void ConfigMenu(Menu::Ptr menu, Camera::Ptr camera) {
             camera->SetFree();
         }
     });
+
+    /// 4.4 隐藏相机frame分组
+    menu->AddCheckBoxItem("Hide Frames", [=](bool checked) { view_3d->SetGroupVisible("frames", !checked); });
 }
 
 /// 进行点云体素滤波，缩小点云体积
@@ -87,6 +90,8 @@ int main(int argc, char **argv) {
     auto lidar_coord = std::make_shared<CoordinateUI>(0.2, Twl0);
     auto camera_coord = std::make_shared<CoordinateUI>(0.2, Twc0);
     auto lidar_trajectory = std::make_shared<TrajectoryUI>(Vec3(1.0, 0.1, 0.1), 3.0, 3.0);
+    auto scan_window = std::make_shared<ScanWindowUI>(20); ///< 仅保留最近20帧点云
+    auto camera_frames = std::make_shared<KeyframeSetUI>(Vec3(0, 1, 0), 3); ///< 全部相机frame，一次实例化绘制
 
     auto viewer = std::make_shared<WindowImpl>("KITTI Viewer");             ///< 窗口操作句柄
     auto camera = std::make_shared<Camera>("camera", lidar_coord);          ///< 相机操作句柄
@@ -95,11 +100,14 @@ int main(int argc, char **argv) {
     auto view_plotter = std::make_shared<Plotter>("plotter");               ///< 绘图空间
     auto view_image = std::make_shared<ImageShower>("image", 2, 1, 30, 10); ///< 图片显示空间
 
+    /// 常驻元素不参与自动淘汰，相机frame放在frames分组中，可以通过菜单隐藏
     view_3d->SetCamera(camera);
-    view_3d->AddUIItem(world_coord);
-    view_3d->AddUIItem(lidar_coord);
-    view_3d->AddUIItem(camera_coord);
-    view_3d->AddUIItem(lidar_trajectory);
+    view_3d->AddUIItem(world_coord, "", false);
+    view_3d->AddUIItem(lidar_coord, "", false);
+    view_3d->AddUIItem(camera_coord, "", false);
+    view_3d->AddUIItem(lidar_trajectory, "", false);
+    view_3d->AddUIItem(scan_window, "", false);
+    view_3d->AddUIItem(camera_frames, "frames", false);
 
     viewer->AddView(view_menu, 0, 1, 0.0, 0.1);
     viewer->AddView(view_3d, 0, 1, 0.1, 0.8);
@@ -107,7 +115,7 @@ int main(int argc, char **argv) {
     viewer->AddView(view_image, 0, 0, 0, 0);
 
     /// 4. 配置菜单、绘图和图片显示空间，配置后布局无法改变
-    ConfigMenu(view_menu, camera);
+    ConfigMenu(view_menu, camera, view_3d);
 
     view_plotter->AddPlotterItem("lidar_position", {"lx", "ly", "lz"}, -10, 600, -100, 100, 74, 10);
     view_plotter->AddPlotterItem("camera_position", {"cx", "cy", "cz"}, -10, 600, -100, 100, 74, 10);
@@ -130,18 +138,14 @@ int main(int argc, char **argv) {
         SE3 Twc = Twc0 * db.Tcc;
 
         auto point_cloud = FuseRingClouds(db.pointclouds_);
-        auto frame_ui = std::make_shared<FrameUI>(Twc0 * db.Tcc, Vec3(0, 1, 0), 3); ///< frame ui 设置
-        auto cloud_ui = std::make_shared<CloudUI>();                                ///< cloud ui 设置
 
         /// 各种ui的数据更新设置
         auto gray_factory = std::make_shared<GrayColor<PointXYZRT>>(point_cloud);
-        cloud_ui->SetCloud<PointXYZRT>(point_cloud, Twl0 * db.Tll, gray_factory);
+        scan_window->AddScan<PointXYZRT>(point_cloud, Twl, gray_factory, db.stamp_);
         camera_coord->ResetTwi(Twc);
         lidar_coord->ResetTwi(Twl);
         lidar_trajectory->AddPt(Twl);
-
-        view_3d->AddUIItem(frame_ui);
-        view_3d->AddUIItem(cloud_ui);
+        camera_frames->AddKeyframe(Twc);
 
         /// 图像区域更新
         cv::Mat left_image, right_image;
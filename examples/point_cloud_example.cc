@@ -11,8 +11,8 @@
 
 using namespace slam_viewer;
 
-void ConfigMenu(Menu::Ptr menu, Camera::Ptr camera) {
-    assert(menu && camera && "menu or camera is nullptr!");
+void ConfigMenu(Menu::Ptr menu, Camera::Ptr camera, ColorMap::Ptr color_map) {
+    assert(menu && camera && color_map && "menu, camera or color_map is nullptr!");
 
     /// 4.1 follow 相机跟踪模式
     menu->AddCheckBoxItem("Follow", [=](bool checked) {
@@ -33,6 +33,17 @@ void ConfigMenu(Menu::Ptr menu, Camera::Ptr camera) {
         if (pushed)
             camera->SetModelView(pangolin::ModelViewLookAt(-50, 0, 10, 0, 0, 0, pangolin::AxisZ));
     });
+
+    /// 4.4 切换颜色映射模式，仅修改着色器参数，不会重新上传点云
+    menu->AddCheckBoxItem("Height Color", [=](bool checked) {
+        if (checked) {
+            color_map->SetMode(ColorMap::Mode::Height);
+            color_map->SetRange(-3, 10);
+        } else {
+            color_map->SetMode(ColorMap::Mode::Scalar);
+            color_map->SetRange(0, 64);
+        }
+    });
 }
 
 int main(int argc, char **argv) {
@@ -45,8 +56,9 @@ int main(int argc, char **argv) {
     /// 2. 创建一个点云UI
     SE3 Twi;
     CloudUI::Ptr cloud_ui = std::make_shared<CloudUI>();
-    ColorFactory<PointXYZR>::Ptr ring_factory = std::make_shared<RingColor<PointXYZR>>(cloud_ptr);
-    cloud_ui->SetCloud<PointXYZR>(cloud_ptr, Twi, ring_factory);
+    ColorMap::Ptr color_map = std::make_shared<ColorMap>(ColorMap::Mode::Scalar, 0, 64);
+    cloud_ui->SetColorMap(color_map);
+    cloud_ui->SetScalarCloud<PointXYZR>(cloud_ptr, Twi, RingScalar());
 
     /// 3. 创建一个可视化窗口和3d可视化和菜单可视化
     auto viewer = std::make_shared<WindowImpl>();
@@ -60,7 +72,7 @@ int main(int argc, char **argv) {
     viewer->AddView(menu, 0, 1, 0, 0.2);
 
     /// 4. 对菜单进行配置
-    ConfigMenu(menu, camera);
+    ConfigMenu(menu, camera, color_map);
 
     std::thread viewer_thread(&WindowImpl::Run, viewer);
 
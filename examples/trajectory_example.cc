@@ -6,6 +6,7 @@
 #include <Eigen/Geometry>
 
 #include "slam_viewer/core/PointTypes.h"
+#include "slam_viewer/ui/StampedTrajectoryUI.h"
 #include "slam_viewer/ui/TrajectoryUI.h"
 #include "slam_viewer/core/WindowImpl.h"
 
@@ -19,6 +20,7 @@ int main(int argc, char **argv) {
     std::string line_str;
 
     std::vector<SE3> trajectory_array;
+    std::vector<double> stamp_array;
     while (std::getline(fin, line_str)) {
         std::stringstream ss(line_str);
         double stamp;
@@ -28,25 +30,33 @@ int main(int argc, char **argv) {
 
         SE3 Twi(qwi, twi);
         trajectory_array.push_back(Twi);
+        stamp_array.push_back(stamp);
     }
 
     /// 2. 创建一个轨迹UI
     TrajectoryUI::Ptr trajectory_ui = std::make_shared<TrajectoryUI>();
 
+    /// 带时间戳的轨迹UI，按速度着色，切换着色通道不需要重新上传
+    auto stamped_ui = std::make_shared<StampedTrajectoryUI>();
+    stamped_ui->SetColorMap(std::make_shared<ColorMap>(ColorMap::Mode::Scalar, 0.f, 20.f, 1.f));
+    stamped_ui->SetColorChannel(StampedTrajectoryUI::ColorChannel::Speed);
+
     /// 3. 创建一个可视化窗口
     auto viewer = std::make_shared<WindowImpl>();
     auto view3d = std::make_shared<View3D>("view 3d");
     auto camera = std::make_shared<Camera>("camera");
     view3d->AddUIItem(trajectory_ui);
+    view3d->AddUIItem(stamped_ui);
     view3d->SetCamera(camera);
     viewer->AddView(view3d, 0, 1, 0, 1);
 
     std::thread viewer_thread(&WindowImpl::Run, viewer);
 
     /// 测试AddPt函数
-    for (const auto &Twi : trajectory_array) {
-        trajectory_ui->AddPt(Twi.translation());
-        
+    for (std::size_t i = 0; i < trajectory_array.size(); ++i) {
+        trajectory_ui->AddPt(trajectory_array[i].translation());
+        stamped_ui->AddPose(stamp_array[i], trajectory_array[i]);
+
         std::this_thread::sleep_for(1ms);
     }
 
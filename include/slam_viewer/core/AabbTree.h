@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+
+#include "slam_viewer/core/Frustum.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 动态包围盒层次树（BVH），叶子节点保存放大后的包围盒和用户数据
+ * @details
+ *      1. 插入时按表面积启发式选择兄弟节点，插入和删除后沿父节点向上通过旋转保持平衡，代价为O(log n)
+ *      2. 叶子节点的包围盒按一定余量放大，包围盒在余量范围内变化时不需要修改树，增量增长的几何体均摊代价为O(1)
+ *      3. 视锥体查询时，完全在视锥体内的子树不再逐个判断，查询代价与可见的叶子数量成正比
+ */
+class AabbTree {
+public:
+    static constexpr std::int32_t kNull = -1;   ///< 空节点
+    static constexpr float kMarginRatio = 0.1f; ///< 包围盒放大的相对余量
+    static constexpr float kMinMargin = 0.1f;   ///< 包围盒放大的最小余量（米）
+
+    AabbTree() = default;
+
+    /// 插入叶子节点，返回节点编号
+    std::int32_t Insert(const Eigen::AlignedBox3f &box, std::uint32_t user);
+
+    /// 删除叶子节点
+    void Remove(std::int32_t proxy);
+
+    /// 移动叶子节点，包围盒超出放大余量或明显缩小时重新插入，返回是否修改了树
+    bool Move(std::int32_t proxy, const Eigen::AlignedBox3f &box);
+
+    /// 叶子节点的数量
+    std::size_t Size() const { return leaf_num_; }
+
+    /// 根节点的子树高度，空树和只有一个叶子节点时为0
+    std::int32_t Height() const { return root_ == kNull ? 0 : nodes_[root_].height_; }
+
+    /**
+     * @brief 查询与视锥体相交的叶子节点
+     *
+     * @tparam Callback 回调函数类型，参数为叶子节点的用户数据
+     * @param frustum   输入的视锥体
+     * @param callback  输入的回调函数
+     */
+    template <typename Callback> void Query(const Frustum &frustum, Callback &&callback) const {
+        if (root_ == kNull)
+            return;
+
+        stack_.clear();
+        stack_.emplace_back(root_, false);
+        while (!stack_.empty()) {
+            auto [id, inside] = stack_.back();
+            stack_.pop_back();
+
+            const Node &node = nodes_[id];
+            if (!inside) {
+                if (!frustum.Intersects(node.box_))
+                    continue;
+                inside = frustum.Contains(node.box_);
+            }
+
+            if (node.IsLeaf()) {
+                callback(node.user_);
+                continue;
+            }
+            stack_.emplace_back(node.left_, inside);
+            stack_.emplace_back(node.right_, inside);
+        }
+    }
+
+private:
+    /// 树节点，空闲节点通过parent_串成链表
+    struct Node {
+        Eigen::AlignedBox3f box_;     ///< 包围盒，叶子节点为放大后的包围盒
+        std::int32_t parent_ = kNull; ///< 父节点，空闲节点为下一个空闲节点
+        std::int32_t left_ = kNull;   ///< 左子节点，叶子节点为kNull
+        std::int32_t right_ = kNull;  ///< 右子节点，叶子节点为kNull
+        std::int32_t height_ = 0;     ///< 子树高度，叶子节点为0，空闲节点为-1
+        std::uint32_t user_ = 0;      ///< 用户数据
+
+        bool IsLeaf() const { return left_ == kNull; }
+    };
+
+    /// 包围盒的表面积，插入代价的启发式度量
+    static float SurfaceArea(const Eigen::AlignedBox3f &box);
+
+    /// 按余量放大包围盒
+    static Eigen::AlignedBox3f Fatten(const Eigen::AlignedBox3f &box);
+
+    /// 分配节点，可能导致nodes_重新分配
+    std::int32_t AllocateNode();
+
+    /// 释放节点
+    void FreeNode(std::int32_t id);
+
+    /// 将叶子节点插入树中
+    void InsertLeaf(std::int32_t leaf);
+
+    /// 将叶子节点从树中摘除，节点本身不释放
+    void RemoveLeaf(std::int32_t leaf);
+
+    /// 从节点开始向上修正高度和包围盒，并进行平衡旋转
+    void Refit(std::int32_t id);
+
+    /// 子树高度差超过1时进行旋转，返回旋转后该位置的子树根节点
+    std::int32_t Balance(std::int32_t id);
+
+    std::vector<Node> nodes_;        ///< 节点池
+    std::int32_t root_ = kNull;      ///< 根节点
+    std::int32_t free_list_ = kNull; ///< 空闲节点链表
+    std::size_t leaf_num_ = 0;       ///< 叶子节点的数量
+
+    mutable std::vector<std::pair<std::int32_t, bool>> stack_; ///< 查询时的遍历栈，复用以避免每帧分配
+};
+
+} // namespace slam_viewer
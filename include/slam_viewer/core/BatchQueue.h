@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+
+namespace slam_viewer {
+
+/**
+ * @brief 无锁多生产者单消费者批次队列，用于生产者线程向渲染线程追加数据
+ * @details
+ *      1. 生产者将批次以CAS压入无锁栈，不会被渲染线程阻塞
+ *      2. 渲染线程通过一次原子交换取走全部批次，反转后按照压入顺序处理
+ *      3. 每个批次只分配一个节点，批次内的数据由生产者在锁外准备好后移动进来
+ * @tparam T 批次类型
+ */
+template <typename T> class BatchQueue {
+public:
+    BatchQueue()
+        : head_(nullptr) {}
+
+    BatchQueue(const BatchQueue &) = delete;
+
+    BatchQueue &operator=(const BatchQueue &) = delete;
+
+    ~BatchQueue() {
+        Drain([](T &&) {});
+    }
+
+    /// 压入一个批次，任意非渲染线程调用
+    void Push(T value) {
+        Node *node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next_, node, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    /// 队列是否为空
+    bool Empty() const { return head_.load(std::memory_order_relaxed) == nullptr; }
+
+    /**
+     * @brief 取走全部批次，按照压入顺序依次交给func处理，仅消费者线程调用
+     *
+     * @param func          输入的批次处理函数，参数为T&&
+     * @return std::size_t  输出的处理的批次数量
+     */
+    template <typename Func> std::size_t Drain(Func func) {
+        Node *node = head_.exchange(nullptr, std::memory_order_acquire);
+
+        Node *ordered = nullptr;
+        while (node) {
+            Node *next = node->next_;
+            node->next_ = ordered;
+            ordered = node;
+            node = next;
+        }
+
+        std::size_t count = 0;
+        while (ordered) {
+            Node *next = ordered->next_;
+            func(std::move(ordered->value_));
+            delete ordered;
+            ordered = next;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    /// 无锁栈节点
+    struct Node {
+        T value_;    ///< 批次数据
+        Node *next_; ///< 下一个节点
+    };
+
+    std::atomic<Node *> head_; ///< 栈顶
+};
+
+} // namespace slam_viewer
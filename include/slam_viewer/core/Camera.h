@@ -57,6 +57,9 @@ public:
     /// 仅渲染线程可用，设置相机的视图矩阵
     void SetModelView(pangolin::OpenGlMatrix model_view) { render_state_.SetModelViewMatrix(std::move(model_view)); }
 
+    /// 设置所在窗口的帧调度器，相机状态变化时请求重绘，在View3D中使用
+    void SetScheduler(FrameScheduler::Ptr scheduler) { std::atomic_store(&scheduler_, std::move(scheduler)); }
+
 private:
     /// 创建渲染状态，初始化过程使用，非线程安全
     void CreateRenderState() {
@@ -71,6 +74,12 @@ private:
     /// 当绑定View发生变化时，保证相机渲染不会产生缩放，仅允许渲染线程使用
     void Keep3dScale();
 
+    /// 请求所在窗口重绘
+    void RequestRedraw() {
+        if (auto scheduler = std::atomic_load(&scheduler_))
+            scheduler->RequestRedraw();
+    }
+
     UIItem::Ptr follow_item_;                  ///< 相机跟踪的可视化元素
     pangolin::OpenGlRenderState render_state_; ///< 相机的opengl渲染参数
     std::string camera_name_;                  ///< 相机名称
@@ -78,6 +87,7 @@ private:
     std::mutex render_pose_mutex_;             ///< 渲染位姿互斥量
     SE3 camera_fixed_Twi_;                     ///< 固定的相机位姿
     std::string bind_display_name_;            ///< 绑定渲染的View名称
+    FrameScheduler::Ptr scheduler_;            ///< 帧调度器，通过std::atomic_load/atomic_store访问
 
     float last_render_width_;  ///< 上一次渲染窗口的宽度
     float last_render_height_; ///< 上一次渲染窗口的高度
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <functional>
+
+#include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/DynamicBuffer.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief GPU颜色映射，每个点只上传一个标量，在着色器中通过一维颜色表映射为颜色
+ * @details
+ *      同一ColorMap可以被多个ui_item共享，映射参数变化时通过使用者注册的回调请求重绘，
+ *      保证按需重绘的渲染循环不会停留在旧的颜色上
+ */
+class ColorMap {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    typedef std::shared_ptr<ColorMap> Ptr;
+    typedef std::shared_ptr<const ColorMap> ConstPtr;
+
+    /// 颜色映射模式
+    enum class Mode {
+        Scalar, ///< 标量经颜色表映射
+        Height, ///< 世界坐标系下的高度经颜色表映射，由着色器计算，不依赖上传的标量
+        Gray    ///< 标量映射为灰度
+    };
+
+    ColorMap(Mode mode = Mode::Scalar, float min_value = 0.f, float max_value = 255.f, float alpha = 0.5f);
+
+    /// 设置映射模式，任意线程调用，不会触发重新上传，只通知使用者重绘
+    void SetMode(Mode mode) {
+        mode_.store(mode);
+        NotifyListeners();
+    }
+
+    /// 设置映射范围，任意线程调用，不会触发重新上传，只通知使用者重绘
+    void SetRange(float min_value, float max_value) {
+        min_value_.store(min_value);
+        max_value_.store(max_value);
+        NotifyListeners();
+    }
+
+    /// 设置透明度，任意线程调用，只通知使用者重绘
+    void SetAlpha(float alpha) {
+        alpha_.store(alpha);
+        NotifyListeners();
+    }
+
+    /// 注册映射参数变化时的回调，同一owner重复注册时替换原回调，使用该ColorMap的ui_item在SetColorMap中调用
+    void AddListener(const void *owner, std::function<void()> callback);
+
+    /// 注销owner注册的回调，ui_item更换ColorMap或析构时调用，返回后回调不会再被调用
+    void RemoveListener(const void *owner);
+
+    /// 获取映射模式
+    Mode GetMode() const { return mode_.load(); }
+
+    /// 绑定着色器和颜色表，首次调用时创建，仅渲染线程调用
+    void Bind();
+
+    /// 设置模型矩阵，即顶点坐标到世界坐标系的变换，Height模式使用，仅渲染线程调用
+    void SetModel(const Mat4 &model);
+
+    /// 将标量缓冲区绑定到着色器的标量属性，仅渲染线程调用
+    void BindScalar(const DynamicBuffer &scalar_buffer) { BindScalar(scalar_buffer, scalar_buffer.DataType(), 0, 0); }
+
+    /// 将交错存储的缓冲区中的标量字段绑定到着色器的标量属性，仅渲染线程调用
+    void BindScalar(const DynamicBuffer &buffer, GLenum datatype, GLsizei stride, std::size_t offset);
+
+    /// 解绑标量属性，仅渲染线程调用
+    void UnbindScalar();
+
+    /// 解绑着色器和颜色表，仅渲染线程调用
+    void Unbind();
+
+private:
+    /// 编译着色器并上传颜色表
+    void Init();
+
+    /// 映射参数变化后调用全部回调
+    void NotifyListeners();
+
+    std::atomic<Mode> mode_;       ///< 映射模式
+    std::atomic<float> min_value_; ///< 映射范围最小值
+    std::atomic<float> max_value_; ///< 映射范围最大值
+    std::atomic<float> alpha_;     ///< 透明度
+
+    std::mutex listener_mutex_;                                             ///< 维护listeners_的互斥量
+    std::vector<std::pair<const void *, std::function<void()>>> listeners_; ///< 使用者及其回调，listener_mutex_保护
+
+    bool init_;                     ///< 着色器和颜色表是否已创建，仅渲染线程访问
+    pangolin::GlSlProgram program_; ///< 颜色映射着色器
+    pangolin::GlTexture lut_;       ///< 一维颜色表，以高度为1的二维纹理存储
+    GLint scalar_location_;         ///< 标量属性的位置
+    GLint model_location_;          ///< 模型矩阵的位置
+};
+
+} // namespace slam_viewer
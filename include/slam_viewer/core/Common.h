@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -16,17 +17,56 @@
 #include <pcl/point_cloud.h>
 #include <sophus/se3.hpp>
 
+#include "slam_viewer/core/BatchQueue.h"
+#include "slam_viewer/core/FrameScheduler.h"
+#include "slam_viewer/core/RenderStats.h"
+#include "slam_viewer/core/TripleBuffer.h"
+#include "slam_viewer/core/Types.h"
+
 using namespace std::chrono_literals;
 
 namespace slam_viewer {
 
-typedef Eigen::Vector3f Vec3;
-typedef Eigen::Vector4f Vec4;
-typedef Eigen::Vector2f Vec2;
 typedef Sophus::SE3f SE3;
 typedef Sophus::SO3f SO3;
 
+/// View3D中UIItem的句柄，由槽位索引和代数组成，槽位被复用后旧句柄自动失效
+struct ItemHandle {
+    static constexpr std::uint32_t kInvalidIndex = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint32_t index_ = kInvalidIndex; ///< 槽位索引
+    std::uint32_t generation_ = 0;        ///< 槽位代数
+
+    /// 句柄是否被赋值，是否仍然有效需要由View3D判断
+    bool IsValid() const { return index_ != kInvalidIndex; }
+
+    bool operator==(const ItemHandle &other) const {
+        return index_ == other.index_ && generation_ == other.generation_;
+    }
+
+    bool operator!=(const ItemHandle &other) const { return !(*this == other); }
+};
+
+/// View3D的脏队列，ui_item需要更新时压入自身的句柄，渲染线程只处理队列中的ui_item，压入时唤醒渲染循环
+class DirtyQueue : public BatchQueue<ItemHandle> {
+public:
+    /// 压入句柄并请求重绘，任意非渲染线程调用
+    void Push(ItemHandle handle) {
+        BatchQueue<ItemHandle>::Push(handle);
+        if (auto scheduler = std::atomic_load(&scheduler_))
+            scheduler->RequestRedraw();
+    }
+
+    /// 设置所在窗口的帧调度器
+    void SetScheduler(FrameScheduler::Ptr scheduler) { std::atomic_store(&scheduler_, std::move(scheduler)); }
+
+private:
+    FrameScheduler::Ptr scheduler_; ///< 帧调度器，通过std::atomic_load/atomic_store访问
+};
+
 class UIItem {
+    friend class View3D;
+
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     typedef std::shared_ptr<UIItem> Ptr;
@@ -54,16 +94,70 @@ public:
     /// 获取item的世界位姿
     SE3 GetTwi() const { return Twi_; }
 
+    /// 显存占用的字节数，仅渲染线程调用，View3D据此执行显存上限的淘汰策略
+    virtual std::size_t GpuBytes() { return vbo_.IsValid() ? std::size_t(vbo_.size_bytes) : 0; }
+
+    /// 标记需要更新，非渲染线程调用，由不需要更新变为需要更新时通知所在View3D的脏队列
+    void MarkUpdate();
+
+    /// 获取世界坐标系下的包围盒，仅渲染线程调用，返回false时没有维护包围盒，View3D总是渲染该ui_item
+    bool WorldBounds(Eigen::AlignedBox3f &box);
+
+    /// 获取更新和加锁等待的累计统计，任意线程调用
+    ItemStats GetStats() const;
+
     virtual ~UIItem() { this->Clear(); };
 
 protected:
     pangolin::GlBuffer vbo_;        ///< 显存顶点信息
-    std::mutex mutex_;              ///< 更新UI状态的互斥量，保证线程安全
+    std::mutex mutex_;              ///< 更新UI状态的互斥量，大块数据通过BatchQueue或TripleBuffer无锁发布
     SE3 Twi_;                       ///< Item在世界坐标下的位置
     float line_width_;              ///< 涉及到的线宽
     float point_size_;              ///< 涉及到的点大小
     Vec3 color_;                    ///< 颜色
-    std::atomic<bool> need_update_; ///< 是否需要更新
+
+    /// 设置UI坐标系下的包围盒，仅渲染线程在Update中调用，空包围盒表示没有需要绘制的内容
+    void SetLocalBounds(const Eigen::AlignedBox3f &box);
+
+    /// 扩展UI坐标系下的包围盒，仅渲染线程在Update中调用
+    void ExtendLocalBounds(const Eigen::AlignedBox3f &box);
+
+    /// 标记位姿发生变化，非渲染线程调用，只通知View3D重新计算世界坐标系下的包围盒
+    void MarkMoved();
+
+    /// 标记只影响绘制的状态发生变化，非渲染线程调用，不需要更新数据和包围盒，只请求重绘
+    void MarkRedraw() { PushDirty(); }
+
+    /// 取走更新标记，仅渲染线程在Update开头调用，返回调用前是否需要更新
+    bool ConsumeUpdate() { return need_update_.exchange(false); }
+
+    /// 生产者对mutex_加锁，非渲染线程的接口中使用，发生竞争时统计等待时间
+    std::unique_lock<std::mutex> ProducerLock() { return lock_profiler_.Lock(mutex_); }
+
+private:
+    /// 注册View3D的脏队列，View3D添加ui_item时调用
+    void AddDirtyQueue(std::shared_ptr<DirtyQueue> dirty_queue, const ItemHandle &handle);
+
+    /// 注销View3D的脏队列，View3D删除ui_item时调用
+    void RemoveDirtyQueue(const DirtyQueue *dirty_queue);
+
+    /// 将自身的句柄压入所在View3D的脏队列，已在队列中时跳过
+    void PushDirty();
+
+    /// 记录一次Update的时间和上传字节数，View3D更新ui_item后调用
+    void RecordUpdate(std::uint64_t update_ns, std::size_t upload_bytes);
+
+    std::atomic<bool> need_update_;             ///< 是否需要更新，只能通过MarkUpdate设置，保证ui_item被压入脏队列
+    std::atomic<bool> queued_;                  ///< 是否已经压入脏队列且尚未被处理，避免重复压入
+    std::mutex queue_mutex_;                    ///< 维护dirty_queues_的互斥量
+    std::atomic<std::uint64_t> bounds_version_; ///< 包围盒或位姿的版本，变化时递增，各View3D据此修正BVH
+    bool has_bounds_;                           ///< 是否维护了包围盒，仅渲染线程访问
+    Eigen::AlignedBox3f local_bounds_;          ///< UI坐标系下的包围盒，仅渲染线程访问
+    std::vector<std::pair<std::shared_ptr<DirtyQueue>, ItemHandle>> dirty_queues_; ///< 所在View3D的脏队列和句柄
+    std::atomic<std::uint64_t> update_num_;     ///< Update的调用次数
+    std::atomic<std::uint64_t> update_ns_;      ///< Update的累计纳秒数
+    std::atomic<std::uint64_t> upload_bytes_;   ///< Update中上传到显存的累计字节数
+    LockProfiler lock_profiler_;                ///< 生产者等待mutex_的统计
 };
 
 /// 可视基类，一个窗口内有很多View
@@ -98,9 +192,25 @@ public:
     /// View的渲染函数，需要再Update之后调用
     virtual void Render() = 0;
 
+    /// 设置所在窗口的帧调度器，WindowImpl添加View时调用
+    virtual void SetScheduler(FrameScheduler::Ptr scheduler) { std::atomic_store(&scheduler_, std::move(scheduler)); }
+
+    /// 处理View自身的窗口事件，渲染线程每次循环调用，与是否重绘无关
+    virtual void ProcessEvents() {}
+
+    /// View名称
+    const std::string &GetName() const { return name_; }
+
+    /// 请求所在窗口重绘，任意线程调用，View的显示内容变化时使用
+    void RequestRedraw() {
+        if (auto scheduler = std::atomic_load(&scheduler_))
+            scheduler->RequestRedraw();
+    }
+
 protected:
-    std::string name_;      ///< View名称，用于找到pangolin对应的渲染对象
-    TaskQueue tasks_queue_; ///< 任务队列
+    std::string name_;              ///< View名称，用于找到pangolin对应的渲染对象
+    TaskQueue tasks_queue_;         ///< 任务队列
+    FrameScheduler::Ptr scheduler_; ///< 所在窗口的帧调度器，通过std::atomic_load/atomic_store访问
 };
 
 } // namespace slam_viewer
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "slam_viewer/core/Common.h"
+
+namespace slam_viewer {
+
+/// 可增长的显存缓冲区，预留空闲容量，支持局部上传，仅渲染线程可用
+class DynamicBuffer {
+public:
+    typedef std::shared_ptr<DynamicBuffer> Ptr;
+    typedef std::shared_ptr<const DynamicBuffer> ConstPtr;
+
+    DynamicBuffer(GLenum datatype = GL_FLOAT, GLuint count_per_element = 3,
+                  pangolin::GlBufferType buffer_type = pangolin::GlArrayBuffer);
+
+    /// 保证容量不小于capacity，按几何倍数扩容，扩容时保留已有的显存数据
+    void Reserve(std::size_t capacity);
+
+    /// 上传num个元素到[offset, offset + num)，必要时扩容，仅上传该子区间
+    void Upload(const void *data, std::size_t offset, std::size_t num);
+
+    /// 在有效数据尾部追加num个元素
+    void Append(const void *data, std::size_t num) { Upload(data, size_, num); }
+
+    /// 设置有效元素数量，不会释放显存
+    void Resize(std::size_t size) { size_ = size < capacity_ ? size : capacity_; }
+
+    /// 释放显存
+    void Free();
+
+    /// 绑定缓冲区
+    void Bind() const { buffer_.Bind(); }
+
+    /// 解绑缓冲区
+    void Unbind() const { buffer_.Unbind(); }
+
+    /// 显存是否有效
+    bool IsValid() const { return buffer_.IsValid(); }
+
+    /// 有效元素数量
+    std::size_t Size() const { return size_; }
+
+    /// 已分配的元素容量
+    std::size_t Capacity() const { return capacity_; }
+
+    /// 单个元素的字节数
+    std::size_t ElementBytes() const { return element_bytes_; }
+
+    /// 已分配的显存字节数
+    std::size_t CapacityBytes() const { return capacity_ * element_bytes_; }
+
+    /// 元素数据类型
+    GLenum DataType() const { return datatype_; }
+
+    /// 每个元素的分量数
+    GLuint CountPerElement() const { return count_per_element_; }
+
+private:
+    static constexpr std::size_t kMinCapacity = 1024; ///< 最小分配容量
+    static constexpr float kGrowFactor = 2.0f;        ///< 扩容倍数
+
+    pangolin::GlBuffer buffer_;          ///< 显存缓冲区
+    pangolin::GlBufferType buffer_type_; ///< 缓冲区类型
+    GLenum datatype_;                    ///< 元素数据类型
+    GLuint count_per_element_;           ///< 每个元素的分量数
+    std::size_t element_bytes_;          ///< 单个元素的字节数
+    std::size_t size_;                   ///< 有效元素数量
+    std::size_t capacity_;               ///< 元素容量
+};
+
+/**
+ * @brief 渲染DynamicBuffer中[first, first + count)范围内的顶点
+ *
+ * @param vbo   输入的顶点缓冲区
+ * @param cbo   输入的颜色缓冲区，为nullptr时使用当前颜色
+ * @param mode  输入的图元类型
+ * @param first 输入的起始顶点
+ * @param count 输入的顶点数量
+ */
+void RenderBuffer(const DynamicBuffer &vbo, const DynamicBuffer *cbo, GLenum mode, std::size_t first,
+                  std::size_t count);
+
+/**
+ * @brief 使用一次glMultiDrawArrays渲染DynamicBuffer中的多个区间
+ *
+ * @param vbo           输入的顶点缓冲区
+ * @param cbo           输入的颜色缓冲区，为nullptr时使用当前颜色
+ * @param mode          输入的图元类型
+ * @param firsts        输入的各区间起始顶点
+ * @param counts        输入的各区间顶点数量
+ * @param draw_count    输入的区间数量
+ */
+void RenderBuffer(const DynamicBuffer &vbo, const DynamicBuffer *cbo, GLenum mode, const GLint *firsts,
+                  const GLsizei *counts, std::size_t draw_count);
+
+} // namespace slam_viewer
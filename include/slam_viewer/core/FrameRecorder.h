@@ -0,0 +1,111 @@
+#pragma once
+
+#include <condition_variable>
+#include <thread>
+
+#include "slam_viewer/core/Common.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 帧录制器，以像素缓冲对象（PBO）环异步读回渲染结果，在编码线程中写入视频或图像序列
+ * @details
+ *      1. 渲染线程将当前帧glReadPixels到环中的一个PBO，立即返回，不等待GPU完成；
+ *         PBO数量为N时，N帧之后才映射该PBO拷贝像素，此时读回早已完成，渲染线程不会因读回而停顿
+ *      2. 拷贝出的帧放入有界队列，由编码线程上下翻转后写入，编码速度不影响渲染线程
+ *      3. 队列满时按照策略丢弃新帧或阻塞渲染线程，帧缓冲从对象池中复用，录制期间不会反复分配内存
+ *      4. 路径包含'%'时按照printf格式写入图像序列，如"frames/%06d.png"；否则使用cv::VideoWriter写入视频，
+ *         ".mp4"使用mp4v编码，其他扩展名使用MJPG编码
+ */
+class FrameRecorder {
+public:
+    typedef std::shared_ptr<FrameRecorder> Ptr;
+    typedef std::shared_ptr<const FrameRecorder> ConstPtr;
+
+    /// 编码队列满时的策略
+    enum class QueuePolicy {
+        Drop, ///< 丢弃新帧，渲染线程不会被阻塞
+        Block ///< 等待编码线程，不丢帧，渲染帧率受编码速度限制
+    };
+
+    FrameRecorder(std::string path, double fps = 30.0, std::size_t queue_size = 8,
+                  QueuePolicy policy = QueuePolicy::Drop, std::size_t pbo_num = 3);
+
+    FrameRecorder(const FrameRecorder &) = delete;
+
+    FrameRecorder &operator=(const FrameRecorder &) = delete;
+
+    ~FrameRecorder();
+
+    /// 读回当前绑定的帧缓冲，尺寸以第一帧为准，仅渲染线程在绘制完成后调用
+    void Capture(int width, int height);
+
+    /// 结束录制，读回全部未完成的PBO并释放显存，关闭编码队列，仅渲染线程调用
+    void Finish();
+
+    /// 编码线程是否已经写完全部帧并退出
+    bool Done() const { return done_.load(); }
+
+    /// 已经读回的帧数
+    std::size_t CapturedCount() const { return captured_num_.load(); }
+
+    /// 已经写入的帧数
+    std::size_t WrittenCount() const { return written_num_.load(); }
+
+    /// 因队列满而丢弃的帧数
+    std::size_t DroppedCount() const { return dropped_num_.load(); }
+
+private:
+    static constexpr GLuint64 kFenceTimeout = 100000000; ///< 映射PBO前等待读回完成的最长时间（纳秒）
+
+    /// PBO环中的一个槽位
+    struct Slot {
+        pangolin::GlBuffer pbo_; ///< 像素缓冲对象
+        GLsync fence_ = nullptr; ///< 读回命令的同步对象
+        bool pending_ = false;   ///< 是否有尚未拷贝的帧
+    };
+
+    /// 按照第一帧的尺寸创建PBO环
+    void CreateSlots(int width, int height);
+
+    /// 映射槽位的PBO，将像素拷贝到帧缓冲后放入编码队列
+    void ReadSlot(Slot &slot);
+
+    /// 按照队列策略获取一个空闲的帧缓冲，Drop策略下队列满时返回false
+    bool AcquireFrame(cv::Mat &frame);
+
+    /// 编码线程主循环
+    void Encode();
+
+    /// 写入一帧，仅编码线程调用
+    void WriteFrame(const cv::Mat &frame);
+
+    const std::string path_;       ///< 输出路径
+    const double fps_;             ///< 视频帧率
+    const std::size_t queue_size_; ///< 编码队列的最大帧数
+    const QueuePolicy policy_;     ///< 队列满时的策略
+
+    std::vector<Slot> slots_; ///< PBO环，仅渲染线程访问
+    std::size_t pbo_num_;     ///< PBO数量
+    std::size_t next_slot_;   ///< 下一个写入的槽位，也是最早的未拷贝槽位，仅渲染线程访问
+    int width_, height_;      ///< 录制尺寸，仅渲染线程访问
+
+    std::mutex mutex_;                  ///< 编码队列的互斥量
+    std::condition_variable not_empty_; ///< 队列非空或关闭的条件变量
+    std::condition_variable not_full_;  ///< 队列有空位的条件变量
+    std::deque<cv::Mat> queue_;         ///< 待编码的帧，mutex_保护
+    std::vector<cv::Mat> pool_;         ///< 空闲的帧缓冲，mutex_保护
+    std::size_t in_flight_;             ///< 已经取出但尚未写完的帧数，不超过queue_size_，mutex_保护
+    bool closed_;                       ///< 队列是否已经关闭，mutex_保护
+
+    cv::VideoWriter writer_;                ///< 视频写入器，仅编码线程访问
+    std::size_t sequence_id_;               ///< 已经写入的帧编号，仅编码线程访问
+    std::atomic<bool> done_;                ///< 编码线程是否已经退出
+    std::atomic<std::size_t> captured_num_; ///< 已经读回的帧数
+    std::atomic<std::size_t> written_num_;  ///< 已经写入的帧数
+    std::atomic<std::size_t> dropped_num_;  ///< 丢弃的帧数
+
+    std::thread worker_; ///< 编码线程，最后初始化
+};
+
+} // namespace slam_viewer
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace slam_viewer {
+
+/**
+ * @brief 渲染循环的帧调度器，只在场景变化、相机移动或有输入时重绘
+ * @details
+ *      1. 任意线程通过RequestRedraw请求重绘，ui_item压入脏队列、View状态变化和窗口输入事件都会请求重绘
+ *      2. 没有重绘请求时渲染线程在条件变量上等待，只按照轮询周期醒来处理窗口事件，空闲时几乎不占用CPU
+ *      3. 有重绘请求时按照目标帧率对齐帧起始时间，帧率不超过目标帧率，且不会因为睡眠误差累积而漂移
+ */
+class FrameScheduler {
+public:
+    typedef std::shared_ptr<FrameScheduler> Ptr;
+    typedef std::shared_ptr<const FrameScheduler> ConstPtr;
+    typedef std::chrono::steady_clock Clock;
+
+    FrameScheduler(double target_fps = 60.0, double poll_rate = 60.0);
+
+    /// 请求重绘，任意线程调用
+    void RequestRedraw();
+
+    /// 设置目标帧率，小于等于0时不限制帧率
+    void SetTargetFps(double fps);
+
+    /// 设置空闲时处理窗口事件的轮询频率，决定空闲时的输入响应延迟，小于等于0时只在重绘请求到达时醒来
+    void SetPollRate(double poll_rate);
+
+    /// 设置是否持续重绘，为true时与场景是否变化无关，每帧都重绘
+    void SetContinuous(bool continuous);
+
+    /// 等待下一帧或下一次轮询，仅渲染线程调用，返回是否需要重绘
+    bool WaitForFrame();
+
+    /// 开始绘制一帧，清除重绘请求并记录帧起始时间，仅渲染线程调用
+    void BeginFrame();
+
+    /// 已经绘制的帧数
+    std::size_t FrameCount() const;
+
+private:
+    mutable std::mutex mutex_;          ///< 维护调度状态的互斥量
+    std::condition_variable condition_; ///< 重绘请求的条件变量
+    bool redraw_;                       ///< 是否有尚未处理的重绘请求，mutex_保护
+    bool continuous_;                   ///< 是否持续重绘，mutex_保护
+    Clock::duration frame_period_;      ///< 最小帧间隔，0表示不限制帧率，mutex_保护
+    Clock::duration poll_period_;       ///< 空闲时的轮询间隔，mutex_保护
+    Clock::time_point last_frame_;      ///< 上一帧对齐后的起始时间，仅渲染线程访问
+    std::size_t frame_count_;           ///< 已经绘制的帧数，mutex_保护
+};
+
+} // namespace slam_viewer
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "slam_viewer/core/Types.h"
+
+namespace slam_viewer {
+
+/// 视锥体，由投影矩阵和模型视图矩阵提取6个裁剪平面，用于可见性判断
+class Frustum {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Frustum() { planes_.setZero(); }
+
+    /// 由投影矩阵和模型视图矩阵的乘积构造，两者均为OpenGL列主序矩阵
+    explicit Frustum(const Mat4 &proj_model_view);
+
+    /// 由当前OpenGL的投影矩阵和模型视图矩阵构造，仅渲染线程可用
+    static Frustum FromGlState();
+
+    /// 包围球是否与视锥体相交
+    bool Intersects(const Vec3 &center, float radius) const;
+
+    /// 轴对齐包围盒是否与视锥体相交
+    bool Intersects(const Eigen::AlignedBox3f &box) const;
+
+    /// 轴对齐包围盒是否完全在视锥体内
+    bool Contains(const Eigen::AlignedBox3f &box) const;
+
+private:
+    Eigen::Matrix<float, 6, 4> planes_; ///< 裁剪平面，每行为(nx, ny, nz, d)，法向指向视锥体内部
+};
+
+} // namespace slam_viewer
@@ -39,6 +39,9 @@ public:
     /// 渲染函数
     void Render();
 
+    /// 处理OpenCV窗口的事件，渲染线程每次循环调用
+    void ProcessEvents() override { cv::waitKey(1); }
+
 private:
     std::unordered_map<std::string, Image::Ptr> images_; ///< 要渲染的图像
     int row_, col_;                                      ///< 图像分布的行数和列数
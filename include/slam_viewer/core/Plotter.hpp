@@ -51,6 +51,9 @@ public:
     /// 其他线程调用，更新绘图数据
     void UpdatePlotterItem(const std::string &plot_name, const std::vector<float> &data);
 
+    /// 渲染线程调用，记录绘图数据但不请求重绘，数据在下一次重绘时显示
+    void LogPlotterItem(const std::string &plot_name, const std::vector<float> &data);
+
     /// 其他线程调用，更新绘图数据
     template <typename Derived>
     void UpdatePlotterItem(const std::string &plot_name, const Eigen::MatrixBase<Derived> &data) {
@@ -58,6 +61,7 @@ public:
             return;
 
         plotter_items_[plot_name]->Update(data);
+        RequestRedraw();
     }
 
     /// pangolin::DataLog无需单独渲染
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pangolin/pangolin.h>
+
+namespace slam_viewer {
+
+/**
+ * @brief 线程的渲染计数器，每个线程一份，只在所属线程中累加，不需要同步
+ * @details
+ *      DynamicBuffer的上传和各ui_item的绘制调用在当前线程的计数器上累加，
+ *      WindowImpl和View3D在Render和Update前后读取差值，得到每个View和每个ui_item的开销
+ */
+struct RenderCounters {
+    std::size_t draw_calls_ = 0;   ///< 绘制调用次数
+    std::size_t points_ = 0;       ///< 以GL_POINTS绘制的点数
+    std::size_t vertices_ = 0;     ///< 绘制的顶点数，包括点和实例化展开的顶点
+    std::size_t upload_bytes_ = 0; ///< 上传到显存的字节数
+    bool render_thread_ = false;   ///< 是否为渲染线程，渲染线程的加锁等待不计入生产者统计
+};
+
+/// 当前线程的渲染计数器
+inline RenderCounters &ThreadRenderCounters() {
+    thread_local RenderCounters counters;
+    return counters;
+}
+
+/**
+ * @brief 记录一次绘制调用，仅渲染线程调用
+ *
+ * @param mode      输入的图元类型
+ * @param count     输入的每个实例的顶点数量
+ * @param instances 输入的实例数量
+ */
+inline void CountDraw(GLenum mode, std::size_t count, std::size_t instances = 1) {
+    RenderCounters &counters = ThreadRenderCounters();
+    ++counters.draw_calls_;
+    counters.vertices_ += count * instances;
+    if (mode == GL_POINTS)
+        counters.points_ += count * instances;
+}
+
+/// 记录一次显存上传，仅渲染线程调用
+inline void CountUpload(std::size_t bytes) { ThreadRenderCounters().upload_bytes_ += bytes; }
+
+/// 互斥量的生产者等待统计，均为累计值
+struct LockStats {
+    double producer_wait_ms_ = 0;            ///< 生产者线程加锁的累计等待时间（毫秒）
+    std::size_t producer_contended_num_ = 0; ///< 生产者线程加锁时发生竞争的次数
+};
+
+/**
+ * @brief 生产者加锁等待的统计器，在调用处包装对std::mutex的加锁，不改变互斥量本身的类型
+ * @details
+ *      1. 先尝试try_lock，没有竞争时与直接加锁的开销相同
+ *      2. 发生竞争时才计时，等待时间同时计入该统计器和全局的统计，渲染线程的等待不计入
+ */
+class LockProfiler {
+public:
+    LockProfiler()
+        : wait_ns_(0)
+        , contended_num_(0) {}
+
+    LockProfiler(const LockProfiler &) = delete;
+
+    LockProfiler &operator=(const LockProfiler &) = delete;
+
+    /// 对mutex加锁，发生竞争时统计等待时间，返回持有锁的unique_lock
+    std::unique_lock<std::mutex> Lock(std::mutex &mutex);
+
+    /// 该统计器的生产者等待统计
+    LockStats Stats() const;
+
+    /// 全部LockProfiler的生产者等待统计
+    static LockStats GlobalStats();
+
+private:
+    std::atomic<std::uint64_t> wait_ns_;       ///< 生产者累计等待的纳秒数
+    std::atomic<std::uint64_t> contended_num_; ///< 生产者加锁时发生竞争的次数
+};
+
+/// ui_item的更新统计，均为累计值
+struct ItemStats {
+    std::size_t update_num_ = 0;   ///< Update的调用次数
+    double update_ms_ = 0;         ///< Update的累计时间（毫秒）
+    std::size_t upload_bytes_ = 0; ///< Update中上传到显存的累计字节数
+    LockStats lock_;               ///< 生产者等待ui_item互斥量的统计
+};
+
+/// View的单帧渲染统计
+struct ViewStats {
+    std::string name_;             ///< View名称
+    double render_ms_ = 0;         ///< Render的时间（毫秒），包括ui_item的更新
+    std::size_t draw_calls_ = 0;   ///< 绘制调用次数
+    std::size_t points_ = 0;       ///< 绘制的点数
+    std::size_t upload_bytes_ = 0; ///< 上传到显存的字节数
+};
+
+/// 窗口的单帧统计
+struct FrameStats {
+    std::size_t frame_id_ = 0;               ///< 帧编号
+    double render_ms_ = 0;                   ///< 全部View的渲染时间（毫秒）
+    std::size_t draw_calls_ = 0;             ///< 绘制调用次数
+    std::size_t points_ = 0;                 ///< 绘制的点数
+    std::size_t upload_bytes_ = 0;           ///< 上传到显存的字节数
+    double producer_wait_ms_ = 0;            ///< 上一帧以来生产者等待ui_item互斥量的时间（毫秒）
+    std::size_t producer_contended_num_ = 0; ///< 上一帧以来生产者加锁时发生竞争的次数
+    std::vector<ViewStats> views_;           ///< 各View的统计，与添加顺序一致
+
+    /// 绘图的标签，与PlotValues一一对应
+    static std::vector<std::string> PlotLabels();
+
+    /// 绘图的数据，点数以千为单位，上传量以KB为单位
+    std::vector<float> PlotValues() const;
+};
+
+/// 两个时间点之间的毫秒数
+inline double ElapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace slam_viewer
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+
+#include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/Plotter.hpp"
+#include "slam_viewer/core/Umeyama.h"
+#include "slam_viewer/ui/StampedTrajectoryUI.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 流式轨迹评估器，在线计算估计轨迹相对真值的ATE和多个距离段上的RPE
+ * @details
+ *      1. 估计轨迹与真值的对齐由UmeyamaAligner在线完成，只维护求和形式的充分统计量，每个位姿的代价为O(1)
+ *      2. ATE的RMSE同样由充分统计量在当前对齐下直接计算，不需要遍历历史位姿
+ *      3. RPE按真值的行驶距离分段，每个段长维护单调前进的起点，每个位姿的均摊代价为O(段长数量)
+ *      4. 结果可以推送到Plotter，每个位姿的ATE写入StampedTrajectoryUI的误差通道，由着色器着色
+ *      5. 定期在新的对齐下刷新全部位姿的误差，该O(N)的计算在评估器的锁外进行，不阻塞其他线程添加位姿
+ */
+class TrajectoryEvaluator {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<TrajectoryEvaluator> Ptr;
+    typedef std::shared_ptr<const TrajectoryEvaluator> ConstPtr;
+
+    /// 一个段长上的RPE统计
+    struct SegmentError {
+        double length_;      ///< 段长（米）
+        std::size_t count_;  ///< 参与统计的位姿对数量
+        double trans_error_; ///< 平均平移误差（%）
+        double rot_error_;   ///< 平均旋转误差（度/米）
+    };
+
+    /// 评估结果
+    struct Result {
+        std::size_t size_;                   ///< 参与评估的位姿数量
+        double ate_rmse_;                    ///< 当前对齐下的ATE均方根误差（米）
+        double scale_;                       ///< 对齐的尺度
+        std::vector<SegmentError> segments_; ///< 各段长上的RPE
+    };
+
+    /**
+     * @brief 流式轨迹评估器的构造函数
+     *
+     * @param segment_lengths   输入的RPE段长（米）
+     * @param with_scale        输入的对齐是否估计尺度，单目时使用
+     * @param rpe_step          输入的RPE起点之间间隔的位姿数量
+     * @param realign_interval  输入的重新计算全部位姿误差的间隔位姿数量，为0时不重新计算
+     */
+    TrajectoryEvaluator(std::vector<double> segment_lengths = {100, 200, 300, 400, 500, 600, 700, 800},
+                        bool with_scale = false, std::size_t rpe_step = 10, std::size_t realign_interval = 1000);
+
+    /// 设置位姿误差着色的轨迹，估计位姿会以相同的时间戳添加到该轨迹中，需在添加位姿之前调用
+    void SetTrajectory(StampedTrajectoryUI::Ptr trajectory);
+
+    /// 设置结果推送的绘图空间和绘图元素，每plot_interval个位姿推送一次，标签由PlotLabels()给出
+    void SetPlotter(Plotter::Ptr plotter, std::string plot_name, std::size_t plot_interval = 10);
+
+    /// 绘图元素的标签，依次为ATE和各段长的平移RPE
+    std::vector<std::string> PlotLabels() const;
+
+    /**
+     * @brief 添加一对估计位姿和真值位姿，任意非渲染线程调用
+     *
+     * @param stamp     输入的时间戳，必须严格递增
+     * @param Twc_est   输入的估计位姿
+     * @param Twc_gt    输入的真值位姿
+     * @return true     添加成功
+     * @return false    时间戳不是严格递增的
+     */
+    bool AddPose(double stamp, const SE3 &Twc_est, const SE3 &Twc_gt);
+
+    /// 获取当前的评估结果
+    Result GetResult();
+
+    /// 获取当前的对齐变换，将估计轨迹变换到真值坐标系下，左上角为尺度和旋转的乘积
+    Eigen::Matrix4d GetAlignment();
+
+    /// 清空评估状态，同时清空误差着色的轨迹，之后可以从任意时间戳重新开始添加
+    void Reset();
+
+private:
+    typedef Eigen::Vector3d Vec3d;
+
+    static constexpr std::size_t kBlockPoses = 1024; ///< 每个位置块容纳的位姿数量
+
+    /// 一个段长上的RPE流式统计，需持有mutex_
+    struct Segment {
+        double length_;     ///< 段长
+        std::size_t start_; ///< 下一个RPE起点
+        std::size_t count_; ///< 位姿对数量
+        double trans_sum_;  ///< 平移误差和
+        double rot_sum_;    ///< 旋转误差和
+    };
+
+    /// 固定容量的位置块，分配后不再移动，已写入的位置不再修改，因此可以在锁外读取
+    struct PositionBlock {
+        std::array<Vec3d, kBlockPoses> est_; ///< 估计位置
+        std::array<Vec3d, kBlockPoses> gt_;  ///< 真值位置
+    };
+
+    /// 在锁内拍摄的重新计算误差所需的快照
+    struct RealignTask {
+        std::vector<std::shared_ptr<const PositionBlock>> blocks_; ///< 位置块
+        std::size_t size_ = 0;                                     ///< 快照时的位姿数量
+        std::size_t generation_ = 0;                               ///< 快照时的清空代数
+        UmeyamaAligner aligner_;                                   ///< 快照时的对齐
+        StampedTrajectoryUI::Ptr trajectory_;                      ///< 写入误差的轨迹
+    };
+
+    /// 当前对齐下第id个位姿的误差，需持有mutex_
+    float PoseError(std::size_t id) const;
+
+    /// 以新位姿为终点更新各段长的RPE，需持有mutex_
+    void UpdateSegments();
+
+    /// 拍摄重新计算误差的快照，需持有mutex_
+    RealignTask MakeRealignTask() const;
+
+    /// 在快照的对齐下重新计算全部位姿的误差并写入轨迹，不持有mutex_
+    void Realign(const RealignTask &task);
+
+    /// 推送绘图数据，需持有mutex_
+    void Plot();
+
+    std::mutex mutex_;             ///< 维护评估状态的互斥量
+    std::mutex realign_mutex_;     ///< 串行化Realign和Reset的互斥量，先于mutex_加锁
+    bool with_scale_;              ///< 是否估计尺度
+    std::size_t rpe_step_;         ///< RPE起点间隔
+    std::size_t realign_interval_; ///< 重新计算全部位姿误差的间隔
+
+    std::vector<double> stamps_;                         ///< 时间戳
+    std::vector<SE3> est_;                               ///< 估计位姿
+    std::vector<SE3> gt_;                                ///< 真值位姿
+    std::vector<std::shared_ptr<PositionBlock>> blocks_; ///< 估计和真值位置，供锁外的Realign读取
+    std::vector<double> distances_;                      ///< 真值轨迹从起点开始的行驶距离
+    std::vector<Segment> segments_;                      ///< 各段长的RPE统计
+    UmeyamaAligner aligner_;                             ///< 估计轨迹到真值的在线对齐
+    std::size_t generation_;                             ///< 清空代数，同时持有realign_mutex_和mutex_时修改
+    std::size_t realigned_size_;                         ///< 最近一次写入轨迹的快照位姿数量，realign_mutex_保护
+
+    StampedTrajectoryUI::Ptr trajectory_; ///< 误差着色的轨迹
+    Plotter::Ptr plotter_;                ///< 结果推送的绘图空间
+    std::string plot_name_;               ///< 绘图元素名称
+    std::size_t plot_interval_;           ///< 推送间隔
+};
+
+} // namespace slam_viewer
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace slam_viewer {
+
+/**
+ * @brief 三缓冲，用于生产者线程向渲染线程发布最新状态
+ * @details
+ *      1. 生产者写入后台缓冲区，通过一次原子交换将其与中间缓冲区互换并标记为新数据
+ *      2. 渲染线程发现新数据时，通过一次原子交换将前台缓冲区与中间缓冲区互换
+ *      3. 双方均不等待对方，渲染线程总是拿到最近一次完整发布的快照，中间未被取走的快照被直接覆盖
+ *      4. 多个生产者之间通过write_mutex_串行化，渲染线程从不获取该锁
+ * @tparam T 状态类型
+ */
+template <typename T> class TripleBuffer {
+public:
+    TripleBuffer()
+        : back_(0)
+        , middle_(1)
+        , front_(2) {}
+
+    /// 发布新的状态，任意非渲染线程调用
+    void Publish(T value) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        buffers_[back_] = std::move(value);
+        back_ = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    /// 获取最新发布的状态到前台缓冲区，返回是否有新的状态，仅渲染线程调用
+    bool Fetch() {
+        if (!(middle_.load(std::memory_order_relaxed) & kDirty))
+            return false;
+
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    /// 前台缓冲区，即渲染线程最近一次获取的状态，仅渲染线程调用
+    T &Front() { return buffers_[front_]; }
+
+private:
+    static constexpr int kIndexMask = 0x3; ///< 缓冲区索引的掩码
+    static constexpr int kDirty = 0x4;     ///< 中间缓冲区存在未被取走的新状态
+
+    std::array<T, 3> buffers_; ///< 三个缓冲区
+    int back_;                 ///< 后台缓冲区索引，write_mutex_保护
+    std::atomic<int> middle_;  ///< 中间缓冲区索引和新状态标志
+    int front_;                ///< 前台缓冲区索引，仅渲染线程访问
+    std::mutex write_mutex_;   ///< 串行化多个生产者，渲染线程不获取
+};
+
+} // namespace slam_viewer
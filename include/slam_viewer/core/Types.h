@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+namespace slam_viewer {
+
+typedef Eigen::Vector3f Vec3;
+typedef Eigen::Vector4f Vec4;
+typedef Eigen::Vector2f Vec2;
+typedef Eigen::Matrix4f Mat4;
+typedef Eigen::Matrix<std::int16_t, 3, 1> Vec3s;
+typedef Eigen::Matrix<std::uint8_t, 4, 1> Vec4b;
+
+/// 将轴对齐包围盒经过刚体变换后重新求轴对齐包围盒，结果包含变换后的原包围盒
+inline Eigen::AlignedBox3f TransformBox(const Eigen::AlignedBox3f &box, const Mat4 &T) {
+    if (box.isEmpty())
+        return box;
+
+    Vec3 center = T.topLeftCorner<3, 3>() * box.center() + T.topRightCorner<3, 1>();
+    Vec3 half = T.topLeftCorner<3, 3>().cwiseAbs() * (box.sizes() * 0.5f);
+    return Eigen::AlignedBox3f(center - half, center + half);
+}
+
+} // namespace slam_viewer
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+
+#include <Eigen/Core>
+
+namespace slam_viewer {
+
+/**
+ * @brief 流式Umeyama对齐，只维护求和形式的充分统计量，求解y = sRx + t
+ * @details
+ *      1. 添加一对点的代价为O(1)，求解的代价为一次3x3的SVD，与点对数量无关
+ *      2. 当前对齐下的误差平方和同样由充分统计量直接计算，不需要保存历史点对
+ *      3. 只依赖Eigen，不加锁，由调用者保证同步
+ */
+class UmeyamaAligner {
+public:
+    typedef Eigen::Matrix3d Mat3d;
+    typedef Eigen::Vector3d Vec3d;
+
+    explicit UmeyamaAligner(bool with_scale = false);
+
+    /// 添加一对源点x和目标点y
+    void Add(const Vec3d &x, const Vec3d &y);
+
+    /// 由充分统计量求解对齐，点对少于3个时只求解平移
+    void Solve();
+
+    /// 当前对齐下全部点对的误差平方和
+    double SquaredError() const;
+
+    /// 当前对齐下点对的误差
+    double Error(const Vec3d &x, const Vec3d &y) const { return (y - s_ * R_ * x - t_).norm(); }
+
+    /// 当前对齐的4x4变换，左上角为尺度和旋转的乘积
+    Eigen::Matrix4d Matrix() const;
+
+    /// 清空充分统计量，对齐重置为单位变换
+    void Reset();
+
+    /// 点对数量
+    std::size_t Size() const { return static_cast<std::size_t>(n_); }
+
+    /// 对齐的旋转
+    const Mat3d &Rotation() const { return R_; }
+
+    /// 对齐的平移
+    const Vec3d &Translation() const { return t_; }
+
+    /// 对齐的尺度
+    double Scale() const { return s_; }
+
+private:
+    bool with_scale_; ///< 是否估计尺度
+
+    double n_;      ///< 点对数量
+    Vec3d sum_x_;   ///< 源点的和
+    Vec3d sum_y_;   ///< 目标点的和
+    Mat3d sum_yx_;  ///< 目标点与源点外积的和
+    double sum_xx_; ///< 源点模长平方的和
+    double sum_yy_; ///< 目标点模长平方的和
+    Mat3d R_;       ///< 对齐的旋转
+    Vec3d t_;       ///< 对齐的平移
+    double s_;      ///< 对齐的尺度
+};
+
+} // namespace slam_viewer
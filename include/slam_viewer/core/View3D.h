@@ -1,5 +1,6 @@
 #pragma once
 
+#include "slam_viewer/core/AabbTree.h"
 #include "slam_viewer/core/Camera.h"
 #include "slam_viewer/core/Common.h"
 
@@ -15,7 +16,8 @@ public:
     typedef std::shared_ptr<pangolin::Handler3D> Handler3D;
 
     View3D(std::string name)
-        : View(std::move(name)) {}
+        : View(std::move(name))
+        , dirty_queue_(std::make_shared<DirtyQueue>()) {}
 
     /// 3d渲染函数
     void Render() override;
@@ -23,17 +25,118 @@ public:
     /// 设置相机
     void SetCamera(Camera::Ptr camera);
 
-    /// 添加ui_item
-    void AddUIItem(UIItem::Ptr ui_item);
+    /// 设置所在窗口的帧调度器，ui_item压入脏队列和相机状态变化时请求重绘
+    void SetScheduler(FrameScheduler::Ptr scheduler) override;
+
+    /// 添加ui_item，返回句柄，group为分组名称，evictable为false时不参与自动淘汰
+    ItemHandle AddUIItem(UIItem::Ptr ui_item, const std::string &group = "", bool evictable = true);
+
+    /// 删除ui_item，代价为O(1)，显存在渲染线程中释放，句柄已失效时返回false
+    bool RemoveUIItem(const ItemHandle &handle);
+
+    /// 删除分组内的全部ui_item，返回删除的数量
+    std::size_t RemoveGroup(const std::string &group);
+
+    /// 设置ui_item是否可见，不可见的ui_item不会更新和渲染，句柄已失效时返回false
+    bool SetVisible(const ItemHandle &handle, bool visible);
+
+    /// 设置分组是否可见
+    void SetGroupVisible(const std::string &group, bool visible);
+
+    /// 获取句柄对应的ui_item，句柄已失效时返回nullptr
+    UIItem::Ptr GetUIItem(const ItemHandle &handle);
+
+    /// 句柄是否仍然有效
+    bool Contains(const ItemHandle &handle);
+
+    /// ui_item的数量
+    std::size_t Size();
+
+    /// 设置自动淘汰策略，可淘汰的ui_item超过max_items个或显存超过max_gpu_bytes时删除最早添加的，0表示不限制
+    void SetEvictionPolicy(std::size_t max_items, std::size_t max_gpu_bytes = 0);
+
+    /// 最近一次渲染时统计的ui_item显存占用
+    std::size_t GpuBytes() const { return gpu_bytes_.load(); }
+
+    /// 最近一次渲染时通过视锥体剔除后实际渲染的ui_item数量
+    std::size_t RenderedSize() const { return rendered_num_.load(); }
 
     /// 创建3d窗口布局
     void CreateDisplayLayout(pangolin::Layout layout = pangolin::LayoutEqualVertical) override;
 
 private:
-    std::vector<UIItem::Ptr> ui_items_; ///< View3D待渲染的3d元素
-    Camera::Ptr camera_;                ///< 渲染View3D的相机
-    Handler3D handler_;                 ///< 3d窗口的handler
-    std::mutex mutex_;                  ///< 维护ui_items_的互斥量
+    static constexpr std::uint32_t kNone = ItemHandle::kInvalidIndex; ///< 空下标
+
+    /// 稠密存储的ui_item，渲染时顺序遍历
+    struct Entry {
+        UIItem::Ptr item_;             ///< ui_item
+        std::uint32_t slot_;           ///< 所属的句柄槽位
+        int group_;                    ///< 分组下标
+        bool visible_;                 ///< 是否可见
+        bool dirty_;                   ///< 是否在dirty_handles_中等待更新
+        std::size_t gpu_bytes_;        ///< 最近一次更新后的显存占用
+        bool bounded_;                 ///< 是否维护了包围盒，为false时不参与剔除
+        std::int32_t proxy_;           ///< 在tree_中的叶子节点，包围盒为空时为AabbTree::kNull
+        std::uint64_t bounds_version_; ///< 最近一次修正BVH时ui_item的包围盒版本
+        std::uint32_t unbounded_;      ///< 在unbounded_slots_中的下标，维护了包围盒时为kNone
+    };
+
+    /// 句柄槽位，记录ui_item在稠密数组中的下标，可淘汰的ui_item按添加顺序串成双向链表
+    struct Slot {
+        std::uint32_t dense_ = kNone;  ///< 在items_中的下标，空闲槽位为kNone
+        std::uint32_t generation_ = 0; ///< 代数，槽位释放时递增
+        std::uint32_t older_ = kNone;  ///< 更早添加的可淘汰槽位
+        std::uint32_t newer_ = kNone;  ///< 更晚添加的可淘汰槽位
+        bool evictable_ = false;       ///< 是否参与自动淘汰
+    };
+
+    /// 查找句柄对应的稠密下标，句柄已失效时返回kNone，需持有mutex_
+    std::uint32_t Find(const ItemHandle &handle) const;
+
+    /// 删除稠密下标处的ui_item，与末尾元素交换后弹出，需持有mutex_
+    void RemoveAt(std::uint32_t dense);
+
+    /// 按照淘汰策略删除最早添加的ui_item，需持有mutex_
+    void Evict();
+
+    /// 获取分组下标，不存在时创建，需持有mutex_
+    int GroupIndex(const std::string &group);
+
+    /// 取出脏队列并更新其中可见的ui_item，不可见的保留到重新显示后更新，仅渲染线程调用，需持有mutex_
+    void UpdateDirtyItems();
+
+    /// 包围盒或位姿变化时重新计算世界坐标系下的包围盒并修正BVH，仅渲染线程调用，需持有mutex_
+    void UpdateBounds(Entry &entry);
+
+    /// 设置ui_item是否维护了包围盒，并同步维护unbounded_slots_，需持有mutex_
+    void SetBounded(Entry &entry, bool bounded);
+
+    /// 收集可见且与视锥体相交的ui_item的稠密下标，按添加顺序排列，仅渲染线程调用，需持有mutex_
+    void CullItems(const Frustum &frustum);
+
+    std::vector<Entry> items_;                         ///< 稠密存储的ui_item，mutex_保护
+    std::vector<Slot> slots_;                          ///< 句柄槽位，mutex_保护
+    std::vector<std::uint32_t> free_slots_;            ///< 空闲的槽位，mutex_保护
+    std::uint32_t oldest_ = kNone;                     ///< 最早添加的可淘汰槽位
+    std::uint32_t newest_ = kNone;                     ///< 最晚添加的可淘汰槽位
+    std::size_t evictable_num_ = 0;                    ///< 可淘汰的ui_item数量
+    std::unordered_map<std::string, int> group_index_; ///< 分组名称到分组下标的映射
+    std::vector<char> group_visible_;                  ///< 各分组是否可见
+    std::vector<UIItem::Ptr> retired_items_;           ///< 被删除的ui_item，在渲染线程中释放，mutex_保护
+    std::size_t max_items_ = 0;                        ///< 可淘汰ui_item的数量上限，0表示不限制
+    std::size_t max_gpu_bytes_ = 0;                    ///< 显存上限，0表示不限制
+    std::size_t total_gpu_bytes_ = 0;                  ///< 各ui_item显存占用之和，mutex_保护
+    std::atomic<std::size_t> gpu_bytes_{0};            ///< total_gpu_bytes_的快照，供其他线程读取
+    std::shared_ptr<DirtyQueue> dirty_queue_;          ///< 需要更新的ui_item句柄，ui_item无锁压入
+    std::vector<ItemHandle> dirty_handles_;            ///< 等待更新的ui_item句柄，仅渲染线程访问
+    AabbTree tree_;                                    ///< 维护了包围盒的ui_item的BVH，用户数据为槽位，mutex_保护
+    std::vector<std::uint32_t> unbounded_slots_;       ///< 未维护包围盒的ui_item的槽位，总是渲染，mutex_保护
+    std::vector<std::uint32_t> render_items_;          ///< 本帧需要渲染的稠密下标，仅渲染线程访问
+    std::atomic<std::size_t> rendered_num_{0};         ///< 最近一次渲染的ui_item数量，供其他线程读取
+
+    Camera::Ptr camera_; ///< 渲染View3D的相机
+    Handler3D handler_;  ///< 3d窗口的handler
+    std::mutex mutex_;   ///< 维护ui_item注册表的互斥量
 };
 
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "slam_viewer/core/FrameRecorder.h"
 #include "slam_viewer/core/Menu.hpp"
 #include "slam_viewer/core/Plotter.hpp"
 #include "slam_viewer/core/View3D.h"
@@ -13,7 +14,14 @@ public:
     typedef std::shared_ptr<const WindowImpl> ConstPtr;
     typedef std::queue<std::function<void(void)>> TasksQueue;
 
-    WindowImpl(std::string win_name = "SLAM Viewer", int width = 1920, int height = 1080);
+    /// 窗口后端
+    enum class Backend {
+        Window,  ///< 系统窗口，需要显示器
+        Headless ///< 无窗口的EGL上下文，渲染到离屏帧缓冲，可使用Mesa的软件渲染，无需显示器和GPU
+    };
+
+    WindowImpl(std::string win_name = "SLAM Viewer", int width = 1920, int height = 1080,
+               Backend backend = Backend::Window);
 
     /// 渲染3d窗口内的所有元素，先更新再渲染
     void Render();
@@ -21,25 +29,121 @@ public:
     /// 运行主循环
     void Run();
 
+    /// 同步渲染一帧并读回BGR图像，不经过事件循环和帧调度，不能与Run同时使用
+    void RenderOnce(cv::Mat &image);
+
+    /// 窗口后端
+    Backend GetBackend() const { return backend_; }
+
     /// 添加渲染View
     void AddView(View::Ptr view, pangolin::Attach bottom, pangolin::Attach top, pangolin::Attach left,
                  pangolin::Attach right, pangolin::Layout layout = pangolin::LayoutEqualVertical);
     
-    /// 外部线程请求停止
-    void RequestStop() { request_stop_ = true; }
+    /// 外部线程请求停止，唤醒等待中的渲染循环
+    void RequestStop() {
+        request_stop_ = true;
+        scheduler_->RequestRedraw();
+    }
+
+    /// 请求重绘，任意线程调用
+    void RequestRedraw() { scheduler_->RequestRedraw(); }
+
+    /// 设置目标帧率，小于等于0时不限制帧率
+    void SetTargetFps(double fps) { scheduler_->SetTargetFps(fps); }
+
+    /// 设置空闲时处理窗口事件的轮询频率
+    void SetPollRate(double poll_rate) { scheduler_->SetPollRate(poll_rate); }
+
+    /// 设置是否持续重绘，为true时每帧都重绘，与场景是否变化无关
+    void SetContinuous(bool continuous) { scheduler_->SetContinuous(continuous); }
+
+    /// 获取帧调度器
+    FrameScheduler::Ptr GetScheduler() const { return scheduler_; }
+
+    /// 开始录制，任意线程调用，已经在录制时结束之前的录制
+    FrameRecorder::Ptr StartRecording(std::string path, double fps = 30.0, std::size_t queue_size = 8,
+                                      FrameRecorder::QueuePolicy policy = FrameRecorder::QueuePolicy::Drop);
+
+    /// 结束录制，任意线程调用，渲染线程在下一帧读回剩余的帧并释放显存
+    void StopRecording();
+
+    /// 获取当前的帧录制器，未录制时为nullptr
+    FrameRecorder::Ptr GetRecorder() const { return std::atomic_load(&recorder_); }
+
+    /// 获取最近一帧的渲染统计，任意线程调用
+    FrameStats GetFrameStats() const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return frame_stats_;
+    }
+
+    /// 将每帧的渲染统计记录到Plotter中，在渲染线程启动之前的初始化阶段使用
+    void SetStatsPlotter(Plotter::Ptr plotter, std::string plot_name = "render stats", float frames = kStatsPlotFrames,
+                         float y_max = kStatsPlotMax);
+
+    /// 设置是否在窗口左上角绘制渲染统计的文字叠加层，任意线程调用
+    void SetStatsOverlay(bool enable) {
+        stats_overlay_ = enable;
+        scheduler_->RequestRedraw();
+    }
+
+    static constexpr float kStatsPlotFrames = 600; ///< 统计绘图默认显示的帧数
+    static constexpr float kStatsPlotMax = 50;     ///< 统计绘图默认的纵轴上限，毫秒、绘制调用和千点共用一个纵轴
 
 private:
     /// 创建展示布局
     void CreateDisplayLayout();
 
+    /// 将窗口的输入事件连接到帧调度器，有输入时请求重绘
+    void ConnectInputSignals();
+
+    /// 绑定OpenGL上下文并创建布局，Headless后端同时创建离屏帧缓冲，仅第一次调用时生效
+    void InitContext();
+
+    /// 清空并绘制一帧，Headless后端绘制到离屏帧缓冲
+    void DrawFrame();
+
+    /// 读回当前帧的BGR图像
+    void ReadPixels(cv::Mat &image);
+
+    /// 将当前帧交给帧录制器，并处理录制的开始和结束，仅渲染线程调用
+    void CaptureFrame();
+
+    /// 结束全部录制并等待编码线程写完，仅渲染线程在退出渲染循环、上下文销毁之前调用
+    void FinishRecording();
+
+    /// 在窗口左上角绘制最近一帧的渲染统计，仅渲染线程在Render之后调用
+    void DrawStatsOverlay(const FrameStats &stats);
+
+    static constexpr int kStatsPlotTicks = 8;       ///< 统计绘图每个坐标轴的刻度数量
+    static constexpr float kOverlayMargin = 10;     ///< 叠加层文字到窗口边缘的像素距离
+    static constexpr float kOverlayLineHeight = 18; ///< 叠加层文字的行高（像素）
+
     const std::string window_name_; ///< 窗口名称
     int width_, height_;            ///< 窗口宽高
+    Backend backend_;               ///< 窗口后端
+    bool context_ready_;            ///< 是否已经完成InitContext，仅渲染线程访问
+
+    std::unique_ptr<pangolin::GlTexture> color_texture_;     ///< 离屏颜色缓冲，仅Headless后端使用
+    std::unique_ptr<pangolin::GlRenderBuffer> depth_buffer_; ///< 离屏深度缓冲，仅Headless后端使用
+    std::unique_ptr<pangolin::GlFramebuffer> framebuffer_;   ///< 离屏帧缓冲，仅Headless后端使用
 
     std::atomic<bool> request_stop_; ///< 请求停止flag
+    FrameScheduler::Ptr scheduler_;  ///< 帧调度器，只在需要时重绘
+
+    FrameRecorder::Ptr recorder_;                         ///< 请求的帧录制器，通过std::atomic_load/atomic_store访问
+    FrameRecorder::Ptr active_recorder_;                  ///< 正在录制的帧录制器，仅渲染线程访问
+    std::vector<FrameRecorder::Ptr> finishing_recorders_; ///< 已经结束、编码线程尚未写完的帧录制器，仅渲染线程访问
 
     TasksQueue tasks_queue_;       ///< 创建View任务队列
     std::vector<View::Ptr> views_; ///< View列表，待渲染
 
+    Plotter::Ptr stats_plotter_;      ///< 记录渲染统计的Plotter，为nullptr时不记录
+    std::string stats_plot_name_;     ///< 记录渲染统计的绘图元素名称
+    LockStats last_lock_stats_;       ///< 上一帧结束时的全局生产者等待统计，仅渲染线程访问
+    std::atomic<bool> stats_overlay_; ///< 是否绘制渲染统计的叠加层
+    FrameStats frame_stats_;          ///< 最近一帧的渲染统计，stats_mutex_保护
+    mutable std::mutex stats_mutex_;  ///< 渲染统计的互斥量
+
     std::unordered_map<std::string, cv::Mat> images_; ///< 窗口名称和待渲染图像
     std::mutex image_mutex_;                          ///< 图像锁
 };
@@ -26,10 +26,8 @@ public:
     /// 箭头的清除函数，线程安全
     virtual void Clear() override {
         UIItem::Clear();
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            points_.clear();
-        }
+        points_.Publish({});
+        MarkUpdate();
     }
 
     /// ui元素的更新函数
@@ -48,7 +46,10 @@ private:
     /// 计算头部长度
     float ComputeHeadLength(float head_length);
 
-    std::vector<Vec3> points_; ///< 自身坐标系下的4个点
+    /// 计算世界坐标系下箭头的6个点
+    std::vector<Vec3> ComputePoints(const SE3 &Twi, float arrow_length);
+
+    TripleBuffer<std::vector<Vec3>> points_; ///< 世界坐标系下的6个点，生产者发布，渲染线程上传
 
     HeadType head_type_;      ///< 箭头头部类型
     float head_length_ratio_; ///< 箭头头部比例长度
@@ -25,8 +25,8 @@ public:
     void ResetTwi(const SE3 &Twi) override;
 
 private:
-    std::vector<Vec3> points_;        ///< 世界坐标系下的点
-    std::vector<Vec3> origin_points_; ///< 自身坐标系下的点
+    TripleBuffer<std::vector<Vec3>> points_; ///< 世界坐标系下的点，生产者发布，渲染线程上传
+    std::vector<Vec3> origin_points_;        ///< 自身坐标系下的点
 };
 
 } // namespace slam_viewer
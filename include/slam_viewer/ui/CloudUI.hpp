@@ -1,20 +1,93 @@
 #pragma once
+#include <cmath>
 #include <execution>
 
 #include <pcl/point_types.h>
 
+#include "slam_viewer/core/ColorMap.h"
 #include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/DynamicBuffer.h"
 
 namespace slam_viewer{
 
+static constexpr int kIntensityTableSize = 256 * 6;         ///< 稠密颜色表的大小
+static constexpr float kMinIntensityIndex = -2147483648.0f; ///< 颜色表索引转为int前的下限，即INT_MIN
+static constexpr float kMaxIntensityIndex = 2147483520.0f;  ///< 颜色表索引转为int前的上限，小于INT_MAX的最大float
+
 extern std::vector<Vec4, Eigen::aligned_allocator<Vec4>> intensity_table_; ///< 颜色表
 extern std::vector<Vec4, Eigen::aligned_allocator<Vec4>> contrast_table_;  ///< 对比色表
 extern bool intensity_table_init_;                                         ///< 颜色表是否初始化
 
-/// 创建稠密颜色表
+/// 创建稠密颜色表，线程安全，只在首次调用时创建
 void BuildIntensityTable();
 
-Vec4 IntensityToRgbPCL(const float &intensity);
+/**
+ * @brief float到颜色的映射，调用前需保证颜色表已创建
+ * @details
+ *      1. 与最初的实现逐位一致：int(intensity * 6)转为无符号数后按颜色表大小取模，
+ *         负数-k经无符号回绕映射到(1024 - k) mod 1536，HeightColor的负高度颜色保持不变
+ *      2. 转为int之前先截断到int的范围，NaN映射为0，避免超大值和非有限值转换的未定义行为
+ */
+inline Vec4 IntensityToRgbPCL(const float &intensity) {
+    float value = intensity * 6;
+    if (std::isnan(value))
+        value = 0;
+    value = std::min(std::max(value, kMinIntensityIndex), kMaxIntensityIndex);
+    std::size_t index = static_cast<std::size_t>(static_cast<int>(value)) % kIntensityTableSize;
+    return intensity_table_[index];
+}
+
+/// PCL颜色着色器，强度经稠密颜色表映射
+struct PCLColorizer {
+    template <typename PointType> Vec4 operator()(const PointType &pt) const { return IntensityToRgbPCL(pt.intensity); }
+};
+
+/// intensity颜色着色器，强度映射为灰度
+struct IntensityColorizer {
+    template <typename PointType> Vec4 operator()(const PointType &pt) const {
+        float intensity_color = pt.intensity / 255.0f * 3.0f;
+        return Vec4(intensity_color, intensity_color, intensity_color, 0.2f);
+    }
+};
+
+/// height颜色着色器，高度经稠密颜色表映射
+struct HeightColorizer {
+    template <typename PointType> Vec4 operator()(const PointType &pt) const { return IntensityToRgbPCL(pt.z * 10); }
+};
+
+/// Gray颜色着色器
+struct GrayColorizer {
+    template <typename PointType> Vec4 operator()(const PointType &) const { return Vec4(0.5f, 0.5f, 0.5f, 0.5f); }
+};
+
+/// ring颜色着色器，线束经对比色表映射
+struct RingColorizer {
+    template <typename PointType> Vec4 operator()(const PointType &pt) const { return contrast_table_[pt.ring % 10]; }
+};
+
+/// 自身颜色着色器，使用点自身的颜色
+struct SelfColorizer {
+    template <typename PointType> Vec4 operator()(const PointType &pt) const { return Vec4(pt.r, pt.g, pt.b, 0.5f); }
+};
+
+/**
+ * @brief 使用着色器计算点云颜色，着色器静态分发，可被编译器内联和向量化
+ * @details
+ *      直接对点云做并行std::transform，不需要索引数组，cloud_color容量足够时不会分配内存
+ * @tparam PointType    点云的点类型
+ * @tparam Colorizer    着色器类型，如PCLColorizer、HeightColorizer
+ * @param cloud         输入的点云
+ * @param cloud_color   输出的点云颜色
+ * @param colorizer     输入的着色器
+ */
+template <typename PointType, typename Colorizer>
+void Colorize(const pcl::PointCloud<PointType> &cloud, std::vector<Vec4> &cloud_color,
+              Colorizer colorizer = Colorizer()) {
+    BuildIntensityTable();
+    cloud_color.resize(cloud.size());
+    std::transform(std::execution::par_unseq, cloud.points.begin(), cloud.points.end(), cloud_color.begin(),
+                   colorizer);
+}
 
 /// 颜色位置工厂模式基类
 // clang-format off
@@ -28,10 +101,7 @@ public:
 
     ColorFactory(PointCloudPtr cloud)
         : cloud_(std::move(cloud)) {
-        if (!intensity_table_init_) {
-            BuildIntensityTable();
-            intensity_table_init_ = true;
-        }
+        BuildIntensityTable();
     }
 
     virtual void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) = 0;
@@ -42,32 +112,39 @@ protected:
     PointCloudPtr cloud_; ///< 点云信息
 };
 
-/// PCL颜色工厂
-template <typename PointType> 
-class PCLColor : public ColorFactory<PointType> {
+/// 基于着色器的颜色工厂，每个点云只有一次虚函数调用，逐点计算由Colorize静态分发
+template <typename PointType, typename Colorizer> 
+class ColorizerFactory : public ColorFactory<PointType> {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
-    typedef std::shared_ptr<PCLColor> Ptr;
-    typedef std::shared_ptr<const PCLColor> ConstPtr;
+    typedef std::shared_ptr<ColorizerFactory> Ptr;
+    typedef std::shared_ptr<const ColorizerFactory> ConstPtr;
 
-    PCLColor(PointCloudPtr cloud)
+    ColorizerFactory(PointCloudPtr cloud)
         : ColorFactory<PointType>(cloud) {}
 
     void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
-        cloud_color.resize(this->cloud_->size());
+        Colorize<PointType>(*this->cloud_, cloud_color, Colorizer());
+    }
+};
 
-        std::vector<int> idx(this->cloud_->size());
-        std::iota(idx.begin(), idx.end(), 0);
+/// PCL颜色工厂
+template <typename PointType> 
+class PCLColor : public ColorizerFactory<PointType, PCLColorizer> {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
+    typedef std::shared_ptr<PCLColor> Ptr;
+    typedef std::shared_ptr<const PCLColor> ConstPtr;
 
-        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(),
-                      [&](const int &id) { cloud_color[id] = IntensityToRgbPCL(this->cloud_->points[id].intensity); });
-    }
+    PCLColor(PointCloudPtr cloud)
+        : ColorizerFactory<PointType, PCLColorizer>(cloud) {}
 };
 
 /// intensity颜色工厂
 template <typename PointType> 
-class IntensityColor : public ColorFactory<PointType> {
+class IntensityColor : public ColorizerFactory<PointType, IntensityColorizer> {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
@@ -75,25 +152,12 @@ public:
     typedef std::shared_ptr<const IntensityColor> ConstPtr;
 
     IntensityColor(PointCloudPtr cloud)
-        : ColorFactory<PointType>(cloud) {}
-
-    void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
-        cloud_color.resize(this->cloud_->size());
-
-        std::vector<int> idx(this->cloud_->size());
-        std::iota(idx.begin(), idx.end(), 0);
-
-        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
-            const auto &pt = this->cloud_->points[id];
-            float intensity_color = pt.intensity / 255.0 * 3.0;
-            cloud_color[id] = Vec4(intensity_color, intensity_color, intensity_color, 0.2);
-        });
-    }
+        : ColorizerFactory<PointType, IntensityColorizer>(cloud) {}
 };
 
 /// height颜色工厂
 template <typename PointType> 
-class HeightColor : public ColorFactory<PointType> {
+class HeightColor : public ColorizerFactory<PointType, HeightColorizer> {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
@@ -101,103 +165,90 @@ public:
     typedef std::shared_ptr<const HeightColor> ConstPtr;
 
     HeightColor(PointCloudPtr cloud)
-        : ColorFactory<PointType>(cloud) {}
-
-    void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
-        cloud_color.resize(this->cloud_->size());
-
-        std::vector<int> idx(this->cloud_->size());
-        std::iota(idx.begin(), idx.end(), 0);
-
-        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
-            const auto &pt = this->cloud_->points[id];
-            cloud_color[id] = IntensityToRgbPCL(pt.z * 10);
-        });
-    }
+        : ColorizerFactory<PointType, HeightColorizer>(cloud) {}
 };
 
 /// Gray颜色工厂
 template <typename PointType> 
-class GrayColor : public ColorFactory<PointType> {
+class GrayColor : public ColorizerFactory<PointType, GrayColorizer> {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
     typedef std::shared_ptr<GrayColor> Ptr;
     typedef std::shared_ptr<const GrayColor> ConstPtr;
-    
 
     GrayColor(PointCloudPtr cloud)
-        : ColorFactory<PointType>(cloud) {}
-
-    void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
-        cloud_color.resize(this->cloud_->size());
-
-        std::vector<int> idx(this->cloud_->size());
-        std::iota(idx.begin(), idx.end(), 0);
-
-        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
-            const auto &pt = this->cloud_->points[id];
-            cloud_color[id] = Vec4(0.5, 0.5, 0.5, 0.5);
-        });
-    }
+        : ColorizerFactory<PointType, GrayColorizer>(cloud) {}
 };
 
-
 /// ring颜色工厂(以线束信息作为颜色指标)
 template <typename PointType> 
-class RingColor : public ColorFactory<PointType> {
+class RingColor : public ColorizerFactory<PointType, RingColorizer> {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
     typedef std::shared_ptr<RingColor> Ptr;
     typedef std::shared_ptr<const RingColor> ConstPtr;
-    
 
     RingColor(PointCloudPtr cloud)
-        : ColorFactory<PointType>(cloud) {}
-
-    void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
-        cloud_color.resize(this->cloud_->size());
-
-        std::vector<int> idx(this->cloud_->size());
-        std::iota(idx.begin(), idx.end(), 0);
-
-        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
-            const auto &ring = this->cloud_->points[id].ring;
-            
-            cloud_color[id] = contrast_table_[ring % 10];
-        });
-    }
+        : ColorizerFactory<PointType, RingColorizer>(cloud) {}
 };
 
 /// 自身颜色工厂，使用自身的颜色
 template <typename PointType> 
-class SelfColor : public ColorFactory<PointType> {
+class SelfColor : public ColorizerFactory<PointType, SelfColorizer> {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     typedef typename pcl::PointCloud<PointType>::Ptr PointCloudPtr;
     typedef std::shared_ptr<SelfColor> Ptr;
     typedef std::shared_ptr<const SelfColor> ConstPtr;
-    
 
     SelfColor(PointCloudPtr cloud)
-        : ColorFactory<PointType>(cloud) {}
+        : ColorizerFactory<PointType, SelfColorizer>(cloud) {}
+};
 
-    void CreateColor(const std::vector<Vec3> &cloud_xyz, std::vector<Vec4> &cloud_color) override {
-        cloud_color.resize(this->cloud_->size());
+// clang-format on
 
-        std::vector<int> idx(this->cloud_->size());
-        std::iota(idx.begin(), idx.end(), 0);
+/// 强度标量，供GPU颜色映射使用
+struct IntensityScalar {
+    template <typename PointType> float operator()(const PointType &pt) const { return pt.intensity; }
+};
 
-        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
-            const auto &point = this->cloud_->points[id];
-            Vec4 color = {point.r, point.g, point.b, 0.5};
-            cloud_color[id] = color;
-        });
-    }
+/// 线束标量，供GPU颜色映射使用
+struct RingScalar {
+    template <typename PointType> float operator()(const PointType &pt) const { return pt.ring; }
 };
 
-// clang-format on
+/// 时间戳偏置标量，供GPU颜色映射使用
+struct TimeScalar {
+    template <typename PointType> float operator()(const PointType &pt) const { return pt.offset_time; }
+};
+
+/// 点云坐标系下的高度标量，供GPU颜色映射使用
+struct HeightScalar {
+    template <typename PointType> float operator()(const PointType &pt) const { return pt.z; }
+};
+
+/**
+ * @brief 将点云变换到目标坐标系下，并使用颜色工厂计算颜色，非渲染线程调用
+ *
+ * @tparam PointType        点云的点类型
+ * @param cloud             输入的点云
+ * @param Tij               输入的点云坐标系到目标坐标系的变换
+ * @param color_factory     输入的颜色工厂
+ * @param cloud_xyz         输出的目标坐标系下的点云位置
+ * @param cloud_color       输出的点云颜色
+ */
+template <typename PointType>
+void TransformCloud(const typename pcl::PointCloud<PointType>::Ptr &cloud, const SE3 &Tij,
+                    const typename ColorFactory<PointType>::Ptr &color_factory, std::vector<Vec3> &cloud_xyz,
+                    std::vector<Vec4> &cloud_color) {
+    cloud_xyz.resize(cloud->size());
+    std::transform(std::execution::par_unseq, cloud->points.begin(), cloud->points.end(), cloud_xyz.begin(),
+                   [&](const PointType &pt) -> Vec3 { return Tij * pt.getVector3fMap(); });
+
+    color_factory->CreateColor(cloud_xyz, cloud_color);
+}
 
 /// 点云UI
 class CloudUI : public UIItem {
@@ -207,74 +258,126 @@ public:
     typedef std::shared_ptr<CloudUI> Ptr;
     typedef std::shared_ptr<const CloudUI> ConstPtr;
 
-    CloudUI(Vec3 color = Vec3(0.5, 0.5, 0.5), float line_width = 3.0, float point_size = 1.0)
-        : UIItem(color, line_width, point_size) {}
+    /// 点云的存储格式
+    enum class StorageType {
+        Float, ///< 浮点位置和浮点颜色，每个点28字节
+        Packed ///< 分块相对的16位量化位置和RGBA8颜色，每个点10字节
+    };
+
+    static constexpr float kChunkSize = 64.0f;   ///< Packed格式下分块的边长
+    static constexpr float kQuantScale = 0.001f; ///< Packed格式下位置的量化步长，块内坐标范围为±32000步
+
+    CloudUI(Vec3 color = Vec3(0.5, 0.5, 0.5), float line_width = 3.0, float point_size = 1.0,
+            StorageType storage = StorageType::Float)
+        : UIItem(color, line_width, point_size)
+        , storage_(storage)
+        , xyz_buffer_(GL_FLOAT, 3)
+        , color_buffer_(GL_FLOAT, 4)
+        , scalar_buffer_(GL_FLOAT, 1) {}
+
+    /// 析构函数，注销在ColorMap上注册的重绘回调
+    ~CloudUI() override {
+        if (ColorMap::Ptr color_map = std::atomic_load(&color_map_))
+            color_map->RemoveListener(this);
+    }
 
-    /// 设置点云信息，位置和颜色，非渲染线程调用
+    /// 设置点云信息，位置和颜色，非渲染线程调用，点云以Twi作为自身坐标系存储
     template <typename PointType>
     void SetCloud(typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi,
                   typename ColorFactory<PointType>::Ptr color_factory) {
         if (!cloud || cloud->empty())
             return;
 
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            cloud_xyz_.clear();
-            cloud_color_.clear();
-        }
-
+        ResetCloud(Twi);
         this->template AddCloud<PointType>(cloud, Twi, color_factory);
-        Twi_ = std::move(Twi);
     }
 
-    /// 更新点云的坐标，非渲染线程调用
+    /// 设置点云信息，位置和标量，非渲染线程调用，颜色由GPU颜色映射计算
+    template <typename PointType, typename ScalarFunc>
+    void SetScalarCloud(typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi, ScalarFunc scalar_func) {
+        if (!cloud || cloud->empty())
+            return;
+
+        ResetCloud(Twi);
+        this->template AddScalarCloud<PointType>(cloud, Twi, scalar_func);
+    }
+
+    /// 更新点云的坐标，非渲染线程调用，仅更新模型矩阵，不涉及点的变换和上传
     void ResetTwi(const SE3 &Twi) override;
 
-    /// 添加点云，非渲染线程调用，进行点云的合并
+    /// 添加点云，非渲染线程调用，进行点云的合并，点被变换到点云自身坐标系下存储
     template <typename PointType>
     void AddCloud(typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi,
                   typename ColorFactory<PointType>::Ptr color_factory) {
         if (!cloud || cloud->empty())
             return;
 
-        std::vector<Vec3> cloud_xyz(cloud->size());
-        std::vector<Vec4> cloud_color(cloud->size());
+        SE3 Tij;
+        {
+            auto lock = ProducerLock();
+            Tij = Twi_.inverse() * Twi;
+        }
 
-        std::vector<int> idx(cloud->size());
-        std::iota(idx.begin(), idx.end(), 0);
+        std::vector<Vec3> cloud_xyz;
+        std::vector<Vec4> cloud_color;
+        TransformCloud<PointType>(cloud, Tij, color_factory, cloud_xyz, cloud_color);
+        AppendPoints(cloud_xyz, cloud_color, {});
+    }
 
-        std::for_each(std::execution::par_unseq, idx.begin(), idx.end(), [&](const int &id) {
-            const auto &pt = cloud->points[id];
-            Vec3 pt_world = Twi * pt.getVector3fMap();
-            cloud_xyz[id] = pt_world;
-        });
+    /**
+     * @brief 添加点云，非渲染线程调用，每个点只保存一个标量，颜色在渲染时由ColorMap映射
+     * @details
+     *      1. 切换颜色模式或映射范围只需修改ColorMap的uniform变量，不需要重新计算和上传点云
+     *      2. 可以与AddCloud混合使用，上传时缺少的颜色以UI颜色补齐，缺少的标量以0补齐，各缓冲区始终等长
+     * @tparam PointType    点云的点类型
+     * @tparam ScalarFunc   标量提取器，如IntensityScalar、RingScalar、TimeScalar
+     * @param cloud         输入的点云
+     * @param Twi           输入的点云在世界坐标系下的位姿
+     * @param scalar_func   输入的标量提取器
+     */
+    template <typename PointType, typename ScalarFunc>
+    void AddScalarCloud(typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi, ScalarFunc scalar_func) {
+        if (!cloud || cloud->empty())
+            return;
 
-        color_factory->CreateColor(cloud_xyz, cloud_color);
+        SE3 Tij;
+        {
+            auto lock = ProducerLock();
+            Tij = Twi_.inverse() * Twi;
+        }
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        cloud_xyz_.insert(cloud_xyz_.end(), cloud_xyz.begin(), cloud_xyz.end());
-        cloud_color_.insert(cloud_color_.end(), cloud_color.begin(), cloud_color.end());
-        need_update_.store(true);
+        std::vector<Vec3> cloud_xyz(cloud->size());
+        std::vector<float> cloud_scalar(cloud->size());
+        std::transform(std::execution::par_unseq, cloud->points.begin(), cloud->points.end(), cloud_xyz.begin(),
+                       [&](const PointType &pt) -> Vec3 { return Tij * pt.getVector3fMap(); });
+        std::transform(std::execution::par_unseq, cloud->points.begin(), cloud->points.end(), cloud_scalar.begin(),
+                       scalar_func);
+        AppendPoints(cloud_xyz, {}, cloud_scalar);
     }
 
-    /// 更新渲染函数，渲染线程调用
-    void Update() override {
-        if (need_update_.load()) {
-            need_update_.store(false);
-
-            std::lock_guard<std::mutex> lock(mutex_);
-            vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, cloud_xyz_);
-            cbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, cloud_color_);
-        }
+    /// 设置GPU颜色映射，非渲染线程调用，设置后使用标量和颜色表渲染，为nullptr时使用逐点颜色，只请求重绘，映射参数变化时同样请求重绘
+    void SetColorMap(ColorMap::Ptr color_map) {
+        if (color_map)
+            color_map->AddListener(this, [this]() { MarkRedraw(); });
+        ColorMap::Ptr old_map = std::atomic_exchange(&color_map_, color_map);
+        if (old_map && old_map != color_map)
+            old_map->RemoveListener(this);
+        MarkRedraw();
     }
 
-    /// CloudUI是否有效
+    /// 更新渲染函数，渲染线程调用，仅上传新发布的点并扩展包围盒
+    void Update() override;
+
+    /// CloudUI是否有效，颜色或标量缓冲区以及Packed格式下各分块的显存在渲染时单独判断
     bool IsValid() override {
-        bool vbo_valid = vbo_.IsValid();
-        bool cbo_valid = cbo_.IsValid();
-        return vbo_valid && cbo_valid;
+        if (storage_ == StorageType::Packed)
+            return true;
+        return xyz_buffer_.IsValid();
     }
 
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override;
+
     /// 点云UI渲染函数
     void Render() override;
 
@@ -282,9 +385,96 @@ public:
     void Clear() override;
 
 private:
-    pangolin::GlBuffer cbo_;        ///< 显存颜色信息
-    std::vector<Vec3> cloud_xyz_;   ///< 点云位置信息
-    std::vector<Vec4> cloud_color_; ///< 点云颜色信息
+    /// Packed格式的点云分块，块内位置相对分块中心量化为16位整数，渲染时由模型矩阵还原
+    struct Chunk {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        Chunk(const Eigen::Vector3i &key)
+            : xyz_buffer_(GL_SHORT, 3)
+            , color_buffer_(GL_UNSIGNED_BYTE, 4)
+            , scalar_buffer_(GL_FLOAT, 1) {
+            Reset(key);
+        }
+
+        /// 将分块移动到新的分块索引处并清空点，保留已分配的显存，供空闲分块复用
+        void Reset(const Eigen::Vector3i &key) {
+            origin_ = (key.cast<float>() + Vec3::Constant(0.5f)) * kChunkSize;
+            box_ = Eigen::AlignedBox3f(origin_ - Vec3::Constant(0.5f * kChunkSize + kQuantScale),
+                                       origin_ + Vec3::Constant(0.5f * kChunkSize + kQuantScale));
+            xyz_buffer_.Resize(0);
+            color_buffer_.Resize(0);
+            scalar_buffer_.Resize(0);
+        }
+
+        Vec3 origin_;                 ///< 分块中心
+        Eigen::AlignedBox3f box_;     ///< 点云坐标系下分块的包围盒，用于分块级的视锥体剔除
+        DynamicBuffer xyz_buffer_;    ///< 显存位置信息，量化后的块内位置，仅追加新点
+        DynamicBuffer color_buffer_;  ///< 显存颜色信息，RGBA8颜色，仅追加新点
+        DynamicBuffer scalar_buffer_; ///< 显存标量信息，仅追加新点
+    };
+
+    /// Packed格式下一个分块内新增的点
+    struct PackedPoints {
+        Eigen::Vector3i key_;       ///< 分块索引
+        std::vector<Vec3s> xyz_;    ///< 量化后的块内位置
+        std::vector<Vec4b> color_;  ///< RGBA8颜色
+        std::vector<float> scalar_; ///< 颜色映射使用的标量
+    };
+
+    /// 生产者线程在锁外准备好的一批点，通过BatchQueue发布给渲染线程
+    struct CloudBatch {
+        bool reset_ = false;               ///< 追加前是否清空点云
+        std::vector<Vec3> xyz_;            ///< Float格式的位置
+        std::vector<Vec4> color_;          ///< Float格式的颜色
+        std::vector<float> scalar_;        ///< Float格式的标量
+        std::vector<PackedPoints> packed_; ///< Packed格式按分块分组的点
+    };
+
+    /// 分块索引的哈希函数
+    struct ChunkKeyHash {
+        std::size_t operator()(const Eigen::Vector3i &key) const {
+            return (std::size_t(key.x()) * 73856093) ^ (std::size_t(key.y()) * 19349663) ^
+                   (std::size_t(key.z()) * 83492791);
+        }
+    };
+
+    /// 清空点云并设置新的自身坐标系，非渲染线程调用
+    void ResetCloud(const SE3 &Twi);
+
+    /// 按存储格式追加点云坐标系下的点，颜色和标量可以为空，非渲染线程调用
+    void AppendPoints(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color,
+                      const std::vector<float> &cloud_scalar);
+
+    /// 以浮点格式追加点云坐标系下的点，非渲染线程调用
+    void AppendFloat(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color,
+                     const std::vector<float> &cloud_scalar);
+
+    /// 以Packed格式追加点云坐标系下的点，非渲染线程调用
+    void AppendPacked(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color,
+                      const std::vector<float> &cloud_scalar);
+
+    /// 将一批点追加到显存，仅渲染线程调用
+    void UploadBatch(CloudBatch &batch);
+
+    /// 获取分块索引对应的分块，不存在时优先复用空闲分块，仅渲染线程调用
+    Chunk &AcquireChunk(const Eigen::Vector3i &key);
+
+    /// 使用逐点颜色或ColorMap绘制点，model为顶点坐标到世界坐标系的变换，仅渲染线程调用
+    void DrawPoints(const ColorMap::Ptr &color_map, const DynamicBuffer &xyz_buffer,
+                    const DynamicBuffer &color_buffer, const DynamicBuffer &scalar_buffer, const Mat4 &model);
+
+    StorageType storage_; ///< 点云的存储格式
+
+    BatchQueue<CloudBatch> batches_; ///< 等待上传的点，生产者无锁压入
+    ColorMap::Ptr color_map_;        ///< GPU颜色映射，通过std::atomic_load/atomic_store访问
+
+    DynamicBuffer xyz_buffer_;    ///< 显存位置信息，预留容量，仅追加新点，仅渲染线程访问
+    DynamicBuffer color_buffer_;  ///< 显存颜色信息，预留容量，仅追加新点，仅渲染线程访问
+    DynamicBuffer scalar_buffer_; ///< 显存标量信息，预留容量，仅追加新点，仅渲染线程访问
+
+    std::vector<std::unique_ptr<Chunk>> chunks_;                                 ///< Packed格式的分块，仅渲染线程访问
+    std::vector<std::unique_ptr<Chunk>> free_chunks_;                            ///< 重置后空闲的分块，仅渲染线程访问
+    std::unordered_map<Eigen::Vector3i, std::size_t, ChunkKeyHash> chunk_index_; ///< 分块索引到chunks_下标的映射
 };
 
 }
\ No newline at end of file
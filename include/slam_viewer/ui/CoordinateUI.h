@@ -1,10 +1,10 @@
 #pragma once
 
-#include "slam_viewer/ui/ArrowUI.h"
 #include "slam_viewer/core/Common.h"
 
 namespace slam_viewer{
 
+/// 坐标系UI，三个坐标轴共用一份单位长度的几何，位姿和轴长通过模型矩阵作用
 class CoordinateUI : public UIItem {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -13,36 +13,36 @@ public:
     typedef std::shared_ptr<const CoordinateUI> ConstPtr;
 
     CoordinateUI(float arrow_length, SE3 Twi = SE3());
-    
-    /// 重置坐标轴变换，非渲染线程调用
+
+    /**
+     * @brief 创建单位长度的坐标轴几何，按GL_LINES绘制，x、y、z轴分别为红、绿、蓝
+     *
+     * @param xyz   输出的顶点位置，每个轴为箭身和两侧箭头共6个顶点
+     * @param color 输出的顶点颜色
+     */
+    static void BuildAxisGeometry(std::vector<Vec3> &xyz, std::vector<Vec4> &color);
+
+    /// 重置坐标轴变换，非渲染线程调用，仅更新模型矩阵
     void ResetTwi(const SE3 &Twi) override;
 
-    /// 重置坐标轴长度，非渲染线程调用
+    /// 重置坐标轴长度，非渲染线程调用，缩放模型矩阵并在下次更新时缩放包围盒
     void ResetLength(float arrow_length);
-    
-    /// 更新
+
+    /// 更新，首次调用时上传坐标轴几何，轴长变化时重新设置包围盒
     void Update() override;
-    
+
     /// 清理
     void Clear() override;
-    
+
     /// 判断坐标轴是否有效
-    bool IsValid() override {
-        bool x_valid = x_axis_->IsValid();
-        bool y_valid = y_axis_->IsValid();
-        bool z_valid = z_axis_->IsValid();
-        return x_valid && y_valid && z_valid;
-    }
+    bool IsValid() override { return vbo_.IsValid() && cbo_.IsValid(); }
 
     /// 渲染
     void Render() override;
 
 private:
-    ArrowUI::Ptr x_axis_; ///< x轴
-    ArrowUI::Ptr y_axis_; ///< y轴
-    ArrowUI::Ptr z_axis_; ///< z轴
-
-    SE3 x_rot_, y_rot_, z_rot_; ///< 沿着轴旋转的旋转矩阵
+    pangolin::GlBuffer cbo_;          ///< 坐标轴顶点颜色
+    std::atomic<float> arrow_length_; ///< 轴长
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/DynamicBuffer.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 坐标系树UI，类似TF树，维护父子坐标系之间的相对变换，全部坐标系通过一次实例化绘制
+ * @details
+ *      1. 坐标轴几何由CoordinateUI::BuildAxisGeometry创建，所有坐标系共用
+ *      2. 修改相对变换只标记该坐标系，UI坐标系下的位姿在更新或查询时只对被标记的子树重新计算
+ *      3. 每个坐标系只保存一个包含轴长缩放的4x4实例矩阵，只上传位姿变化的坐标系区间
+ */
+class FrameTreeUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<FrameTreeUI> Ptr;
+    typedef std::shared_ptr<const FrameTreeUI> ConstPtr;
+
+    FrameTreeUI(float line_width = 3.0, SE3 Twi = SE3());
+
+    /**
+     * @brief 添加坐标系，非渲染线程调用
+     *
+     * @param name      输入的坐标系名称，已存在时返回-1
+     * @param parent    输入的父坐标系名称，为空时父坐标系为UI坐标系，不存在时返回-1
+     * @param Tpc       输入的坐标系在父坐标系下的位姿
+     * @param length    输入的坐标轴长度
+     * @return int      输出的坐标系编号
+     */
+    int AddFrame(const std::string &name, const std::string &parent, const SE3 &Tpc, float length = 1.0);
+
+    /// 设置坐标系在父坐标系下的位姿，非渲染线程调用，坐标系不存在时返回false
+    bool SetTransform(const std::string &name, const SE3 &Tpc);
+
+    /// 设置坐标系在父坐标系下的位姿，非渲染线程调用，编号无效时返回false
+    bool SetTransform(int id, const SE3 &Tpc);
+
+    /// 查找坐标系编号，不存在时返回-1
+    int FindFrame(const std::string &name);
+
+    /// 获取坐标系在UI坐标系下的位姿，必要时先传播被标记的子树，坐标系不存在时返回false
+    bool GetPose(const std::string &name, SE3 &Tic);
+
+    /// 坐标系数量
+    std::size_t Size();
+
+    /// 更新函数，渲染线程调用，传播被标记的子树并上传变化的实例矩阵
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清理函数，删除全部坐标系
+    void Clear() override;
+
+    /// 是否有效
+    bool IsValid() override { return vbo_.IsValid() && cbo_.IsValid() && pose_buffer_.Size() > 0; }
+
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override {
+        std::size_t bytes = UIItem::GpuBytes() + pose_buffer_.CapacityBytes();
+        return cbo_.IsValid() ? bytes + std::size_t(cbo_.size_bytes) : bytes;
+    }
+
+private:
+    /// 坐标系树的节点
+    struct Node {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        std::string name_;          ///< 坐标系名称
+        int parent_;                ///< 父坐标系编号，-1表示UI坐标系
+        std::vector<int> children_; ///< 子坐标系编号
+        int depth_;                 ///< 在树中的深度，UI坐标系的子坐标系为0
+        SE3 Tpc_;                   ///< 在父坐标系下的位姿
+        SE3 Tic_;                   ///< 在UI坐标系下的位姿，dirty_为true时无效
+        float length_;              ///< 坐标轴长度
+        bool dirty_;                ///< 自身或祖先的相对位姿被修改，Tic_需要重新计算
+    };
+
+    /// 标记坐标系的子树需要重新计算，需持有mutex_
+    void MarkDirty(int id);
+
+    /// 按深度从浅到深传播被标记的子树，记录位姿变化的编号区间，需持有mutex_
+    void Propagate();
+
+    /// 编译着色器，仅渲染线程调用
+    void InitProgram();
+
+    std::vector<Node, Eigen::aligned_allocator<Node>> nodes_;  ///< 坐标系树的节点，mutex_保护
+    std::unordered_map<std::string, int> index_;               ///< 坐标系名称到编号的映射，mutex_保护
+    std::vector<int> dirty_nodes_;                             ///< 被标记的坐标系编号，mutex_保护
+    std::vector<Mat4, Eigen::aligned_allocator<Mat4>> models_; ///< 各坐标系的实例矩阵，mutex_保护
+    std::size_t changed_begin_;                                ///< 尚未上传的实例矩阵区间起点，mutex_保护
+    std::size_t changed_end_;                                  ///< 尚未上传的实例矩阵区间终点，mutex_保护
+    bool need_reset_;                                          ///< 是否需要清空显存，mutex_保护
+
+    pangolin::GlBuffer cbo_;        ///< 坐标轴顶点颜色
+    DynamicBuffer pose_buffer_;     ///< 实例矩阵，每个元素为列主序的4x4矩阵
+    bool program_init_;             ///< 着色器是否已创建，仅渲染线程访问
+    pangolin::GlSlProgram program_; ///< 实例化绘制的着色器
+    GLint pose_location_;           ///< 实例矩阵属性的位置，占用连续4个位置
+};
+
+} // namespace slam_viewer
@@ -26,8 +26,8 @@ public:
     virtual void ResetTwi(const SE3 &Twi);
 
 private:
-    std::vector<Vec3> points_;        ///< 世界坐标系下的坐标点
-    std::vector<Vec3> origin_points_; ///< 自身坐标系下的坐标点
+    TripleBuffer<std::vector<Vec3>> points_; ///< 世界坐标系下的坐标点，生产者发布，渲染线程上传
+    std::vector<Vec3> origin_points_;        ///< 自身坐标系下的坐标点
 };
 
 }
\ No newline at end of file
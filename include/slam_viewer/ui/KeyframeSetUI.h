@@ -0,0 +1,98 @@
+#pragma once
+
+#include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/DynamicBuffer.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 关键帧集合UI，替代每个关键帧一个FrameUI的方式
+ * @details
+ *      1. 相机视锥的20个顶点只上传一次，每个关键帧只保存位姿矩阵和颜色两个实例属性
+ *      2. 全部关键帧通过一次glDrawArraysInstanced绘制，不随关键帧数量增加状态切换和绘制调用
+ *      3. 位姿和颜色分别存放，更新一个关键帧的位姿只上传64字节
+ */
+class KeyframeSetUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<KeyframeSetUI> Ptr;
+    typedef std::shared_ptr<const KeyframeSetUI> ConstPtr;
+
+    static constexpr std::size_t kMergeGap = 4;       ///< 变化编号的间隔不超过该值时合并为同一上传区间
+    static constexpr std::size_t kMaxUploadRuns = 64; ///< 上传区间超过该数量时改为上传整个变化范围
+
+    KeyframeSetUI(Vec3 color = Vec3(0, 1, 0), float line_width = 2.0, float width = 3.0, float height = 2.0,
+                  float depth = 2.0);
+
+    /// 添加关键帧，使用UI的统一颜色，返回关键帧编号，非渲染线程调用
+    std::size_t AddKeyframe(const SE3 &Twc) { return AddKeyframe(Twc, color_); }
+
+    /// 添加关键帧，返回关键帧编号，非渲染线程调用
+    std::size_t AddKeyframe(const SE3 &Twc, const Vec3 &color);
+
+    /// 更新关键帧的位姿，非渲染线程调用
+    void UpdatePose(std::size_t id, const SE3 &Twc);
+
+    /// 更新关键帧的颜色，非渲染线程调用
+    void UpdateColor(std::size_t id, const Vec3 &color);
+
+    /// 关键帧数量
+    std::size_t Size() const { return size_.load(); }
+
+    /// 更新函数，渲染线程调用，只上传本帧变化的实例所在的区间
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清理函数，不应与AddKeyframe并发调用
+    void Clear() override;
+
+    /// 是否有效
+    bool IsValid() override { return vbo_.IsValid() && pose_buffer_.Size() > 0; }
+
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override {
+        return UIItem::GpuBytes() + pose_buffer_.CapacityBytes() + color_buffer_.CapacityBytes();
+    }
+
+private:
+    /// 生产者发布的关键帧修改
+    struct KeyframeOp {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        bool reset_ = false;     ///< 是否为清空关键帧的标记
+        std::size_t id_ = 0;     ///< 关键帧编号
+        bool has_pose_ = false;  ///< 是否修改位姿
+        Mat4 pose_;              ///< 关键帧位姿矩阵
+        bool has_color_ = false; ///< 是否修改颜色
+        Vec4 color_;             ///< 关键帧颜色
+    };
+
+    /// 初始化着色器，仅渲染线程调用
+    void InitProgram();
+
+    /// 绑定实例属性，仅渲染线程调用
+    void BindInstances();
+
+    /// 解绑实例属性，仅渲染线程调用
+    void UnbindInstances();
+
+    std::vector<Vec3> origin_points_; ///< 自身坐标系下的视锥顶点
+    std::atomic<std::size_t> size_;   ///< 已分配的关键帧编号数量
+    BatchQueue<KeyframeOp> pending_;  ///< 等待渲染线程处理的修改
+
+    std::vector<Mat4, Eigen::aligned_allocator<Mat4>> poses_;  ///< 关键帧位姿，仅渲染线程访问
+    std::vector<Vec4, Eigen::aligned_allocator<Vec4>> colors_; ///< 关键帧颜色，仅渲染线程访问
+    std::vector<std::size_t> pose_dirty_;                      ///< 本次更新中位姿变化的编号，仅渲染线程访问
+    std::vector<std::size_t> color_dirty_;                     ///< 本次更新中颜色变化的编号，仅渲染线程访问
+    DynamicBuffer pose_buffer_;                                ///< 位姿实例属性，每个元素为列主序的4x4矩阵
+    DynamicBuffer color_buffer_;                               ///< 颜色实例属性
+    bool program_init_;                                        ///< 着色器是否已创建，仅渲染线程访问
+    pangolin::GlSlProgram program_;                            ///< 实例化绘制的着色器
+    GLint pose_location_;                                      ///< 位姿属性的位置，占用连续4个位置
+    GLint color_location_;                                     ///< 颜色属性的位置
+};
+
+} // namespace slam_viewer
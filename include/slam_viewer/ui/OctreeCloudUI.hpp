@@ -0,0 +1,151 @@
+#pragma once
+#include <array>
+
+#include "slam_viewer/ui/CloudUI.hpp"
+
+namespace slam_viewer {
+
+/// 八叉树多层次细节点云UI，每帧按节点的屏幕投影尺寸在全局点数预算内选择节点渲染
+class OctreeCloudUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<OctreeCloudUI> Ptr;
+    typedef std::shared_ptr<const OctreeCloudUI> ConstPtr;
+
+    static constexpr int kGridDim = 16;                               ///< 内部节点采样网格每个方向上的格子数
+    static constexpr int kGridCells = kGridDim * kGridDim * kGridDim; ///< 内部节点采样网格的格子数
+    static constexpr std::size_t kLeafPoints = 8192;                  ///< 叶子节点的最大点数
+    static constexpr std::size_t kMaxUploadPoints = 2000000;          ///< 单帧最大上传点数
+
+    OctreeCloudUI(std::size_t point_budget = 3000000, std::size_t gpu_point_budget = 50000000,
+                  float min_node_pixels = 80.f, float min_half_size = 0.5f, Vec3 color = Vec3(0.5, 0.5, 0.5),
+                  float line_width = 3.0, float point_size = 1.0);
+
+    /// 添加点云，非渲染线程调用，点被变换到UI自身坐标系下插入八叉树
+    template <typename PointType>
+    void AddCloud(typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi,
+                  typename ColorFactory<PointType>::Ptr color_factory) {
+        if (!cloud || cloud->empty())
+            return;
+
+        SE3 Tij;
+        {
+            auto lock = ProducerLock();
+            Tij = Twi_.inverse() * Twi;
+        }
+
+        std::vector<Vec3> cloud_xyz;
+        std::vector<Vec4> cloud_color;
+        TransformCloud<PointType>(cloud, Tij, color_factory, cloud_xyz, cloud_color);
+        InsertPoints(cloud_xyz, cloud_color);
+    }
+
+    /// 渲染函数，进行节点选择、按需上传和显存淘汰
+    void Render() override;
+
+    /// 清理函数
+    void Clear() override;
+
+    /// 重置八叉树点云在世界坐标系下的位姿，八叉树不重建，下一帧按新的视点重新选择节点
+    void ResetTwi(const SE3 &Twi) override;
+
+    /// 八叉树非空或有待释放的退役树时有效，节点的显存在渲染时按需上传和释放
+    bool IsValid() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return root_ != nullptr || !retired_roots_.empty();
+    }
+
+    /// 显存驻留节点占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override {
+        std::size_t bytes = 0;
+        for (const Node *node : resident_nodes_)
+            bytes += node->xyz_buffer_.CapacityBytes() + node->color_buffer_.CapacityBytes();
+        return bytes;
+    }
+
+    /// 设置每帧渲染的点数预算，非渲染线程调用，下一帧按新的预算选择节点
+    void SetPointBudget(std::size_t point_budget) {
+        point_budget_.store(point_budget);
+        MarkRedraw();
+    }
+
+    /// 获取上一帧渲染的点数
+    std::size_t RenderedPoints() const { return rendered_points_.load(); }
+
+private:
+    /// 八叉树节点，内部节点通过采样网格保留稀疏的代表点，其余点下沉到子节点
+    struct Node {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        Node(const Vec3 &center, float half_size)
+            : center_(center)
+            , half_size_(half_size)
+            , xyz_buffer_(GL_FLOAT, 3)
+            , color_buffer_(GL_FLOAT, 4) {}
+
+        Vec3 center_;                                   ///< 节点中心
+        float half_size_;                               ///< 节点半边长
+        bool leaf_ = true;                              ///< 是否为叶子节点
+        std::array<std::unique_ptr<Node>, 8> children_; ///< 子节点
+        std::vector<bool> occupied_;                    ///< 内部节点采样网格的占用情况
+        std::vector<Vec3> xyz_;                         ///< 节点保存的点
+        std::vector<Vec4> color_;                       ///< 节点保存的点的颜色
+
+        DynamicBuffer xyz_buffer_;   ///< 显存位置信息，仅渲染线程访问
+        DynamicBuffer color_buffer_; ///< 显存颜色信息，仅渲染线程访问
+        bool need_reset_ = false;    ///< 节点的点被重新分配，需要从头上传，mutex_保护
+        std::size_t last_frame_ = 0; ///< 最近一次被渲染的帧号
+    };
+
+    /// 插入UI坐标系下的点，非渲染线程调用
+    void InsertPoints(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color);
+
+    /// 扩展根节点，直到根节点包含box
+    void GrowRoot(const Eigen::AlignedBox3f &box);
+
+    /// 从node开始向下插入一个点
+    void InsertPoint(Node *node, const Vec3 &pt, const Vec4 &color);
+
+    /// 叶子节点分裂为内部节点，重新分配其中的点
+    void Split(Node *node);
+
+    /// 暂存区中一个节点的待上传点
+    struct StagedNode {
+        Node *node_;         ///< 节点
+        bool reset_;         ///< 是否先清空节点的显存
+        std::size_t offset_; ///< 待上传点在暂存区中的起始位置
+        std::size_t num_;    ///< 待上传点的数量
+    };
+
+    /// 选择本帧渲染的节点并暂存待上传的点，持有mutex_时调用
+    void SelectNodes(const Mat4 &Twi);
+
+    /// 将节点中未上传的点拷贝到暂存区，返回拷贝的点数
+    std::size_t StageNode(Node *node);
+
+    /// 上传暂存区中的一个节点，释放mutex_后调用
+    void UploadStaged(const StagedNode &staged);
+
+    /// 显存中的点数超过预算时，淘汰最久未渲染的节点
+    void EvictNodes();
+
+    std::unique_ptr<Node> root_;                       ///< 根节点，mutex_保护
+    std::vector<std::unique_ptr<Node>> retired_roots_; ///< 被清理的八叉树，在渲染线程中释放，mutex_保护
+    float min_half_size_;                              ///< 节点的最小半边长，达到后不再分裂
+    float min_node_pixels_;                            ///< 节点继续细分的最小屏幕投影半径（像素）
+
+    std::atomic<std::size_t> point_budget_;    ///< 每帧渲染的点数预算
+    std::atomic<std::size_t> rendered_points_; ///< 上一帧渲染的点数
+    std::size_t gpu_point_budget_;             ///< 显存中驻留的点数预算
+    std::size_t resident_points_;              ///< 显存中驻留的点数，仅渲染线程访问
+    std::vector<Node *> resident_nodes_;       ///< 显存驻留的节点，仅渲染线程访问
+    std::size_t frame_id_;                     ///< 渲染帧号，仅渲染线程访问
+
+    std::vector<Node *> selected_nodes_;   ///< 本帧选中的节点，仅渲染线程访问
+    std::vector<StagedNode> staged_nodes_; ///< 本帧待上传的节点，仅渲染线程访问
+    std::vector<Vec3> staged_xyz_;         ///< 上传暂存区的位置，仅渲染线程访问
+    std::vector<Vec4> staged_color_;       ///< 上传暂存区的颜色，仅渲染线程访问
+};
+
+} // namespace slam_viewer
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/DynamicBuffer.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 位姿图UI，节点位置和里程计边、回环边存放在共享的显存缓冲区中
+ * @details
+ *      1. 边只保存两个端点的节点编号，作为索引缓冲区绘制，节点移动时边的端点自动跟随，不需要单独更新
+ *      2. 回环之后通过一次UpdatePoses更新全部节点，位置并行计算，只获取一次mutex_，渲染线程只上传一次
+ *      3. 新增的节点和边只追加上传
+ */
+class PoseGraphUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<PoseGraphUI> Ptr;
+    typedef std::shared_ptr<const PoseGraphUI> ConstPtr;
+
+    /// 边的类型
+    enum class EdgeType {
+        Odometry, ///< 里程计边
+        Loop      ///< 回环边
+    };
+
+    PoseGraphUI(Vec3 node_color = Vec3(1.0, 1.0, 0.0), Vec3 odom_color = Vec3(0.0, 1.0, 0.0),
+                Vec3 loop_color = Vec3(1.0, 0.0, 0.0), float line_width = 2.0, float point_size = 5.0,
+                SE3 Twi = SE3());
+
+    /// 添加节点，返回节点编号，非渲染线程调用
+    std::size_t AddNode(const SE3 &Twc);
+
+    /// 添加边，节点编号无效时返回false，非渲染线程调用
+    bool AddEdge(std::size_t from, std::size_t to, EdgeType type = EdgeType::Odometry);
+
+    /**
+     * @brief 批量更新前num个节点的位姿，非渲染线程调用
+     *
+     * @param poses     输入的世界坐标系下的节点位姿，第i个元素对应编号为i的节点
+     * @param num       输入的位姿数量，不能超过节点数量
+     * @return true     更新成功
+     * @return false    位姿数量超过节点数量
+     */
+    bool UpdatePoses(const SE3 *poses, std::size_t num);
+
+    /// 批量更新前poses.size()个节点的位姿，非渲染线程调用
+    bool UpdatePoses(const std::vector<SE3> &poses) { return UpdatePoses(poses.data(), poses.size()); }
+
+    /// 节点数量
+    std::size_t Size();
+
+    /// 更新函数，渲染线程调用，上传变化的节点位置区间和新增的边
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清理函数，删除全部节点和边，显存保留
+    void Clear() override;
+
+    /// 重置位姿图在世界坐标系下的位姿，非渲染线程调用，仅更新模型矩阵
+    void ResetTwi(const SE3 &Twi) override;
+
+    /// 是否有效
+    bool IsValid() override { return xyz_buffer_.IsValid() && xyz_buffer_.Size() > 0; }
+
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override {
+        return xyz_buffer_.CapacityBytes() + odom_buffer_.CapacityBytes() + loop_buffer_.CapacityBytes();
+    }
+
+private:
+    /// 绘制索引缓冲区中的边，仅渲染线程调用
+    void DrawEdges(const DynamicBuffer &edge_buffer, const Vec3 &color);
+
+    std::vector<Vec3> positions_;    ///< 位姿图坐标系下的节点位置，mutex_保护
+    std::vector<GLuint> odom_edges_; ///< 里程计边的端点编号，每两个元素为一条边，mutex_保护
+    std::vector<GLuint> loop_edges_; ///< 回环边的端点编号，每两个元素为一条边，mutex_保护
+    std::size_t dirty_begin_;        ///< 尚未上传的节点位置区间起点，mutex_保护
+    std::size_t dirty_end_;          ///< 尚未上传的节点位置区间终点，mutex_保护
+    std::size_t uploaded_odom_;      ///< 已上传的里程计边端点数量，mutex_保护
+    std::size_t uploaded_loop_;      ///< 已上传的回环边端点数量，mutex_保护
+    bool need_reset_;                ///< 是否需要清空显存，mutex_保护
+
+    Vec3 odom_color_; ///< 里程计边颜色
+    Vec3 loop_color_; ///< 回环边颜色
+
+    DynamicBuffer xyz_buffer_;  ///< 显存节点位置，仅渲染线程访问
+    DynamicBuffer odom_buffer_; ///< 显存里程计边索引，仅渲染线程访问
+    DynamicBuffer loop_buffer_; ///< 显存回环边索引，仅渲染线程访问
+};
+
+} // namespace slam_viewer
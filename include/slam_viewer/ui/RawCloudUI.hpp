@@ -0,0 +1,181 @@
+#pragma once
+#include <type_traits>
+
+#include <pcl/point_traits.h>
+
+#include "slam_viewer/ui/CloudUI.hpp"
+
+namespace slam_viewer {
+
+/// C++类型到OpenGL数据类型的映射
+template <typename T> struct GlDataType;
+template <> struct GlDataType<float> { static constexpr GLenum value = GL_FLOAT; };
+template <> struct GlDataType<double> { static constexpr GLenum value = GL_DOUBLE; };
+template <> struct GlDataType<std::int8_t> { static constexpr GLenum value = GL_BYTE; };
+template <> struct GlDataType<std::uint8_t> { static constexpr GLenum value = GL_UNSIGNED_BYTE; };
+template <> struct GlDataType<std::int16_t> { static constexpr GLenum value = GL_SHORT; };
+template <> struct GlDataType<std::uint16_t> { static constexpr GLenum value = GL_UNSIGNED_SHORT; };
+template <> struct GlDataType<std::int32_t> { static constexpr GLenum value = GL_INT; };
+template <> struct GlDataType<std::uint32_t> { static constexpr GLenum value = GL_UNSIGNED_INT; };
+
+/// 零拷贝点云UI，直接上传cloud->points的内存，通过步长和偏移描述位置和颜色字段
+class RawCloudUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<RawCloudUI> Ptr;
+    typedef std::shared_ptr<const RawCloudUI> ConstPtr;
+
+    /// 颜色来源
+    enum class ColorSource {
+        Uniform, ///< 使用UI的统一颜色
+        Rgb,     ///< 使用点的rgb/rgba字段，按BGRA字节序读取
+        Scalar   ///< 使用点的标量字段，经ColorMap映射
+    };
+
+    /// 点类型的内存布局，由PCL字段特征得到
+    struct Layout {
+        GLsizei stride_;           ///< 相邻点之间的字节数，即sizeof(PointType)
+        std::size_t xyz_offset_;   ///< x、y、z字段的字节偏移
+        ColorSource source_;       ///< 颜色来源
+        std::size_t color_offset_; ///< 颜色字段的字节偏移
+        GLenum color_type_;        ///< 标量颜色字段的数据类型
+    };
+
+    RawCloudUI(Vec3 color = Vec3(0.5, 0.5, 0.5), float line_width = 3.0, float point_size = 1.0)
+        : UIItem(color, line_width, point_size)
+        , buffer_(GL_UNSIGNED_BYTE, 1)
+        , need_reset_(false) {}
+
+    /// 析构函数，注销在ColorMap上注册的重绘回调
+    ~RawCloudUI() override {
+        if (color_map_)
+            color_map_->RemoveListener(this);
+    }
+
+    /**
+     * @brief 由PCL字段特征得到点类型的内存布局
+     *
+     * @tparam PointType    点云的点类型，需要使用PCL注册
+     * @tparam ColorField   颜色字段，如pcl::fields::rgb、pcl::fields::intensity，为void时使用统一颜色
+     * @return Layout       输出的内存布局
+     */
+    template <typename PointType, typename ColorField = void> static Layout MakeLayout() {
+        Layout layout;
+        layout.stride_ = sizeof(PointType);
+        layout.xyz_offset_ = pcl::traits::offset<PointType, pcl::fields::x>::value;
+        layout.source_ = ColorSource::Uniform;
+        layout.color_offset_ = 0;
+        layout.color_type_ = GL_FLOAT;
+
+        if constexpr (!std::is_void<ColorField>::value) {
+            typedef typename pcl::traits::datatype<PointType, ColorField>::type FieldType;
+            layout.color_offset_ = pcl::traits::offset<PointType, ColorField>::value;
+            if constexpr (std::is_same<ColorField, pcl::fields::rgb>::value ||
+                          std::is_same<ColorField, pcl::fields::rgba>::value) {
+                layout.source_ = ColorSource::Rgb;
+                layout.color_type_ = GL_UNSIGNED_BYTE;
+            } else {
+                layout.source_ = ColorSource::Scalar;
+                layout.color_type_ = GlDataType<FieldType>::value;
+            }
+        }
+        return layout;
+    }
+
+    /**
+     * @brief 添加点云，非渲染线程调用，不复制和变换点，渲染线程直接上传cloud->points的内存
+     * @details
+     *      1. 点云在渲染线程上传完成前被持有，调用后不应再修改该点云；点云位姿作为模型矩阵在渲染时作用
+     *      2. 持有的是PointCloud::Ptr本身的副本，PCL 1.11之前的boost::shared_ptr和之后的std::shared_ptr均适用
+     * @tparam PointType    点云的点类型，需要使用PCL注册
+     * @tparam ColorField   颜色字段，为void时使用统一颜色
+     * @param cloud         输入的点云
+     * @param Twi           输入的点云在世界坐标系下的位姿
+     */
+    template <typename PointType, typename ColorField = void>
+    void AddCloud(const typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi) {
+        if (!cloud || cloud->empty())
+            return;
+
+        PendingCloud pending;
+        pending.holder_ = std::make_shared<const typename pcl::PointCloud<PointType>::Ptr>(cloud);
+        pending.data_ = cloud->points.data();
+        pending.segment_.count_ = cloud->size();
+        pending.segment_.layout_ = MakeLayout<PointType, ColorField>();
+
+        auto lock = ProducerLock();
+        pending.segment_.Tij_ = (Twi_.inverse() * Twi).matrix();
+        pending_clouds_.push_back(std::move(pending));
+        MarkUpdate();
+    }
+
+    /// 设置GPU颜色映射，标量颜色字段的点云使用，非渲染线程调用，只请求重绘，映射参数变化时同样请求重绘
+    void SetColorMap(ColorMap::Ptr color_map) {
+        if (color_map)
+            color_map->AddListener(this, [this]() { MarkRedraw(); });
+        ColorMap::Ptr old_map = color_map;
+        {
+            auto lock = ProducerLock();
+            std::swap(old_map, color_map_);
+        }
+        if (old_map && old_map != color_map)
+            old_map->RemoveListener(this);
+        MarkRedraw();
+    }
+
+    /// 更新函数，渲染线程调用，上传等待中的点云内存
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清理函数
+    void Clear() override;
+
+    /// 重置原始点云在世界坐标系下的位姿，各段的Tij不变，只替换共用的模型矩阵
+    void ResetTwi(const SE3 &Twi) override;
+
+    /// 是否有效
+    bool IsValid() override { return buffer_.IsValid() && !segments_.empty(); }
+
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override { return buffer_.CapacityBytes(); }
+
+private:
+    /// 显存中的一段点云
+    struct Segment {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        Mat4 Tij_;                ///< 点云坐标系到UI坐标系的变换
+        std::size_t offset_;      ///< 在显存中的字节偏移
+        std::size_t count_;       ///< 点数量
+        Layout layout_;           ///< 内存布局
+        Eigen::AlignedBox3f box_; ///< UI坐标系下的包围盒，用于分段的视锥体剔除
+    };
+
+    /// 等待上传的点云
+    struct PendingCloud {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        std::shared_ptr<const void> holder_; ///< 持有点云指针的副本，兼容boost和std的PointCloud::Ptr
+        const void *data_;                   ///< 点云内存
+        Segment segment_;                    ///< 点云在显存中的描述
+    };
+
+    /// 按照内存布局绑定顶点和颜色属性并绘制，仅渲染线程调用
+    void DrawSegment(const Segment &segment, const Mat4 &Twi, const ColorMap::Ptr &color_map);
+
+    /// 按照内存布局计算点云坐标系下的包围盒，仅渲染线程调用
+    static Eigen::AlignedBox3f ComputeBox(const void *data, std::size_t count, const Layout &layout);
+
+    DynamicBuffer buffer_; ///< 显存，以字节为单位，点云内存原样追加
+
+    std::vector<PendingCloud, Eigen::aligned_allocator<PendingCloud>> pending_clouds_; ///< 等待上传的点云，mutex_保护
+    bool need_reset_;                                                                 ///< 是否需要清空，mutex_保护
+    ColorMap::Ptr color_map_;                                                         ///< GPU颜色映射，mutex_保护
+
+    std::vector<Segment, Eigen::aligned_allocator<Segment>> segments_; ///< 显存中的点云，仅渲染线程访问
+};
+
+} // namespace slam_viewer
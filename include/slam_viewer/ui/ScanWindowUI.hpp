@@ -0,0 +1,100 @@
+#pragma once
+
+#include "slam_viewer/ui/CloudUI.hpp"
+
+namespace slam_viewer {
+
+/// 滑动窗口点云UI，仅保留最近N帧或最近T秒的扫描，显存为固定大小的环形缓冲区
+class ScanWindowUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<ScanWindowUI> Ptr;
+    typedef std::shared_ptr<const ScanWindowUI> ConstPtr;
+
+    ScanWindowUI(std::size_t max_scans = 10, double max_duration = 0, std::size_t max_points = 2000000,
+                 Vec3 color = Vec3(0.5, 0.5, 0.5), float line_width = 3.0, float point_size = 1.0);
+
+    /// 添加一帧扫描，非渲染线程调用，点被变换到UI自身坐标系下存储
+    template <typename PointType>
+    void AddScan(typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi,
+                 typename ColorFactory<PointType>::Ptr color_factory, double stamp = 0) {
+        if (!cloud || cloud->empty())
+            return;
+
+        SE3 Tij;
+        {
+            auto lock = ProducerLock();
+            Tij = Twi_.inverse() * Twi;
+        }
+
+        PendingScan scan;
+        scan.stamp_ = stamp;
+        TransformCloud<PointType>(cloud, Tij, color_factory, scan.xyz_, scan.color_);
+
+        auto lock = ProducerLock();
+        pending_points_ += scan.xyz_.size();
+        pending_scans_.push_back(std::move(scan));
+        TrimPending();
+        MarkUpdate();
+    }
+
+    /// 更新函数，渲染线程调用，新扫描覆盖环形缓冲区中最旧的扫描
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清理函数，显存保留，下次更新时从头写入
+    void Clear() override;
+
+    /// 重置扫描窗口在世界坐标系下的位姿，环形缓冲区不改写，只替换模型矩阵
+    void ResetTwi(const SE3 &Twi) override;
+
+    /// 窗口是否有效
+    bool IsValid() override { return xyz_buffer_.IsValid() && color_buffer_.IsValid() && used_points_ > 0; }
+
+    /// 环形缓冲区占用的显存字节数，仅渲染线程调用
+    std::size_t GpuBytes() override { return xyz_buffer_.CapacityBytes() + color_buffer_.CapacityBytes(); }
+
+private:
+    /// 环形缓冲区中的一帧扫描
+    struct Scan {
+        std::size_t offset_; ///< 起始位置
+        std::size_t size_;   ///< 点数量
+        double stamp_;       ///< 时间戳
+    };
+
+    /// 等待上传的一帧扫描
+    struct PendingScan {
+        std::vector<Vec3> xyz_;   ///< 点云位置信息
+        std::vector<Vec4> color_; ///< 点云颜色信息
+        double stamp_;            ///< 时间戳
+    };
+
+    /// 按照窗口的扫描数量、时间跨度和容量淘汰最旧的待上传扫描，持有mutex_时调用
+    void TrimPending();
+
+    /// 将扫描写入环形缓冲区，渲染线程调用
+    void WriteScan(const PendingScan &scan);
+
+    /// 将数据写入环形缓冲区[offset, offset + num)，越过尾部时分两段上传
+    void WriteRing(const PendingScan &scan, std::size_t offset, std::size_t num);
+
+    DynamicBuffer xyz_buffer_;   ///< 显存位置环形缓冲区
+    DynamicBuffer color_buffer_; ///< 显存颜色环形缓冲区
+
+    std::deque<PendingScan> pending_scans_; ///< 等待上传的扫描，mutex_保护
+    std::size_t pending_points_;            ///< 等待上传的扫描的点数之和，mutex_保护
+    bool need_reset_;                       ///< 是否需要清空窗口，mutex_保护
+
+    std::deque<Scan> scans_;  ///< 窗口内的扫描，仅渲染线程访问
+    std::size_t head_;        ///< 下一帧扫描的写入位置
+    std::size_t used_points_; ///< 窗口内的点数量
+
+    std::size_t max_scans_;  ///< 最大扫描数量，为0时不限制
+    double max_duration_;    ///< 最大时间跨度，小于等于0时不限制
+    std::size_t max_points_; ///< 环形缓冲区容量
+};
+
+} // namespace slam_viewer
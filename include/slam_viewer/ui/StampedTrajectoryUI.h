@@ -0,0 +1,133 @@
+#pragma once
+
+#include "slam_viewer/core/ColorMap.h"
+#include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/DynamicBuffer.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 带时间戳的完整SE3轨迹UI，按列存储时间戳、位置、旋转和着色标量
+ * @details
+ *      1. 时间戳严格递增，按时间查询和插值均为O(log n)，可作为相机跟踪、去畸变和绘图的统一数据源
+ *      2. 每个位姿保存速度、误差和协方差三个标量，着色通道和颜色映射只是着色器参数，切换时不需要重新上传
+ *      3. 新位姿只追加上传，修改标量时只上传被修改的区间
+ */
+class StampedTrajectoryUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<StampedTrajectoryUI> Ptr;
+    typedef std::shared_ptr<const StampedTrajectoryUI> ConstPtr;
+
+    /// 着色通道，None之外的通道与每个位姿保存的标量一一对应
+    enum class ColorChannel {
+        None,      ///< 使用固定颜色
+        Speed,     ///< 相邻位姿之间的平均速度，添加位姿时自动计算
+        Error,     ///< 位姿误差
+        Covariance ///< 位姿协方差的标量度量，如协方差矩阵的迹
+    };
+
+    static constexpr int kChannels = 3; ///< 每个位姿保存的标量数量
+
+    StampedTrajectoryUI(Vec3 color = Vec3(1.0, 0.0, 0.0), float line_width = 3.0, float point_size = 5.0);
+
+    StampedTrajectoryUI(const StampedTrajectoryUI &) = delete;
+
+    StampedTrajectoryUI &operator=(const StampedTrajectoryUI &) = delete;
+
+    ~StampedTrajectoryUI() override;
+
+    /**
+     * @brief 添加位姿，非渲染线程调用，代价为均摊O(1)
+     *
+     * @param stamp         输入的时间戳，必须大于已有的最大时间戳
+     * @param Twc           输入的世界坐标系下的位姿
+     * @param error         输入的位姿误差
+     * @param covariance    输入的位姿协方差的标量度量
+     * @return true         添加成功
+     * @return false        时间戳不是严格递增的
+     */
+    bool AddPose(double stamp, const SE3 &Twc, float error = 0.f, float covariance = 0.f);
+
+    /// 设置第id个位姿的误差或协方差标量，非渲染线程调用，编号或通道无效时返回false
+    bool SetScalar(ColorChannel channel, std::size_t id, float value);
+
+    /// 批量设置从第begin个位姿开始的误差或协方差标量，只获取一次mutex_，超出轨迹的部分被忽略
+    bool SetScalars(ColorChannel channel, std::size_t begin, const std::vector<float> &values);
+
+    /// 插值得到stamp时刻在世界坐标系下的位姿，stamp超出轨迹的时间范围时返回false
+    bool Interpolate(double stamp, SE3 &Twc);
+
+    /// 获取最新的位姿，轨迹为空时返回false
+    bool GetLatest(double &stamp, SE3 &Twc);
+
+    /// 获取时间戳在[begin, end]范围内的位姿，返回位姿数量
+    std::size_t QueryRange(double begin, double end, std::vector<double> &stamps, std::vector<SE3> &poses);
+
+    /// 位姿数量
+    std::size_t Size();
+
+    /// 设置着色通道，任意线程调用，不会触发重新上传，只请求重绘
+    void SetColorChannel(ColorChannel channel) {
+        color_channel_.store(channel);
+        MarkRedraw();
+    }
+
+    /// 设置颜色映射，为nullptr时使用固定颜色，只请求重绘，映射参数变化时同样请求重绘
+    void SetColorMap(ColorMap::Ptr color_map) {
+        if (color_map)
+            color_map->AddListener(this, [this]() { MarkRedraw(); });
+        ColorMap::Ptr old_map = std::atomic_exchange(&color_map_, color_map);
+        if (old_map && old_map != color_map)
+            old_map->RemoveListener(this);
+        MarkRedraw();
+    }
+
+    /// 更新函数，渲染线程调用，上传新位姿和被修改的标量
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清空轨迹，显存保留
+    void Clear() override;
+
+    /// 重置轨迹在世界坐标系下的位姿，非渲染线程调用，存储的位姿不变，查询结果随之变化
+    void ResetTwi(const SE3 &Twi) override;
+
+    /// 轨迹是否有效
+    bool IsValid() override { return xyz_buffer_.IsValid() && xyz_buffer_.Size() > 0; }
+
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override { return xyz_buffer_.CapacityBytes() + scalar_buffer_.CapacityBytes(); }
+
+private:
+    typedef std::vector<Eigen::Quaternionf, Eigen::aligned_allocator<Eigen::Quaternionf>> QuatVector;
+
+    /// 时间戳不小于stamp的第一个位姿，需持有mutex_
+    std::size_t LowerBound(double stamp) const;
+
+    /// 将[begin, end)标记为需要重新上传标量的区间，需持有mutex_
+    void MarkDirtyScalars(std::size_t begin, std::size_t end);
+
+    /// 第id个位姿在轨迹坐标系下的SE3，需持有mutex_
+    SE3 LocalPose(std::size_t id) const { return SE3(rotations_[id], positions_[id]); }
+
+    std::vector<double> stamps_;  ///< 时间戳，mutex_保护
+    std::vector<Vec3> positions_; ///< 轨迹坐标系下的位置，mutex_保护
+    QuatVector rotations_;        ///< 轨迹坐标系下的旋转，mutex_保护
+    std::vector<float> scalars_;  ///< 每个位姿kChannels个着色标量，mutex_保护
+    std::size_t uploaded_;        ///< 已上传的位姿数量，mutex_保护
+    std::size_t dirty_begin_;     ///< 被修改的标量区间起点，mutex_保护
+    std::size_t dirty_end_;       ///< 被修改的标量区间终点，mutex_保护
+    bool need_reset_;             ///< 是否需要清空显存，mutex_保护
+
+    std::atomic<ColorChannel> color_channel_; ///< 着色通道
+    ColorMap::Ptr color_map_;                 ///< GPU颜色映射，通过std::atomic_load/atomic_store访问
+
+    DynamicBuffer xyz_buffer_;    ///< 显存位置，仅渲染线程访问
+    DynamicBuffer scalar_buffer_; ///< 显存着色标量，每个位姿kChannels个，仅渲染线程访问
+};
+
+} // namespace slam_viewer
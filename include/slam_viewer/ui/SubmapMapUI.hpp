@@ -0,0 +1,129 @@
+#pragma once
+
+#include "slam_viewer/ui/CloudUI.hpp"
+
+namespace slam_viewer {
+
+/**
+ * @brief 子图地图UI，每个子图的点在子图坐标系下只上传一次，渲染时以子图锚点位姿作为模型矩阵
+ * @details
+ *      1. 回环移动子图锚点时只修改锚点矩阵，批量更新的代价为O(子图数量)，与点数无关
+ *      2. 点云通过BatchQueue无锁发布，渲染线程只追加上传新点
+ *      3. 每个子图维护子图坐标系下的包围盒，渲染时跳过视野外的子图
+ */
+class SubmapMapUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<SubmapMapUI> Ptr;
+    typedef std::shared_ptr<const SubmapMapUI> ConstPtr;
+
+    SubmapMapUI(Vec3 color = Vec3(0.5, 0.5, 0.5), float line_width = 3.0, float point_size = 1.0);
+
+    /**
+     * @brief 添加子图，非渲染线程调用
+     *
+     * @tparam PointType    点云的点类型
+     * @param cloud         输入的子图坐标系下的点云
+     * @param Twa           输入的子图锚点在世界坐标系下的位姿
+     * @param color_factory 输入的颜色工厂
+     * @return std::size_t  输出的子图编号
+     */
+    template <typename PointType>
+    std::size_t AddSubmap(typename pcl::PointCloud<PointType>::Ptr &cloud, const SE3 &Twa,
+                          typename ColorFactory<PointType>::Ptr color_factory) {
+        std::size_t id = 0;
+        {
+            auto lock = ProducerLock();
+            id = anchors_.size();
+            anchors_.push_back((Twi_.inverse() * Twa).matrix());
+        }
+
+        AppendSubmap<PointType>(id, cloud, color_factory);
+        return id;
+    }
+
+    /**
+     * @brief 向已有子图追加点，非渲染线程调用
+     *
+     * @tparam PointType    点云的点类型
+     * @param id            输入的子图编号
+     * @param cloud         输入的子图坐标系下的点云
+     * @param color_factory 输入的颜色工厂
+     * @return true         追加成功
+     * @return false        子图编号无效
+     */
+    template <typename PointType>
+    bool AppendSubmap(std::size_t id, typename pcl::PointCloud<PointType>::Ptr &cloud,
+                      typename ColorFactory<PointType>::Ptr color_factory) {
+        if (id >= Size())
+            return false;
+        if (!cloud || cloud->empty())
+            return true;
+
+        PendingPoints pending;
+        pending.id_ = id;
+        TransformCloud<PointType>(cloud, SE3(), color_factory, pending.xyz_, pending.color_);
+        pending_.Push(std::move(pending));
+        MarkUpdate();
+        return true;
+    }
+
+    /// 设置子图锚点在世界坐标系下的位姿，非渲染线程调用，编号无效时返回false，渲染线程随后更新包围盒
+    bool SetAnchor(std::size_t id, const SE3 &Twa);
+
+    /// 批量设置前anchors.size()个子图锚点的位姿，只获取一次mutex_，代价为O(子图数量)
+    bool SetAnchors(const std::vector<SE3> &anchors);
+
+    /// 子图数量
+    std::size_t Size();
+
+    /// 更新函数，渲染线程调用，追加上传新点并更新包围盒
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清理函数，删除全部子图，不应与AddSubmap并发调用
+    void Clear() override;
+
+    /// 重置地图在世界坐标系下的位姿，非渲染线程调用，仅更新模型矩阵
+    void ResetTwi(const SE3 &Twi) override;
+
+    /// 是否有效
+    bool IsValid() override { return !submaps_.empty(); }
+
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override {
+        std::size_t bytes = 0;
+        for (const auto &submap : submaps_)
+            bytes += submap->xyz_buffer_.CapacityBytes() + submap->color_buffer_.CapacityBytes();
+        return bytes;
+    }
+
+private:
+    /// 生产者发布的子图点
+    struct PendingPoints {
+        bool reset_ = false;      ///< 是否为清空子图的标记
+        std::size_t id_ = 0;      ///< 子图编号
+        std::vector<Vec3> xyz_;   ///< 子图坐标系下的点
+        std::vector<Vec4> color_; ///< 点的颜色
+    };
+
+    /// 子图的显存
+    struct Submap {
+        Submap()
+            : xyz_buffer_(GL_FLOAT, 3)
+            , color_buffer_(GL_FLOAT, 4) {}
+
+        Eigen::AlignedBox3f box_;    ///< 子图坐标系下的包围盒
+        DynamicBuffer xyz_buffer_;   ///< 显存位置信息
+        DynamicBuffer color_buffer_; ///< 显存颜色信息
+    };
+
+    std::vector<Mat4, Eigen::aligned_allocator<Mat4>> anchors_; ///< 地图坐标系下的子图锚点位姿，mutex_保护
+    BatchQueue<PendingPoints> pending_;                         ///< 等待渲染线程上传的子图点
+    std::vector<std::unique_ptr<Submap>> submaps_;              ///< 子图的显存，仅渲染线程访问
+};
+
+} // namespace slam_viewer
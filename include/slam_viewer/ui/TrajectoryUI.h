@@ -1,9 +1,16 @@
 #pragma once
 
 #include "slam_viewer/core/Common.h"
+#include "slam_viewer/core/DynamicBuffer.h"
 
 namespace slam_viewer{
 
+/**
+ * @brief 轨迹UI，新轨迹点只追加上传，达到最大容量后显存作为环形缓冲区覆盖最早的轨迹点
+ * @details
+ *      轨迹点到达时增量构建多个分辨率的简化折线，轨迹按序号划分为分块，渲染时每个分块根据相机到分块包围盒的距离
+ *      选择屏幕误差不超过阈值的最粗层级，相机附近的分块绘制全部轨迹点，远处的分块绘制简化折线
+ */
 class TrajectoryUI : public UIItem {
     friend class UIItem;
 
@@ -11,8 +18,14 @@ public:
     typedef std::shared_ptr<TrajectoryUI> Ptr;
     typedef std::shared_ptr<const TrajectoryUI> ConstPtr;
 
+    static constexpr int kLevels = 8;                ///< 简化折线的层级数
+    static constexpr float kBaseTolerance = 0.01f;   ///< 最细层级的简化容差（米）
+    static constexpr float kToleranceFactor = 4.0f;  ///< 相邻层级之间的容差倍数
+    static constexpr std::size_t kMinCompact = 1024; ///< 简化折线被淘汰的顶点达到该数量后才压缩
+    static constexpr std::size_t kChunkPoints = 512; ///< 每个分块包含的轨迹点数量
+
     TrajectoryUI(Vec3 color = Vec3(1.0, 0.0, 0.0), float line_width = 3.0, float point_size = 5.0,
-                 std::size_t max_capicity = 1e8);
+                 std::size_t max_capicity = 1e8, float max_pixel_error = 1.0f);
 
     TrajectoryUI(const TrajectoryUI &) = delete;
 
@@ -21,24 +34,106 @@ public:
     /// 渲染函数
     void Render() override;
 
-    /// 向轨迹中添加点，非渲染线程调用
+    /// 向轨迹中添加点，非渲染线程调用，点通过BatchQueue无锁发布
     void AddPt(const Vec3 &pt);
 
     /// 相轨迹中添加位姿，非渲染线程调用
     void AddPt(const SE3 &Twi) { AddPt(Twi.translation()); }
 
-    /// 更新函数
+    /// 更新函数，渲染线程调用
     void Update() override;
 
     /// 清空选项
     void Clear() override;
 
-    /// 重置Twi位姿，非渲染线程调用
+    /// 重置Twi位姿，非渲染线程调用，仅更新模型矩阵
     void ResetTwi(const SE3 &Twi) override;
 
+    /// 轨迹是否有效
+    bool IsValid() override { return pose_buffer_.IsValid() && !poses_.empty(); }
+
+    /// 显存占用的字节数，仅渲染线程调用
+    std::size_t GpuBytes() override {
+        std::size_t bytes = pose_buffer_.CapacityBytes();
+        for (const auto &level : levels_)
+            bytes += level.buffer_.CapacityBytes();
+        return bytes;
+    }
+
+    /// 设置简化折线允许的最大屏幕误差（像素），小于等于0时总是绘制全部轨迹点，非渲染线程调用，只请求重绘
+    void SetMaxPixelError(float max_pixel_error) {
+        max_pixel_error_.store(max_pixel_error);
+        MarkRedraw();
+    }
+
 private:
-    std::size_t max_capicity_; ///< 轨迹最大容量
-    std::vector<Vec3> poses_;  ///< 轨迹点集
+    /// 一个分辨率的简化折线，相邻保留顶点的距离不小于容差，被跳过的点到前一个保留顶点的距离小于容差
+    struct Level {
+        explicit Level(float tolerance)
+            : tolerance_(tolerance)
+            , start_(0)
+            , uploaded_(0)
+            , buffer_(GL_FLOAT, 3) {}
+
+        float tolerance_;                ///< 简化容差
+        std::vector<Vec3> xyz_;          ///< 保留的顶点
+        std::vector<std::uint64_t> seq_; ///< 保留顶点对应的轨迹点序号
+        std::size_t start_;              ///< 第一个未被环形缓冲区淘汰的顶点
+        std::size_t uploaded_;           ///< 已上传的顶点数量
+        DynamicBuffer buffer_;           ///< 显存顶点，与xyz_一一对应
+    };
+
+    /// 按序号连续划分的轨迹分块，用于逐分块选择层级
+    struct Chunk {
+        std::uint64_t begin_seq_; ///< 分块第一个轨迹点的序号
+        Eigen::AlignedBox3f box_; ///< 分块内轨迹点的包围盒，被淘汰的轨迹点不收缩包围盒
+    };
+
+    /// 连续若干个使用相同层级的分块，合并为一次绘制
+    struct DrawRun {
+        const Level *level_;  ///< 使用的简化折线，为nullptr时绘制全部轨迹点
+        std::uint64_t begin_; ///< level_非空时为简化折线的起始顶点，否则为起始轨迹点序号
+        std::uint64_t end_;   ///< level_非空时为简化折线的结束顶点，否则为结束轨迹点序号
+    };
+
+    /// 生产者发布的轨迹点
+    struct PendingPt {
+        bool reset_; ///< 是否为清空轨迹的标记
+        Vec3 pt_;    ///< 轨迹坐标系下的轨迹点
+    };
+
+    /// 写入一个轨迹点，写满后覆盖最早的轨迹点，返回写入位置，渲染线程调用
+    std::size_t WritePt(const Vec3 &pt);
+
+    /// 将新轨迹点加入各层简化折线，并淘汰已被环形缓冲区覆盖的顶点，渲染线程调用
+    void SimplifyPt(const Vec3 &pt);
+
+    /// 清空轨迹点和简化折线，显存保留，渲染线程调用
+    void ResetPoses();
+
+    /// 根据当前的投影矩阵和模型视图矩阵为每个分块选择层级，并合并为绘制区间，需在模型矩阵作用之后调用
+    void BuildRuns();
+
+    /// 选择分块的层级，返回nullptr时绘制全部轨迹点
+    const Level *SelectLevel(const Chunk &chunk, const Vec3 &camera_position, float pixel_scale,
+                             float max_pixel_error) const;
+
+    /// 绘制一个区间的折线和点，返回区间首尾的轨迹点，区间为空时返回false
+    bool DrawRunBuffer(const DrawRun &run, Vec3 &front, Vec3 &back);
+
+    std::size_t max_capicity_;      ///< 轨迹最大容量
+    BatchQueue<PendingPt> pending_; ///< 等待渲染线程处理的轨迹点
+    std::vector<Vec3> poses_;       ///< 轨迹坐标系下的轨迹点集，写满后作为环形缓冲区，仅渲染线程访问
+    std::size_t head_;              ///< 最早的轨迹点在poses_中的位置，写满之前为0，仅渲染线程访问
+    DynamicBuffer pose_buffer_;     ///< 显存轨迹点，与poses_一一对应
+
+    std::vector<Level> levels_;          ///< 从细到粗的简化折线，仅渲染线程访问
+    std::uint64_t total_;                ///< 清空后写入的轨迹点数量，仅渲染线程访问
+    Eigen::AlignedBox3f box_;            ///< 轨迹点的包围盒，仅渲染线程访问
+    std::deque<Chunk> chunks_;           ///< 未被完全淘汰的分块，按序号排列，仅渲染线程访问
+    std::vector<DrawRun> runs_;          ///< 本帧的绘制区间，仅渲染线程访问
+    std::vector<Vec3> joins_;            ///< 相邻绘制区间之间的连接线段端点，仅渲染线程访问
+    std::atomic<float> max_pixel_error_; ///< 简化折线允许的最大屏幕误差（像素）
 };
 
 }
\ No newline at end of file
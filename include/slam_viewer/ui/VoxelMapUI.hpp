@@ -0,0 +1,145 @@
+#pragma once
+#include <bitset>
+#include <shared_mutex>
+
+#include <tbb/concurrent_hash_map.h>
+#include <tbb/concurrent_vector.h>
+
+#include "slam_viewer/ui/CloudUI.hpp"
+
+namespace slam_viewer {
+
+/// 体素哈希地图UI，每个体素仅保留一个代表点，地图规模随探索体积增长而非随时间增长
+class VoxelMapUI : public UIItem {
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef std::shared_ptr<VoxelMapUI> Ptr;
+    typedef std::shared_ptr<const VoxelMapUI> ConstPtr;
+
+    static constexpr int kBlockDim = 8;                                    ///< 体素块每个方向上的体素数量
+    static constexpr int kBlockVoxels = kBlockDim * kBlockDim * kBlockDim; ///< 体素块内的体素数量
+    static constexpr std::size_t kMinSlotPoints = 8;                       ///< 体素块第一个显存槽位的点数量
+
+    /// 体素块的索引，由量化后的坐标构成
+    struct BlockKey {
+        int x_, y_, z_;
+
+        bool operator==(const BlockKey &other) const { return x_ == other.x_ && y_ == other.y_ && z_ == other.z_; }
+    };
+
+    /// 体素块索引的哈希和比较函数，供tbb::concurrent_hash_map和std::unordered_map使用
+    struct BlockKeyHashCompare {
+        static std::size_t hash(const BlockKey &key) {
+            return (std::size_t(key.x_) * 73856093) ^ (std::size_t(key.y_) * 19349663) ^
+                   (std::size_t(key.z_) * 83492791);
+        }
+
+        static bool equal(const BlockKey &a, const BlockKey &b) { return a == b; }
+
+        std::size_t operator()(const BlockKey &key) const { return hash(key); }
+    };
+
+    /// 体素块，体素块内的点按插入顺序追加，通过accessor独占访问
+    struct Block {
+        std::bitset<kBlockVoxels> occupied_; ///< 体素是否已有代表点
+        std::vector<Vec3> xyz_;              ///< 代表点的位置
+        std::vector<Vec4> color_;            ///< 代表点的颜色
+        std::size_t staged_ = 0;             ///< 已拷贝到上传暂存区的点数量
+        bool dirty_ = false;                 ///< 是否在脏块列表中
+    };
+
+    typedef tbb::concurrent_hash_map<BlockKey, Block, BlockKeyHashCompare> BlockMap;
+
+    VoxelMapUI(float voxel_size = 0.2, Vec3 color = Vec3(0.5, 0.5, 0.5), float line_width = 3.0,
+               float point_size = 1.0);
+
+    /// 插入一帧扫描，非渲染线程调用，点被变换到地图自身坐标系下并进行体素去重
+    template <typename PointType>
+    void AddScan(typename pcl::PointCloud<PointType>::Ptr &cloud, SE3 Twi,
+                 typename ColorFactory<PointType>::Ptr color_factory) {
+        if (!cloud || cloud->empty())
+            return;
+
+        SE3 Tij;
+        {
+            auto lock = ProducerLock();
+            Tij = Twi_.inverse() * Twi;
+        }
+
+        std::vector<Vec3> cloud_xyz;
+        std::vector<Vec4> cloud_color;
+        TransformCloud<PointType>(cloud, Tij, color_factory, cloud_xyz, cloud_color);
+        InsertPoints(cloud_xyz, cloud_color);
+    }
+
+    /// 更新函数，渲染线程调用，仅上传脏体素块中新增的点
+    void Update() override;
+
+    /// 渲染函数
+    void Render() override;
+
+    /// 清理函数
+    void Clear() override;
+
+    /// 重置地图在世界坐标系下的位姿，体素划分不变，之后插入的点按新的位姿体素化
+    void ResetTwi(const SE3 &Twi) override;
+
+    /// 地图是否有效
+    bool IsValid() override { return xyz_buffer_.IsValid() && color_buffer_.IsValid() && !slot_firsts_.empty(); }
+
+    /// 槽位缓冲区占用的显存字节数，仅渲染线程调用
+    std::size_t GpuBytes() override { return xyz_buffer_.CapacityBytes() + color_buffer_.CapacityBytes(); }
+
+    /// 获取地图中的体素数量
+    std::size_t VoxelNum() const { return voxel_num_.load(); }
+
+private:
+    typedef std::unordered_map<BlockKey, std::vector<std::size_t>, BlockKeyHashCompare> BlockSlotMap;
+
+    /// 并行插入地图坐标系下的点，每个体素保留第一个到达的点
+    void InsertPoints(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color);
+
+    /// 暂存区中一个体素块的新增点
+    struct StagedBlock {
+        BlockKey key_;       ///< 体素块索引
+        std::size_t begin_;  ///< 新增点在体素块内的起始序号
+        std::size_t offset_; ///< 新增点在暂存区中的起始位置
+        std::size_t num_;    ///< 新增点的数量
+    };
+
+    /// 体素块第slot_id个显存槽位的容量，从kMinSlotPoints开始逐个翻倍，不超过体素块的体素数量
+    static std::size_t SlotCapacity(std::size_t slot_id) {
+        return std::min(kMinSlotPoints << std::min<std::size_t>(slot_id, 16), std::size_t(kBlockVoxels));
+    }
+
+    /// 将体素块的新增点上传到其显存槽位中，必要时分配新的槽位
+    void UploadStaged(const StagedBlock &staged);
+
+    /// 在槽位缓冲区末尾为体素块分配一个显存槽位，返回槽位编号
+    std::size_t AllocateSlot(const BlockKey &key, std::size_t capacity);
+
+    float voxel_size_;                   ///< 体素大小
+    BlockMap blocks_;                    ///< 体素块哈希表
+    std::shared_mutex blocks_mutex_;     ///< 插入和拷贝共享持有，Clear独占持有，保证清空时没有并发访问
+    std::vector<BlockKey> dirty_blocks_; ///< 存在新增点的体素块，mutex_保护
+    std::atomic<std::size_t> voxel_num_; ///< 体素数量
+    bool need_reset_;                    ///< 是否需要重置显存槽位，mutex_保护
+
+    std::vector<BlockKey> update_blocks_;    ///< 本次更新处理的脏块，仅渲染线程访问
+    std::vector<StagedBlock> staged_blocks_; ///< 本次更新拷贝出的体素块，仅渲染线程访问
+    std::vector<Vec3> staged_xyz_;           ///< 上传暂存区的位置，仅渲染线程访问
+    std::vector<Vec4> staged_color_;         ///< 上传暂存区的颜色，仅渲染线程访问
+
+    BlockSlotMap block_slots_;                    ///< 各体素块占用的显存槽位，仅渲染线程访问
+    std::size_t slot_end_;                        ///< 已分配槽位的末尾顶点，仅渲染线程访问
+    DynamicBuffer xyz_buffer_;                    ///< 显存位置信息，按槽位存放
+    DynamicBuffer color_buffer_;                  ///< 显存颜色信息，按槽位存放
+    std::vector<GLint> slot_firsts_;              ///< 各槽位的起始顶点，仅渲染线程访问
+    std::vector<GLsizei> slot_counts_;            ///< 各槽位的有效点数量，仅渲染线程访问
+    std::vector<Eigen::AlignedBox3f> slot_boxes_; ///< 各槽位所属体素块的包围盒，仅渲染线程访问
+    std::vector<GLint> visible_firsts_;           ///< 视野内槽位的起始顶点，仅渲染线程访问
+    std::vector<GLsizei> visible_counts_;         ///< 视野内槽位的有效点数量，仅渲染线程访问
+};
+
+} // namespace slam_viewer
@@ -0,0 +1,246 @@
+#include "slam_viewer/core/AabbTree.h"
+
+namespace slam_viewer {
+
+/// 包围盒的表面积
+float AabbTree::SurfaceArea(const Eigen::AlignedBox3f &box) {
+    Vec3 size = box.sizes();
+    return 2.0f * (size.x() * size.y() + size.y() * size.z() + size.z() * size.x());
+}
+
+/// 按相对余量和最小余量放大包围盒
+Eigen::AlignedBox3f AabbTree::Fatten(const Eigen::AlignedBox3f &box) {
+    Vec3 margin = (box.sizes() * kMarginRatio).cwiseMax(kMinMargin);
+    return Eigen::AlignedBox3f(box.min() - margin, box.max() + margin);
+}
+
+/// 分配节点，优先复用空闲节点
+std::int32_t AabbTree::AllocateNode() {
+    std::int32_t id;
+    if (free_list_ != kNull) {
+        id = free_list_;
+        free_list_ = nodes_[id].parent_;
+    } else {
+        id = nodes_.size();
+        nodes_.emplace_back();
+    }
+
+    nodes_[id] = Node();
+    return id;
+}
+
+/// 释放节点，放入空闲链表
+void AabbTree::FreeNode(std::int32_t id) {
+    nodes_[id].parent_ = free_list_;
+    nodes_[id].height_ = -1;
+    free_list_ = id;
+}
+
+/**
+ * @brief 插入叶子节点
+ *
+ * @param box           输入的包围盒，以放大后的形式保存
+ * @param user          输入的用户数据
+ * @return std::int32_t 输出的节点编号，节点删除前保持不变
+ */
+std::int32_t AabbTree::Insert(const Eigen::AlignedBox3f &box, std::uint32_t user) {
+    std::int32_t leaf = AllocateNode();
+    nodes_[leaf].box_ = Fatten(box);
+    nodes_[leaf].user_ = user;
+    InsertLeaf(leaf);
+    ++leaf_num_;
+    return leaf;
+}
+
+/// 删除叶子节点
+void AabbTree::Remove(std::int32_t proxy) {
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    --leaf_num_;
+}
+
+/**
+ * @brief 移动叶子节点
+ * @details
+ *      新包围盒仍在放大后的包围盒内时不修改树；放大后的包围盒远大于新包围盒时（如点云被清空后重新累积）
+ *      同样重新插入，避免过于保守的包围盒降低剔除效率
+ * @param proxy     输入的叶子节点编号
+ * @param box       输入的新包围盒
+ * @return true     重新插入了叶子节点
+ * @return false    包围盒在余量范围内，树未修改
+ */
+bool AabbTree::Move(std::int32_t proxy, const Eigen::AlignedBox3f &box) {
+    Eigen::AlignedBox3f fat = Fatten(box);
+    const Eigen::AlignedBox3f &old = nodes_[proxy].box_;
+    if (old.contains(box) && SurfaceArea(old) <= 4.0f * SurfaceArea(fat))
+        return false;
+
+    RemoveLeaf(proxy);
+    nodes_[proxy].box_ = fat;
+    InsertLeaf(proxy);
+    return true;
+}
+
+/**
+ * @brief 将叶子节点插入树中
+ * @details
+ *      1. 从根节点向下，比较在当前节点处新建父节点的代价和下降到两个子节点的代价，选择代价最小的兄弟节点
+ *      2. 代价为新增父节点的表面积加上祖先节点因包围盒扩大而增加的表面积
+ *      3. 新建父节点后向上修正包围盒和高度并平衡
+ * @param leaf 输入的叶子节点
+ */
+void AabbTree::InsertLeaf(std::int32_t leaf) {
+    if (root_ == kNull) {
+        root_ = leaf;
+        nodes_[root_].parent_ = kNull;
+        return;
+    }
+
+    const Eigen::AlignedBox3f box = nodes_[leaf].box_;
+    std::int32_t index = root_;
+    while (!nodes_[index].IsLeaf()) {
+        const Node &node = nodes_[index];
+        float area = SurfaceArea(node.box_);
+        float combined_area = SurfaceArea(node.box_.merged(box));
+        float cost = 2.0f * combined_area;
+        float inheritance = 2.0f * (combined_area - area);
+
+        auto child_cost = [&](std::int32_t child) {
+            const Node &child_node = nodes_[child];
+            float merged_area = SurfaceArea(child_node.box_.merged(box));
+            if (child_node.IsLeaf())
+                return merged_area + inheritance;
+            return merged_area - SurfaceArea(child_node.box_) + inheritance;
+        };
+
+        float left_cost = child_cost(node.left_);
+        float right_cost = child_cost(node.right_);
+        if (cost < left_cost && cost < right_cost)
+            break;
+        index = left_cost < right_cost ? node.left_ : node.right_;
+    }
+
+    std::int32_t sibling = index;
+    std::int32_t parent = AllocateNode();
+    std::int32_t old_parent = nodes_[sibling].parent_;
+    nodes_[parent].parent_ = old_parent;
+    nodes_[parent].box_ = nodes_[sibling].box_.merged(box);
+    nodes_[parent].height_ = nodes_[sibling].height_ + 1;
+    nodes_[parent].left_ = sibling;
+    nodes_[parent].right_ = leaf;
+    nodes_[sibling].parent_ = parent;
+    nodes_[leaf].parent_ = parent;
+
+    if (old_parent == kNull)
+        root_ = parent;
+    else if (nodes_[old_parent].left_ == sibling)
+        nodes_[old_parent].left_ = parent;
+    else
+        nodes_[old_parent].right_ = parent;
+
+    Refit(parent);
+}
+
+/**
+ * @brief 将叶子节点从树中摘除，兄弟节点替代父节点的位置，父节点被释放
+ *
+ * @param leaf 输入的叶子节点
+ */
+void AabbTree::RemoveLeaf(std::int32_t leaf) {
+    if (leaf == root_) {
+        root_ = kNull;
+        return;
+    }
+
+    std::int32_t parent = nodes_[leaf].parent_;
+    std::int32_t grand_parent = nodes_[parent].parent_;
+    std::int32_t sibling = nodes_[parent].left_ == leaf ? nodes_[parent].right_ : nodes_[parent].left_;
+
+    nodes_[sibling].parent_ = grand_parent;
+    FreeNode(parent);
+    if (grand_parent == kNull) {
+        root_ = sibling;
+        return;
+    }
+
+    if (nodes_[grand_parent].left_ == parent)
+        nodes_[grand_parent].left_ = sibling;
+    else
+        nodes_[grand_parent].right_ = sibling;
+    Refit(grand_parent);
+}
+
+/// 从节点开始向上平衡，并由子节点重新计算高度和包围盒
+void AabbTree::Refit(std::int32_t id) {
+    while (id != kNull) {
+        id = Balance(id);
+
+        Node &node = nodes_[id];
+        const Node &left = nodes_[node.left_];
+        const Node &right = nodes_[node.right_];
+        node.height_ = 1 + std::max(left.height_, right.height_);
+        node.box_ = left.box_.merged(right.box_);
+        id = node.parent_;
+    }
+}
+
+/**
+ * @brief 节点A的两个子树高度差超过1时，将较高的子节点旋转到A的位置
+ * @details
+ *      较高子节点的两个子节点中，较高的一个保留在原位，较低的一个交给A，旋转后重新计算A和新根节点的包围盒和高度
+ * @param id            输入的节点A
+ * @return std::int32_t 输出的旋转后该位置的子树根节点
+ */
+std::int32_t AabbTree::Balance(std::int32_t id) {
+    Node &a = nodes_[id];
+    if (a.IsLeaf() || a.height_ < 2)
+        return id;
+
+    std::int32_t ib = a.left_, ic = a.right_;
+    Node &b = nodes_[ib];
+    Node &c = nodes_[ic];
+    int balance = c.height_ - b.height_;
+    if (balance >= -1 && balance <= 1)
+        return id;
+
+    /// 将子节点up旋转到A的位置，keep为A保留的另一子节点，is_right表示up原来是A的右子节点
+    auto rotate = [&](std::int32_t iup, Node &up, Node &keep, bool is_right) {
+        std::int32_t ichild1 = up.left_, ichild2 = up.right_;
+        Node &child1 = nodes_[ichild1];
+        Node &child2 = nodes_[ichild2];
+
+        up.left_ = id;
+        up.parent_ = a.parent_;
+        a.parent_ = iup;
+        if (up.parent_ == kNull)
+            root_ = iup;
+        else if (nodes_[up.parent_].left_ == id)
+            nodes_[up.parent_].left_ = iup;
+        else
+            nodes_[up.parent_].right_ = iup;
+
+        std::int32_t ihigh = child1.height_ > child2.height_ ? ichild1 : ichild2;
+        std::int32_t ilow = ihigh == ichild1 ? ichild2 : ichild1;
+        Node &high = nodes_[ihigh];
+        Node &low = nodes_[ilow];
+
+        up.right_ = ihigh;
+        if (is_right)
+            a.right_ = ilow;
+        else
+            a.left_ = ilow;
+        low.parent_ = id;
+
+        a.box_ = keep.box_.merged(low.box_);
+        a.height_ = 1 + std::max(keep.height_, low.height_);
+        up.box_ = a.box_.merged(high.box_);
+        up.height_ = 1 + std::max(a.height_, high.height_);
+        return iup;
+    };
+
+    if (balance > 1)
+        return rotate(ic, c, b, true);
+    return rotate(ib, b, c, false);
+}
+
+} // namespace slam_viewer
@@ -24,16 +24,8 @@ ArrowUI::ArrowUI(SE3 Twi, float arrow_length, Vec3 color, HeadType head_type, fl
     , head_fixed_length_(std::move(head_fixed_length)) {
 
     tan15_ = std::tan(15 * M_PI / 180);
-    Vec3 start_point = Twi_ * Vec3(0, 0, 0);
-    Vec3 end_point = Twi_ * Vec3(arrow_length, 0, 0);
-
-    float head_length = ComputeHeadLength(head_fixed_length_);
-    float y = tan15_ * head_length;
-    Vec3 up_point = Twi_ * Vec3(arrow_length - head_length, y, 0);
-    Vec3 down_point = Twi_ * Vec3(arrow_length - head_length, -y, 0);
-
-    points_ = {start_point, end_point, up_point, end_point, down_point, end_point};
-    need_update_.store(true);
+    points_.Publish(ComputePoints(Twi_, arrow_length_));
+    MarkUpdate();
 }
 
 /**
@@ -62,38 +54,55 @@ float ArrowUI::ComputeHeadLength(float head_length) {
 }
 
 /**
- * @brief 当箭头需要更新时，更新箭头数据，need_update_置回
+ * @brief 计算世界坐标系下箭头的6个点，内部使用api
+ *
+ * @param Twi                   输入的箭头在世界坐标系下的位姿
+ * @param arrow_length          输入的箭头长度
+ * @return std::vector<Vec3>    输出的箭身和两侧箭头的线段端点
+ */
+std::vector<Vec3> ArrowUI::ComputePoints(const SE3 &Twi, float arrow_length) {
+    Vec3 start_point = Twi * Vec3(0, 0, 0);
+    Vec3 end_point = Twi * Vec3(arrow_length, 0, 0);
+
+    float head_length = ComputeHeadLength(head_fixed_length_);
+    float y = tan15_ * head_length;
+    Vec3 up_point = Twi * Vec3(arrow_length - head_length, y, 0);
+    Vec3 down_point = Twi * Vec3(arrow_length - head_length, -y, 0);
+
+    return {start_point, end_point, up_point, end_point, down_point, end_point};
+}
+
+/**
+ * @brief 当箭头有新发布的点时，上传到显存，渲染线程调用，不获取mutex_
  *
  */
 void ArrowUI::Update() {
-    if (need_update_.load()) {
-        need_update_.store(false);
+    if (!points_.Fetch())
+        return;
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, points_);
-    }
+    const auto &points = points_.Front();
+    if (points.empty())
+        vbo_.Free();
+    else
+        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, points);
 }
 
 /**
- * @brief 重置Twi，箭头在世界坐标系下的位姿，主线程使用，线程安全，不允许多线程同时调用
+ * @brief 重置Twi，箭头在世界坐标系下的位姿，主线程使用，线程安全
  *
  * @param Twi 输入的新的Twi
  */
 void ArrowUI::ResetTwi(const SE3 &Twi) {
-    SE3 Tiw_ = Twi_.inverse();
-
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (int i = 0; i < points_.size(); i++)
-            points_[i] = Twi * Tiw_ * points_[i];
+        auto lock = ProducerLock();
+        Twi_ = Twi;
     }
-
-    Twi_ = Twi;
-    need_update_.store(true);
+    points_.Publish(ComputePoints(Twi, arrow_length_));
+    MarkUpdate();
 }
 
 /**
- * @brief 渲染箭头函数，仅渲染线程使用
+ * @brief 渲染箭头函数，仅渲染线程使用，不获取mutex_
  *
  */
 void ArrowUI::Render() {
@@ -103,6 +112,7 @@ void ArrowUI::Render() {
     glColor3f(color_[0], color_[1], color_[2]);
     glLineWidth(line_width_);
     pangolin::RenderVbo(vbo_, GL_LINES);
+    CountDraw(GL_LINES, vbo_.num_elements);
     glLineWidth(1.0);
 }
 
@@ -113,20 +123,14 @@ void ArrowUI::Render() {
  */
 void ArrowUI::ResetArrowLength(float arrow_length) {
     arrow_length_ = std::move(arrow_length);
-    Vec3 start_point = Twi_ * Vec3(0, 0, 0);
-    Vec3 end_point = Twi_ * Vec3(arrow_length, 0, 0);
-
-    float head_length = ComputeHeadLength(head_fixed_length_);
-    float y = tan15_ * head_length;
-    Vec3 up_point = Twi_ * Vec3(arrow_length - head_length, y, 0);
-    Vec3 down_point = Twi_ * Vec3(arrow_length - head_length, -y, 0);
 
+    SE3 Twi;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        points_ = {start_point, end_point, up_point, end_point, down_point, end_point};
+        auto lock = ProducerLock();
+        Twi = Twi_;
     }
-
-    need_update_.store(true);
+    points_.Publish(ComputePoints(Twi, arrow_length_));
+    MarkUpdate();
 }
 
 }
\ No newline at end of file
@@ -24,9 +24,11 @@ BoxUI::BoxUI(SE3 Twi, float x_length, float y_length, float z_length, Vec3 color
     Vec3 p7(-x_length / 2, y_length / 2, -z_length / 2);
     origin_points_ = {p0, p1, p1, p2, p2, p3, p3, p0, p4, p5, p5, p6, p6, p7, p7, p4, p0, p4, p1, p5, p2, p6, p3, p7};
 
-    points_.resize(origin_points_.size());
+    std::vector<Vec3> points(origin_points_.size());
     for (int i = 0; i < origin_points_.size(); ++i)
-        points_[i] = Twi_ * origin_points_[i];
+        points[i] = Twi_ * origin_points_[i];
+    points_.Publish(std::move(points));
+    MarkUpdate();
 }
 
 /// 渲染函数
@@ -37,40 +39,40 @@ void BoxUI::Render() {
     glColor3f(color_[0], color_[1], color_[2]);
     glLineWidth(line_width_);
     pangolin::RenderVbo(vbo_, GL_LINES);
+    CountDraw(GL_LINES, vbo_.num_elements);
     glLineWidth(1.0);
 }
 
 /// 清理函数
 void BoxUI::Clear() {
     UIItem::Clear();
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        points_.clear();
-    }
+    points_.Publish({});
+    MarkUpdate();
     origin_points_.clear();
 }
 
-/// ui元素的更新函数
+/// ui元素的更新函数，渲染线程调用，上传最近一次发布的点，不获取mutex_
 void BoxUI::Update() {
-    if (need_update_.load()) {
-        need_update_.store(false);
+    if (!points_.Fetch())
+        return;
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, points_);
-    }
+    const auto &points = points_.Front();
+    if (points.empty())
+        vbo_.Free();
+    else
+        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, points);
 }
 
-/// 重置item的世界坐标
+/// 重置item的世界坐标，点在锁外计算后发布
 void BoxUI::ResetTwi(const SE3 &Twi) {
-    SE3 Tiw_ = Twi_.inverse();
+    std::vector<Vec3> points(origin_points_.size());
+    for (int i = 0; i < origin_points_.size(); ++i)
+        points[i] = Twi * origin_points_[i];
+    points_.Publish(std::move(points));
+    MarkUpdate();
 
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (int i = 0; i < origin_points_.size(); ++i)
-            points_[i] = Twi_ * origin_points_[i];
-    }
+    auto lock = ProducerLock();
     Twi_ = Twi;
-    need_update_.store(true);
 }
 
 }
\ No newline at end of file
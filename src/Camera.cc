@@ -71,10 +71,13 @@ void Camera::SetFollow(UIItem::Ptr follow_item) {
     if (!follow_item)
         throw std::runtime_error("follow item is nullptr");
 
-    std::lock_guard<std::mutex> lock(render_pose_mutex_);
-    camera_state_ = CameraState::FollowCamera;
-    follow_item_ = std::move(follow_item);
-    render_state_.Follow(follow_item_->GetTwi().matrix());
+    {
+        std::lock_guard<std::mutex> lock(render_pose_mutex_);
+        camera_state_ = CameraState::FollowCamera;
+        follow_item_ = std::move(follow_item);
+        render_state_.Follow(follow_item_->GetTwi().matrix());
+    }
+    RequestRedraw();
 }
 
 /**
@@ -83,10 +86,13 @@ void Camera::SetFollow(UIItem::Ptr follow_item) {
  * @param Twi 输入的固定位姿
  */
 void Camera::SetFixedPose(SE3 Twi) {
-    std::lock_guard<std::mutex> lock(render_pose_mutex_);
-    camera_state_ = CameraState::FixedCamera;
-    camera_fixed_Twi_ = std::move(Twi);
-    render_state_.Follow(camera_fixed_Twi_.matrix());
+    {
+        std::lock_guard<std::mutex> lock(render_pose_mutex_);
+        camera_state_ = CameraState::FixedCamera;
+        camera_fixed_Twi_ = std::move(Twi);
+        render_state_.Follow(camera_fixed_Twi_.matrix());
+    }
+    RequestRedraw();
 }
 
 /**
@@ -94,8 +100,11 @@ void Camera::SetFixedPose(SE3 Twi) {
  * 
  */
 void Camera::SetFree() {
-    std::lock_guard<std::mutex> lock(render_pose_mutex_);
-    camera_state_ = CameraState::FreeCamera;
+    {
+        std::lock_guard<std::mutex> lock(render_pose_mutex_);
+        camera_state_ = CameraState::FreeCamera;
+    }
+    RequestRedraw();
 }
 
 /**
@@ -1,3 +1,4 @@
+#include "slam_viewer/core/Frustum.h"
 #include "slam_viewer/ui/CloudUI.hpp"
 
 namespace slam_viewer{
@@ -21,87 +22,342 @@ std::vector<Vec4, Eigen::aligned_allocator<Vec4>> contrast_table_ = {
 // clang-format on
 
 /**
- * @brief 创建稠密颜色表
+ * @brief 创建稠密颜色表，通过std::call_once保证多线程下只创建一次
  *
  */
 void BuildIntensityTable() {
-    intensity_table_.reserve(256 * 6);
-    auto make_color = [](int r, int g, int b) -> Vec4 { return Vec4(r / 255.0f, g / 255.0f, b / 255.0f, 0.5f); };
-    for (int i = 0; i < 256; i++)
-        intensity_table_.emplace_back(make_color(255, i, 0));
+    static std::once_flag once_flag;
+    std::call_once(once_flag, []() {
+        intensity_table_.reserve(kIntensityTableSize);
+        auto make_color = [](int r, int g, int b) -> Vec4 { return Vec4(r / 255.0f, g / 255.0f, b / 255.0f, 0.5f); };
+        for (int i = 0; i < 256; i++)
+            intensity_table_.emplace_back(make_color(255, i, 0));
 
-    for (int i = 0; i < 256; i++)
-        intensity_table_.emplace_back(make_color(255 - i, 0, 255));
+        for (int i = 0; i < 256; i++)
+            intensity_table_.emplace_back(make_color(255 - i, 0, 255));
 
-    for (int i = 0; i < 256; i++)
-        intensity_table_.emplace_back(make_color(0, 255, i));
+        for (int i = 0; i < 256; i++)
+            intensity_table_.emplace_back(make_color(0, 255, i));
 
-    for (int i = 0; i < 256; i++)
-        intensity_table_.emplace_back(make_color(255, 255 - i, 0));
+        for (int i = 0; i < 256; i++)
+            intensity_table_.emplace_back(make_color(255, 255 - i, 0));
 
-    for (int i = 0; i < 256; i++)
-        intensity_table_.emplace_back(make_color(i, 0, 255));
+        for (int i = 0; i < 256; i++)
+            intensity_table_.emplace_back(make_color(i, 0, 255));
 
-    for (int i = 0; i < 256; i++)
-        intensity_table_.emplace_back(make_color(0, 255, 255 - i));
+        for (int i = 0; i < 256; i++)
+            intensity_table_.emplace_back(make_color(0, 255, 255 - i));
+
+        intensity_table_init_ = true;
+    });
+}
+
+/**
+ * @brief 清空点云并设置新的自身坐标系，显存在渲染线程处理重置批次时从头写入，非渲染线程调用
+ *
+ * @param Twi 输入的点云在世界坐标系下的位姿
+ */
+void CloudUI::ResetCloud(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+
+    CloudBatch batch;
+    batch.reset_ = true;
+    batches_.Push(std::move(batch));
+    MarkUpdate();
+}
+
+/**
+ * @brief 按存储格式追加点云坐标系下的点，非渲染线程调用
+ *
+ * @param cloud_xyz     输入的点的位置
+ * @param cloud_color   输入的点的颜色，可以为空
+ * @param cloud_scalar  输入的点的标量，可以为空
+ */
+void CloudUI::AppendPoints(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color,
+                           const std::vector<float> &cloud_scalar) {
+    if (storage_ == StorageType::Packed)
+        AppendPacked(cloud_xyz, cloud_color, cloud_scalar);
+    else
+        AppendFloat(cloud_xyz, cloud_color, cloud_scalar);
 }
 
 /**
- * @brief float到Vec4的映射函数
+ * @brief 以浮点格式追加点云坐标系下的点，非渲染线程调用，点作为一个批次无锁发布
  *
- * @param intensity 输入的float数字
- * @return Vec4     输出的Vec4的颜色
+ * @param cloud_xyz     输入的点的位置
+ * @param cloud_color   输入的点的颜色，可以为空
+ * @param cloud_scalar  输入的点的标量，可以为空
+ */
+void CloudUI::AppendFloat(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color,
+                          const std::vector<float> &cloud_scalar) {
+    CloudBatch batch;
+    batch.xyz_ = cloud_xyz;
+    batch.color_ = cloud_color;
+    batch.scalar_ = cloud_scalar;
+    batches_.Push(std::move(batch));
+    MarkUpdate();
+}
+
+/**
+ * @brief 以Packed格式追加点云坐标系下的点，非渲染线程调用
+ * @details
+ *      1. 点按kChunkSize划分到分块中，块内位置相对分块中心按kQuantScale量化为int16
+ *      2. 颜色截断到[0, 1]后量化为RGBA8，与OpenGL对浮点颜色的截断行为一致
+ *      3. 量化和分组在生产者线程完成，分组结果作为一个批次无锁发布，分块由渲染线程创建
+ * @param cloud_xyz     输入的点的位置
+ * @param cloud_color   输入的点的颜色，可以为空
+ * @param cloud_scalar  输入的点的标量，可以为空
+ */
+void CloudUI::AppendPacked(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color,
+                           const std::vector<float> &cloud_scalar) {
+    const float inv_chunk_size = 1.0f / kChunkSize;
+    const float inv_quant_scale = 1.0f / kQuantScale;
+    std::unordered_map<Eigen::Vector3i, PackedPoints, ChunkKeyHash> packed;
+
+    for (std::size_t i = 0; i < cloud_xyz.size(); ++i) {
+        const Vec3 &pt = cloud_xyz[i];
+        Eigen::Vector3i key = (pt * inv_chunk_size).array().floor().cast<int>();
+        Vec3 origin = (key.cast<float>() + Vec3::Constant(0.5f)) * kChunkSize;
+
+        auto &points = packed[key];
+        points.key_ = key;
+        points.xyz_.push_back(((pt - origin) * inv_quant_scale).array().round().cast<std::int16_t>().matrix());
+        if (!cloud_color.empty())
+            points.color_.push_back(
+                (cloud_color[i].cwiseMax(0.f).cwiseMin(1.f) * 255.f).array().round().cast<std::uint8_t>().matrix());
+        if (!cloud_scalar.empty())
+            points.scalar_.push_back(cloud_scalar[i]);
+    }
+
+    CloudBatch batch;
+    batch.packed_.reserve(packed.size());
+    for (auto &item : packed)
+        batch.packed_.push_back(std::move(item.second));
+    batches_.Push(std::move(batch));
+    MarkUpdate();
+}
+
+/**
+ * @brief 追加一种逐点属性，使属性缓冲区与位置缓冲区等长，仅渲染线程调用
+ * @details
+ *      同一个CloudUI可以混合添加带颜色和带标量的点云，批次缺少的属性以fill补齐；
+ *      属性缓冲区为空时不补齐，从未出现过的属性不占用显存
+ * @tparam T        属性类型
+ * @param buffer    输入输出的属性缓冲区
+ * @param data      输入的批次中的属性，可以为空
+ * @param begin     输入的追加前位置缓冲区的点数
+ * @param end       输入的追加后位置缓冲区的点数
+ * @param fill      输入的补齐使用的属性值
+ */
+template <typename T>
+static void AppendAttribute(DynamicBuffer &buffer, const std::vector<T> &data, std::size_t begin, std::size_t end,
+                            const T &fill) {
+    std::size_t pad_to = data.empty() ? end : begin;
+    if ((!data.empty() || buffer.Size() > 0) && buffer.Size() < pad_to) {
+        std::vector<T> padding(pad_to - buffer.Size(), fill);
+        buffer.Append(padding.data(), padding.size());
+    }
+    if (!data.empty())
+        buffer.Append(data.data(), data.size());
+}
+
+/**
+ * @brief 获取分块索引对应的分块，仅渲染线程调用
+ *
+ * @param key       输入的分块索引
+ * @return Chunk&   输出的分块，新建或复用的分块为空
+ */
+CloudUI::Chunk &CloudUI::AcquireChunk(const Eigen::Vector3i &key) {
+    auto iter = chunk_index_.find(key);
+    if (iter != chunk_index_.end())
+        return *chunks_[iter->second];
+
+    chunk_index_.emplace(key, chunks_.size());
+    if (free_chunks_.empty()) {
+        chunks_.push_back(std::make_unique<Chunk>(key));
+    } else {
+        chunks_.push_back(std::move(free_chunks_.back()));
+        free_chunks_.pop_back();
+        chunks_.back()->Reset(key);
+    }
+    return *chunks_.back();
+}
+
+/**
+ * @brief 将一批点追加到显存尾部，并扩展点云坐标系下的包围盒，仅渲染线程调用
+ * @details
+ *      1. 重置批次将全部分块移入空闲列表，之后的新分块优先复用其显存；
+ *         上一次重置后未被复用的空闲分块在此时释放，空闲分块的显存不会无限累积
+ *      2. 颜色和标量缓冲区始终与位置缓冲区等长，缺少的属性以UI颜色或0补齐
+ * @param batch 输入的生产者发布的批次
  */
-Vec4 IntensityToRgbPCL(const float &intensity) {
-    int index = int(intensity * 6);
-    index = index % intensity_table_.size();
-    return intensity_table_[index];
+void CloudUI::UploadBatch(CloudBatch &batch) {
+    if (batch.reset_) {
+        SetLocalBounds(Eigen::AlignedBox3f());
+        xyz_buffer_.Resize(0);
+        color_buffer_.Resize(0);
+        scalar_buffer_.Resize(0);
+
+        free_chunks_.clear();
+        for (auto &chunk : chunks_)
+            free_chunks_.push_back(std::move(chunk));
+        chunks_.clear();
+        chunk_index_.clear();
+    }
+
+    const Vec4 fill_color(color_.x(), color_.y(), color_.z(), 1.0f);
+    if (!batch.xyz_.empty()) {
+        Eigen::AlignedBox3f box;
+        for (const auto &pt : batch.xyz_)
+            box.extend(pt);
+        ExtendLocalBounds(box);
+
+        std::size_t begin = xyz_buffer_.Size();
+        xyz_buffer_.Append(batch.xyz_.data(), batch.xyz_.size());
+        AppendAttribute(color_buffer_, batch.color_, begin, xyz_buffer_.Size(), fill_color);
+        AppendAttribute(scalar_buffer_, batch.scalar_, begin, xyz_buffer_.Size(), 0.0f);
+    }
+
+    const Vec4b fill_packed =
+        (fill_color.cwiseMax(0.f).cwiseMin(1.f) * 255.f).array().round().cast<std::uint8_t>().matrix();
+    for (auto &points : batch.packed_) {
+        Chunk &chunk = AcquireChunk(points.key_);
+        ExtendLocalBounds(chunk.box_);
+
+        std::size_t begin = chunk.xyz_buffer_.Size();
+        chunk.xyz_buffer_.Append(points.xyz_.data(), points.xyz_.size());
+        AppendAttribute(chunk.color_buffer_, points.color_, begin, chunk.xyz_buffer_.Size(), fill_packed);
+        AppendAttribute(chunk.scalar_buffer_, points.scalar_, begin, chunk.xyz_buffer_.Size(), 0.0f);
+    }
 }
 
 /**
- * @brief 点云ui渲染函数
+ * @brief 绘制点，设置了ColorMap时使用标量和颜色表着色，否则使用逐点颜色，仅渲染线程调用
+ * @details
+ *      属性缓冲区只有与位置缓冲区等长时才使用，重置后仅添加了另一种属性的点云不会读取过期的属性
  *
+ * @param color_map     输入的GPU颜色映射，可以为nullptr
+ * @param xyz_buffer    输入的位置缓冲区
+ * @param color_buffer  输入的颜色缓冲区
+ * @param scalar_buffer 输入的标量缓冲区
+ * @param model         输入的顶点坐标到世界坐标系的变换
+ */
+void CloudUI::DrawPoints(const ColorMap::Ptr &color_map, const DynamicBuffer &xyz_buffer,
+                         const DynamicBuffer &color_buffer, const DynamicBuffer &scalar_buffer, const Mat4 &model) {
+    const bool has_color = color_buffer.IsValid() && color_buffer.Size() == xyz_buffer.Size();
+    const bool has_scalar = scalar_buffer.IsValid() && scalar_buffer.Size() == xyz_buffer.Size();
+    if (!color_map) {
+        RenderBuffer(xyz_buffer, has_color ? &color_buffer : nullptr, GL_POINTS, 0, xyz_buffer.Size());
+        return;
+    }
+
+    if (!has_scalar && color_map->GetMode() != ColorMap::Mode::Height)
+        return;
+
+    color_map->SetModel(model);
+    if (has_scalar)
+        color_map->BindScalar(scalar_buffer);
+    RenderBuffer(xyz_buffer, nullptr, GL_POINTS, 0, xyz_buffer.Size());
+    color_map->UnbindScalar();
+}
+
+/**
+ * @brief 点云ui渲染函数，点云在自身坐标系下存储，Twi_作为模型矩阵在渲染时作用
+ * @details
+ *      1. 显存和分块仅由渲染线程访问，只在拷贝Twi_时短暂持有mutex_，绘制期间生产者不会被阻塞
+ *      2. Packed格式下每个分块再叠加平移到分块中心和kQuantScale缩放的模型矩阵，
+ *         由固定管线将int16位置还原为点云坐标系下的浮点位置，RGBA8颜色由OpenGL归一化
+ *      3. 设置了ColorMap时，颜色由着色器根据标量或世界坐标系下的高度计算
+ *      4. Packed格式下在点云坐标系中与视锥体求交，跳过视野外和空的分块
  */
 void CloudUI::Render() {
     if (!IsValid())
         return;
 
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+    ColorMap::Ptr color_map = std::atomic_load(&color_map_);
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
     glPointSize(point_size_);
-    pangolin::RenderVboCbo(vbo_, cbo_);
+    if (color_map)
+        color_map->Bind();
+
+    if (storage_ == StorageType::Packed) {
+        Frustum frustum = Frustum::FromGlState();
+        for (const auto &chunk : chunks_) {
+            if (chunk->xyz_buffer_.Size() == 0 || !frustum.Intersects(chunk->box_))
+                continue;
+
+            Mat4 local = (Eigen::Translation3f(chunk->origin_) * Eigen::Scaling(kQuantScale)).matrix();
+            glPushMatrix();
+            glMultMatrixf(local.data());
+            DrawPoints(color_map, chunk->xyz_buffer_, chunk->color_buffer_, chunk->scalar_buffer_, Twi * local);
+            glPopMatrix();
+        }
+    } else
+        DrawPoints(color_map, xyz_buffer_, color_buffer_, scalar_buffer_, Twi);
+
+    if (color_map)
+        color_map->Unbind();
     glPointSize(1.0);
+    glPopMatrix();
 }
 
 /**
- * @brief 清除函数
+ * @brief 更新显存中的点云，渲染线程调用
+ * @details
+ *      1. 通过一次原子交换取走生产者发布的全部批次，按发布顺序追加到显存，不获取mutex_
+ *      2. 显存预留空闲容量，按几何倍数扩容，扩容时在显存内拷贝旧数据
+ *      3. 每个批次只上传自身的点，单帧上传量与累计点数无关，CPU侧不保留点云副本
+ *      4. 重置批次清空显存后从头写入；Packed格式下各分块分别追加，上传带宽约为浮点格式的1/3
+ */
+void CloudUI::Update() {
+    batches_.Drain([&](CloudBatch &&batch) { UploadBatch(batch); });
+}
+
+/// 显存占用的字节数，包括预留的空闲容量，仅渲染线程调用
+std::size_t CloudUI::GpuBytes() {
+    std::size_t bytes = xyz_buffer_.CapacityBytes() + color_buffer_.CapacityBytes() + scalar_buffer_.CapacityBytes();
+    for (const auto *chunks : {&chunks_, &free_chunks_}) {
+        for (const auto &chunk : *chunks)
+            bytes += chunk->xyz_buffer_.CapacityBytes() + chunk->color_buffer_.CapacityBytes() +
+                     chunk->scalar_buffer_.CapacityBytes();
+    }
+    return bytes;
+}
+
+/**
+ * @brief 清除函数，发布重置批次，显存保留并在渲染线程下次更新时从头写入
  *
  */
 void CloudUI::Clear() {
-    vbo_.Free();
-    cbo_.Free();
-    std::lock_guard<std::mutex> lock(mutex_);
-    cloud_xyz_.clear();
-    cloud_color_.clear();
+    CloudBatch batch;
+    batch.reset_ = true;
+    batches_.Push(std::move(batch));
+    MarkUpdate();
 }
 
 /**
  * @brief 重置点云在世界坐标系下的位姿Twi
- *
+ * @details
+ *      点在AddCloud时已经变换到点云坐标系并按体素分块上传，位姿变化只替换模型矩阵，
+ *      分块的包围盒同样在点云坐标系下，不需要修改，View3D随位姿重新计算世界坐标系下的包围盒
  * @param Twi 输入的重置后的Twi数据
  */
 void CloudUI::ResetTwi(const SE3 &Twi) {
-    need_update_.store(true);
-
-    std::vector<Vec3> cloud_xyz(cloud_xyz_.size());
-
-    SE3 Tiw_ = Twi_.inverse();
-    for (int i = 0; i < cloud_xyz_.size(); ++i) {
-        const auto &pw = cloud_xyz_[i];
-        cloud_xyz[i] = Twi * Tiw_ * pw;
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
     }
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::swap(cloud_xyz_, cloud_xyz);
-    Twi_ = Twi;
+    MarkMoved();
 }
 
 }
\ No newline at end of file
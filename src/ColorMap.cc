@@ -0,0 +1,175 @@
+#include <algorithm>
+
+#include "slam_viewer/core/ColorMap.h"
+#include "slam_viewer/ui/CloudUI.hpp"
+
+namespace slam_viewer {
+
+/// 颜色映射的顶点着色器，Height模式下由模型矩阵计算世界坐标系下的高度
+static const char *kColorMapVertexShader = R"(
+#version 120
+attribute float a_scalar;
+uniform mat4 u_model;
+uniform int u_mode;
+uniform float u_min;
+uniform float u_max;
+varying float v_t;
+
+void main() {
+    float value = u_mode == 1 ? (u_model * gl_Vertex).z : a_scalar;
+    v_t = clamp((value - u_min) / max(u_max - u_min, 1e-6), 0.0, 1.0);
+    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+}
+)";
+
+/// 颜色映射的片段着色器，Gray模式下直接输出灰度
+static const char *kColorMapFragmentShader = R"(
+#version 120
+uniform sampler2D u_lut;
+uniform int u_mode;
+uniform float u_alpha;
+varying float v_t;
+
+void main() {
+    vec3 color = u_mode == 2 ? vec3(v_t) : texture2D(u_lut, vec2(v_t, 0.5)).rgb;
+    gl_FragColor = vec4(color, u_alpha);
+}
+)";
+
+/**
+ * @brief GPU颜色映射的构造函数，构造时不创建OpenGL资源，非渲染线程也可构造
+ *
+ * @param mode      输入的映射模式
+ * @param min_value 输入的映射范围最小值，映射到颜色表的起点
+ * @param max_value 输入的映射范围最大值，映射到颜色表的终点
+ * @param alpha     输入的透明度
+ */
+ColorMap::ColorMap(Mode mode, float min_value, float max_value, float alpha)
+    : mode_(mode)
+    , min_value_(min_value)
+    , max_value_(max_value)
+    , alpha_(alpha)
+    , init_(false)
+    , scalar_location_(-1)
+    , model_location_(-1) {}
+
+/**
+ * @brief 编译着色器，并将BuildIntensityTable()创建的稠密颜色表上传为纹理
+ *
+ */
+void ColorMap::Init() {
+    BuildIntensityTable();
+
+    program_.AddShader(pangolin::GlSlVertexShader, kColorMapVertexShader);
+    program_.AddShader(pangolin::GlSlFragmentShader, kColorMapFragmentShader);
+    program_.Link();
+    scalar_location_ = program_.GetAttributeHandle("a_scalar");
+    model_location_ = program_.GetUniformHandle("u_model");
+
+    lut_.Reinitialise(intensity_table_.size(), 1, GL_RGBA32F, true, 0, GL_RGBA, GL_FLOAT,
+                      intensity_table_.data());
+    lut_.Bind();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    lut_.Unbind();
+    init_ = true;
+}
+
+/**
+ * @brief 绑定着色器和颜色表，并设置映射模式、范围和透明度，仅渲染线程调用
+ * @details
+ *      模式和范围只是uniform变量，切换时不需要重新计算或上传任何点的数据
+ */
+void ColorMap::Bind() {
+    if (!init_)
+        Init();
+
+    program_.Bind();
+    program_.SetUniform("u_mode", static_cast<int>(mode_.load()));
+    program_.SetUniform("u_min", min_value_.load());
+    program_.SetUniform("u_max", max_value_.load());
+    program_.SetUniform("u_alpha", alpha_.load());
+    program_.SetUniform("u_lut", 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    lut_.Bind();
+    SetModel(Mat4::Identity());
+}
+
+/**
+ * @brief 设置模型矩阵，仅渲染线程在Bind()之后调用
+ *
+ * @param model 输入的顶点坐标到世界坐标系的变换
+ */
+void ColorMap::SetModel(const Mat4 &model) {
+    glUniformMatrix4fv(model_location_, 1, GL_FALSE, model.data());
+}
+
+/**
+ * @brief 将缓冲区中的标量字段绑定到着色器的标量属性，整数类型按原值转换为float，仅渲染线程调用
+ *
+ * @param buffer    输入的缓冲区
+ * @param datatype  输入的标量字段的数据类型
+ * @param stride    输入的相邻标量之间的字节数，0表示紧密排列
+ * @param offset    输入的第一个标量在缓冲区中的字节偏移
+ */
+void ColorMap::BindScalar(const DynamicBuffer &buffer, GLenum datatype, GLsizei stride, std::size_t offset) {
+    if (scalar_location_ < 0)
+        return;
+
+    buffer.Bind();
+    glVertexAttribPointer(scalar_location_, 1, datatype, GL_FALSE, stride, reinterpret_cast<const void *>(offset));
+    glEnableVertexAttribArray(scalar_location_);
+    buffer.Unbind();
+}
+
+/// 解绑标量属性，仅渲染线程调用
+void ColorMap::UnbindScalar() {
+    if (scalar_location_ >= 0)
+        glDisableVertexAttribArray(scalar_location_);
+}
+
+/**
+ * @brief 注册映射参数变化时的回调，任意线程调用
+ *
+ * @param owner     输入的注册者，用于替换和注销
+ * @param callback  输入的回调，在调用映射参数设置函数的线程中执行
+ */
+void ColorMap::AddListener(const void *owner, std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+    for (auto &listener : listeners_) {
+        if (listener.first == owner) {
+            listener.second = std::move(callback);
+            return;
+        }
+    }
+    listeners_.emplace_back(owner, std::move(callback));
+}
+
+/**
+ * @brief 注销owner注册的回调，任意线程调用
+ * @details
+ *      回调在持有listener_mutex_时执行，因此注销返回后owner可以安全析构
+ * @param owner 输入的注册者
+ */
+void ColorMap::RemoveListener(const void *owner) {
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [&](const auto &listener) { return listener.first == owner; }),
+                     listeners_.end());
+}
+
+/// 映射参数变化后调用全部回调
+void ColorMap::NotifyListeners() {
+    std::lock_guard<std::mutex> lock(listener_mutex_);
+    for (const auto &listener : listeners_)
+        listener.second();
+}
+
+/// 解绑着色器和颜色表，仅渲染线程调用
+void ColorMap::Unbind() {
+    lut_.Unbind();
+    program_.Unbind();
+}
+
+} // namespace slam_viewer
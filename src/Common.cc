@@ -13,7 +13,13 @@ UIItem::UIItem(Vec3 color, float line_width, float point_size)
     : line_width_(line_width)
     , point_size_(point_size)
     , color_(std::move(color))
-    , need_update_(true) {}
+    , need_update_(true)
+    , queued_(true)
+    , bounds_version_(0)
+    , has_bounds_(false)
+    , update_num_(0)
+    , update_ns_(0)
+    , upload_bytes_(0) {}
 
 /**
  * @brief 需要提供UIItem在世界坐标系中的坐标
@@ -28,23 +34,155 @@ UIItem::UIItem(Vec3 color, float line_width, float point_size, SE3 Twi)
     , line_width_(std::move(line_width))
     , point_size_(std::move(point_size))
     , color_(std::move(color))
-    , need_update_(true) {}
+    , need_update_(true)
+    , queued_(true)
+    , bounds_version_(0)
+    , has_bounds_(false)
+    , update_num_(0)
+    , update_ns_(0)
+    , upload_bytes_(0) {}
 
 /// 清除UIItem的相关内容
 void UIItem::Clear() {
-    need_update_.store(true);
-    std::lock_guard<std::mutex> lock(mutex_);
+    MarkUpdate();
+    auto lock = ProducerLock();
     vbo_.Free();
 }
 
 /**
  * @brief 重置UIItem在世界坐标系下的位姿
- *
+ * @details
+ *      子类可能在Update中使用Twi_变换数据，因此默认实现同时标记需要更新；
+ *      只把Twi_作为模型矩阵的子类应重写为只调用MarkMoved
  * @param Twi 输入的新的UIItem在世界坐标系下的位姿
  */
 void UIItem::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    bounds_version_.fetch_add(1);
+    MarkUpdate();
+}
+
+/**
+ * @brief 标记UIItem需要更新，非渲染线程调用
+ * @details
+ *      queued_由false变为true时，将句柄压入所在View3D的脏队列；渲染线程处理前会将queued_置回，
+ *      因此两次处理之间的多次标记只会压入一次，渲染线程的开销与变化的ui_item数量成正比
+ */
+void UIItem::MarkUpdate() {
     need_update_.store(true);
-    Twi_ = Twi;
+    PushDirty();
+}
+
+/**
+ * @brief 标记UIItem的位姿发生变化，非渲染线程调用
+ * @details
+ *      只修改模型矩阵的ResetTwi不需要重新上传数据，因此不设置need_update_，
+ *      View3D处理脏队列时重新计算世界坐标系下的包围盒并修正BVH
+ */
+void UIItem::MarkMoved() {
+    bounds_version_.fetch_add(1);
+    PushDirty();
+}
+
+/// 将自身的句柄压入所在View3D的脏队列，queued_已为true时说明尚未被处理，直接跳过
+void UIItem::PushDirty() {
+    if (queued_.exchange(true))
+        return;
+
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    for (const auto &item : dirty_queues_)
+        item.first->Push(item.second);
+}
+
+/**
+ * @brief 设置UI坐标系下的包围盒，仅渲染线程在Update中调用
+ *
+ * @param box 输入的UI坐标系下的包围盒，为空时表示没有需要绘制的内容
+ */
+void UIItem::SetLocalBounds(const Eigen::AlignedBox3f &box) {
+    local_bounds_ = box;
+    has_bounds_ = true;
+    bounds_version_.fetch_add(1);
+}
+
+/**
+ * @brief 扩展UI坐标系下的包围盒，仅渲染线程在Update中调用
+ *
+ * @param box 输入的新增内容在UI坐标系下的包围盒
+ */
+void UIItem::ExtendLocalBounds(const Eigen::AlignedBox3f &box) {
+    if (box.isEmpty() && has_bounds_)
+        return;
+
+    local_bounds_.extend(box);
+    has_bounds_ = true;
+    bounds_version_.fetch_add(1);
+}
+
+/**
+ * @brief 获取世界坐标系下的包围盒，由UI坐标系下的包围盒经Twi_变换得到，仅渲染线程调用
+ *
+ * @param box       输出的世界坐标系下的包围盒，没有需要绘制的内容时为空
+ * @return true     维护了包围盒
+ * @return false    没有维护包围盒
+ */
+bool UIItem::WorldBounds(Eigen::AlignedBox3f &box) {
+    if (!has_bounds_)
+        return false;
+
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+    box = TransformBox(local_bounds_, Twi);
+    return true;
+}
+
+/// 获取更新和加锁等待的累计统计，任意线程调用
+ItemStats UIItem::GetStats() const {
+    ItemStats stats;
+    stats.update_num_ = update_num_.load();
+    stats.update_ms_ = update_ns_.load() * 1e-6;
+    stats.upload_bytes_ = upload_bytes_.load();
+    stats.lock_ = lock_profiler_.Stats();
+    return stats;
+}
+
+/// 记录一次Update的时间和上传字节数，仅渲染线程调用
+void UIItem::RecordUpdate(std::uint64_t update_ns, std::size_t upload_bytes) {
+    update_num_.fetch_add(1, std::memory_order_relaxed);
+    update_ns_.fetch_add(update_ns, std::memory_order_relaxed);
+    upload_bytes_.fetch_add(upload_bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 注册View3D的脏队列，View3D添加ui_item时调用
+ *
+ * @param dirty_queue   输入的脏队列
+ * @param handle        输入的ui_item在该View3D中的句柄
+ */
+void UIItem::AddDirtyQueue(std::shared_ptr<DirtyQueue> dirty_queue, const ItemHandle &handle) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    dirty_queues_.emplace_back(std::move(dirty_queue), handle);
+}
+
+/**
+ * @brief 注销View3D的脏队列，View3D删除ui_item时调用
+ *
+ * @param dirty_queue 输入的脏队列
+ */
+void UIItem::RemoveDirtyQueue(const DirtyQueue *dirty_queue) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    for (auto iter = dirty_queues_.begin(); iter != dirty_queues_.end(); ++iter) {
+        if (iter->first.get() == dirty_queue) {
+            dirty_queues_.erase(iter);
+            return;
+        }
+    }
 }
 
 }
\ No newline at end of file
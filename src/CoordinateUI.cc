@@ -3,81 +3,84 @@
 namespace slam_viewer{
 
 /**
- * @brief 坐标系的构造函数
+ * @brief 坐标系的构造函数，构造时不创建OpenGL资源
  *
  * @param arrow_length  输入的轴长
  * @param Twi           输入的坐标系的位姿
  */
 CoordinateUI::CoordinateUI(float arrow_length, SE3 Twi)
-    : UIItem(Vec3(0.0, 0.0, 0.0), 5.0, 5.0, Twi) {
-    Eigen::AngleAxisf z_rot(0.5 * M_PI, Vec3(0, 0, 1)); ///< 沿着z轴旋转90度
-    Eigen::AngleAxisf y_rot(0.5 * M_PI, Vec3(0, 1, 0)); ///< 沿着y轴旋转90度
-    Eigen::AngleAxisf x_rot(0.5 * M_PI, Vec3(1, 0, 0)); ///< 沿着x轴旋转90度
-
-    x_rot_ = SE3(x_rot.toRotationMatrix(), Vec3(0.0, 0.0, 0.0));
-    y_rot_ = SE3(y_rot.toRotationMatrix(), Vec3(0.0, 0.0, 0.0));
-    z_rot_ = SE3(z_rot.toRotationMatrix(), Vec3(0.0, 0.0, 0.0));
-
-    // clang-format off
-    x_axis_ = std::make_shared<ArrowUI>(Twi_, arrow_length, Vec3(1.0, 0.0, 0.0), 
-                                        ArrowUI::HeadType::FixedHeadRatio);
-    y_axis_ = std::make_shared<ArrowUI>(Twi_ * z_rot_, arrow_length, Vec3(0.0, 1.0, 0.0), 
-                                        ArrowUI::HeadType::FixedHeadRatio);
-    z_axis_ = std::make_shared<ArrowUI>(Twi_ * y_rot_.inverse(), arrow_length, Vec3(0.0, 0.0, 1.0),
-                                        ArrowUI::HeadType::FixedHeadRatio);
-    // clang-format on
-}
+    : UIItem(Vec3(0.0, 0.0, 0.0), 8.0, 5.0, Twi)
+    , arrow_length_(arrow_length) {}
 
 /**
- * @brief 重置坐标轴的长度，非渲染线程调用
+ * @brief 创建单位长度的坐标轴几何，箭头长度为轴长的0.2倍，张角为15度
  *
- * @param arrow_length 输入的新的坐标轴长度
+ * @param xyz   输出的顶点位置
+ * @param color 输出的顶点颜色
  */
-void CoordinateUI::ResetLength(float arrow_length){
-    std::lock_guard<std::mutex> lock(mutex_);
+void CoordinateUI::BuildAxisGeometry(std::vector<Vec3> &xyz, std::vector<Vec4> &color) {
+    const float head_length = 0.2f;
+    const float head_width = std::tan(15 * M_PI / 180) * head_length;
 
-    x_axis_->ResetArrowLength(arrow_length);
-    y_axis_->ResetArrowLength(arrow_length);
-    z_axis_->ResetArrowLength(arrow_length);
+    xyz.clear();
+    color.clear();
+    for (int axis = 0; axis < 3; ++axis) {
+        Vec3 dir = Vec3::Unit(axis);
+        Vec3 side = Vec3::Unit((axis + 1) % 3);
+        Vec3 base = dir * (1.0f - head_length);
 
-    need_update_.store(true);
+        xyz.insert(xyz.end(), {Vec3::Zero(), dir, base + side * head_width, dir, base - side * head_width, dir});
+        color.insert(color.end(), 6, Vec4(dir.x(), dir.y(), dir.z(), 1.0f));
+    }
 }
 
 /**
  * @brief 重置坐标系的位姿，非渲染线程调用
- *
+ * @details
+ *      坐标轴几何与位姿无关，只替换模型矩阵中的位姿部分，并通知View3D移动包围盒
  * @param Twi 输入的新的坐标系位姿
  */
 void CoordinateUI::ResetTwi(const SE3 &Twi) {
-    SE3 Twi_x = Twi;
-    SE3 Twi_y = Twi_x * z_rot_;
-    SE3 Twi_z = Twi_x * y_rot_.inverse();
-
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        x_axis_->ResetTwi(Twi_x);
-        y_axis_->ResetTwi(Twi_y);
-        z_axis_->ResetTwi(Twi_z);
+        auto lock = ProducerLock();
+        Twi_ = Twi;
     }
+    MarkMoved();
+}
 
-    Twi_ = Twi;
-    need_update_.store(true);
+/**
+ * @brief 重置坐标轴长度，非渲染线程调用
+ * @details
+ *      轴长只作为模型矩阵的缩放，不重新上传几何；包围盒随轴长缩放，因此标记需要更新
+ * @param arrow_length 输入的新的轴长
+ */
+void CoordinateUI::ResetLength(float arrow_length) {
+    arrow_length_.store(arrow_length);
+    MarkUpdate();
 }
 
 /**
- * @brief 更新坐标系
+ * @brief 更新坐标系，坐标轴几何只上传一次，包围盒为单位几何按轴长缩放后的范围
  *
  */
 void CoordinateUI::Update() {
-    if (need_update_.load()) {
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            x_axis_->Update();
-            y_axis_->Update();
-            z_axis_->Update();
-        }
-        need_update_.store(false);
+    bool need_update = ConsumeUpdate();
+    if (!need_update && vbo_.IsValid() && cbo_.IsValid())
+        return;
+
+    std::vector<Vec3> xyz;
+    std::vector<Vec4> color;
+    BuildAxisGeometry(xyz, color);
+    if (!vbo_.IsValid() || !cbo_.IsValid()) {
+        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, xyz);
+        cbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, color);
     }
+
+    float arrow_length = arrow_length_.load();
+    Eigen::AlignedBox3f box;
+    for (const auto &pt : xyz)
+        box.extend(pt * arrow_length);
+    SetLocalBounds(box);
 }
 
 /**
@@ -85,24 +88,32 @@ void CoordinateUI::Update() {
  *
  */
 void CoordinateUI::Clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    x_axis_->Clear();
-    y_axis_->Clear();
-    z_axis_->Clear();
+    UIItem::Clear();
+    cbo_.Free();
 }
 
 /**
- * @brief 坐标系渲染函数
+ * @brief 坐标系渲染函数，模型矩阵为位姿和轴长缩放的组合
  *
  */
 void CoordinateUI::Render() {
     if (!IsValid())
         return;
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    x_axis_->Render();
-    y_axis_->Render();
-    z_axis_->Render();
+    Mat4 model;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        model = Twi_.matrix();
+    }
+    model.topLeftCorner<3, 3>() *= arrow_length_.load();
+
+    glPushMatrix();
+    glMultMatrixf(model.data());
+    glLineWidth(line_width_);
+    pangolin::RenderVboCbo(vbo_, cbo_, true, GL_LINES);
+    CountDraw(GL_LINES, vbo_.num_elements);
+    glLineWidth(1.0);
+    glPopMatrix();
 }
 
 }
\ No newline at end of file
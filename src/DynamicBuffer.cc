@@ -0,0 +1,154 @@
+#include <numeric>
+
+#include "slam_viewer/core/DynamicBuffer.h"
+
+namespace slam_viewer {
+
+/// GL数据类型对应的字节数
+static std::size_t DataTypeBytes(GLenum datatype) {
+    switch (datatype) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+        return 2;
+    case GL_DOUBLE:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+/**
+ * @brief 可增长显存缓冲区的构造函数，构造时不分配显存，非渲染线程也可构造
+ *
+ * @param datatype          输入的元素数据类型
+ * @param count_per_element 输入的每个元素的分量数
+ * @param buffer_type       输入的缓冲区类型
+ */
+DynamicBuffer::DynamicBuffer(GLenum datatype, GLuint count_per_element, pangolin::GlBufferType buffer_type)
+    : buffer_type_(buffer_type)
+    , datatype_(datatype)
+    , count_per_element_(count_per_element)
+    , element_bytes_(DataTypeBytes(datatype) * count_per_element)
+    , size_(0)
+    , capacity_(0) {}
+
+/**
+ * @brief 扩容，新容量为max(capacity, kGrowFactor * capacity_)，已有数据通过显存内拷贝保留
+ * @details
+ *      1. 几何扩容保证n次追加的均摊代价为O(1)
+ *      2. 旧数据使用glCopyBufferSubData在显存内拷贝，不经过PCIe回传
+ * @param capacity 输入的最小容量
+ */
+void DynamicBuffer::Reserve(std::size_t capacity) {
+    if (capacity <= capacity_)
+        return;
+
+    std::size_t new_capacity = std::max(capacity, static_cast<std::size_t>(capacity_ * kGrowFactor));
+    new_capacity = std::max(new_capacity, kMinCapacity);
+
+    pangolin::GlBuffer buffer(buffer_type_, new_capacity, datatype_, count_per_element_, GL_DYNAMIC_DRAW);
+    if (size_ > 0 && buffer_.IsValid()) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer_.bo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.bo);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size_ * element_bytes_);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    buffer_ = std::move(buffer);
+    capacity_ = new_capacity;
+}
+
+/**
+ * @brief 上传数据到[offset, offset + num)范围内，只传输该子区间
+ *
+ * @param data      输入的数据指针
+ * @param offset    输入的起始元素位置
+ * @param num       输入的元素数量
+ */
+void DynamicBuffer::Upload(const void *data, std::size_t offset, std::size_t num) {
+    if (num == 0)
+        return;
+
+    Reserve(offset + num);
+    buffer_.Upload(data, num * element_bytes_, offset * element_bytes_);
+    size_ = std::max(size_, offset + num);
+    CountUpload(num * element_bytes_);
+}
+
+/// 释放显存
+void DynamicBuffer::Free() {
+    buffer_.Free();
+    size_ = 0;
+    capacity_ = 0;
+}
+
+/// 绑定顶点和颜色数组，仅渲染线程调用
+static void BindArrays(const DynamicBuffer &vbo, const DynamicBuffer *cbo) {
+    if (cbo) {
+        cbo->Bind();
+        glColorPointer(cbo->CountPerElement(), cbo->DataType(), 0, 0);
+        glEnableClientState(GL_COLOR_ARRAY);
+    }
+
+    vbo.Bind();
+    glVertexPointer(vbo.CountPerElement(), vbo.DataType(), 0, 0);
+    glEnableClientState(GL_VERTEX_ARRAY);
+}
+
+/// 解绑顶点和颜色数组，仅渲染线程调用
+static void UnbindArrays(const DynamicBuffer &vbo, const DynamicBuffer *cbo) {
+    glDisableClientState(GL_VERTEX_ARRAY);
+    vbo.Unbind();
+
+    if (cbo) {
+        glDisableClientState(GL_COLOR_ARRAY);
+        cbo->Unbind();
+    }
+}
+
+/**
+ * @brief 渲染DynamicBuffer中[first, first + count)范围内的顶点，仅渲染线程调用
+ *
+ * @param vbo   输入的顶点缓冲区
+ * @param cbo   输入的颜色缓冲区，为nullptr时使用当前颜色
+ * @param mode  输入的图元类型
+ * @param first 输入的起始顶点
+ * @param count 输入的顶点数量
+ */
+void RenderBuffer(const DynamicBuffer &vbo, const DynamicBuffer *cbo, GLenum mode, std::size_t first,
+                  std::size_t count) {
+    if (count == 0 || !vbo.IsValid())
+        return;
+
+    BindArrays(vbo, cbo);
+    glDrawArrays(mode, first, count);
+    UnbindArrays(vbo, cbo);
+    CountDraw(mode, count);
+}
+
+/**
+ * @brief 使用一次glMultiDrawArrays渲染DynamicBuffer中的多个区间，仅渲染线程调用
+ *
+ * @param vbo           输入的顶点缓冲区
+ * @param cbo           输入的颜色缓冲区，为nullptr时使用当前颜色
+ * @param mode          输入的图元类型
+ * @param firsts        输入的各区间起始顶点
+ * @param counts        输入的各区间顶点数量
+ * @param draw_count    输入的区间数量
+ */
+void RenderBuffer(const DynamicBuffer &vbo, const DynamicBuffer *cbo, GLenum mode, const GLint *firsts,
+                  const GLsizei *counts, std::size_t draw_count) {
+    if (draw_count == 0 || !vbo.IsValid())
+        return;
+
+    BindArrays(vbo, cbo);
+    glMultiDrawArrays(mode, firsts, counts, draw_count);
+    UnbindArrays(vbo, cbo);
+    CountDraw(mode, std::accumulate(counts, counts + draw_count, std::size_t(0)));
+}
+
+} // namespace slam_viewer
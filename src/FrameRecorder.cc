@@ -0,0 +1,231 @@
+#include <cstring>
+
+#include "slam_viewer/core/FrameRecorder.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 帧录制器的构造函数，构造时启动编码线程，不创建OpenGL资源
+ *
+ * @param path          输入的输出路径，包含'%'时为图像序列的printf格式
+ * @param fps           输入的视频帧率
+ * @param queue_size    输入的编码队列的最大帧数
+ * @param policy        输入的队列满时的策略
+ * @param pbo_num       输入的PBO数量，即读回延迟的帧数
+ */
+FrameRecorder::FrameRecorder(std::string path, double fps, std::size_t queue_size, QueuePolicy policy,
+                             std::size_t pbo_num)
+    : path_(std::move(path))
+    , fps_(fps)
+    , queue_size_(std::max<std::size_t>(queue_size, 1))
+    , policy_(policy)
+    , pbo_num_(std::max<std::size_t>(pbo_num, 1))
+    , next_slot_(0)
+    , width_(0)
+    , height_(0)
+    , in_flight_(0)
+    , closed_(false)
+    , sequence_id_(0)
+    , done_(false)
+    , captured_num_(0)
+    , written_num_(0)
+    , dropped_num_(0) {
+    worker_ = std::thread(&FrameRecorder::Encode, this);
+}
+
+/// 析构函数，关闭队列并等待编码线程写完，显存需要在此之前由渲染线程通过Finish释放
+FrameRecorder::~FrameRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    not_empty_.notify_one();
+    not_full_.notify_all();
+    if (worker_.joinable())
+        worker_.join();
+}
+
+/// 按照第一帧的尺寸创建PBO环
+void FrameRecorder::CreateSlots(int width, int height) {
+    width_ = width;
+    height_ = height;
+    slots_.resize(pbo_num_);
+    for (auto &slot : slots_)
+        slot.pbo_.Reinitialise(pangolin::GlPixelPackBuffer, width_ * height_, GL_UNSIGNED_BYTE, 3, GL_STREAM_READ);
+}
+
+/**
+ * @brief 读回当前绑定的帧缓冲，仅渲染线程调用
+ * @details
+ *      1. 先拷贝即将被复用的槽位中N帧之前的读回结果，再向该槽位发起本帧的异步读回
+ *      2. 录制尺寸以第一帧为准，窗口尺寸变化后仍按照原尺寸读回左下角区域，保证视频尺寸不变
+ * @param width     输入的帧缓冲宽度
+ * @param height    输入的帧缓冲高度
+ */
+void FrameRecorder::Capture(int width, int height) {
+    if (width <= 0 || height <= 0)
+        return;
+    if (slots_.empty())
+        CreateSlots(width, height);
+
+    Slot &slot = slots_[next_slot_];
+    if (slot.pending_)
+        ReadSlot(slot);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    slot.pbo_.Bind();
+    glReadPixels(0, 0, width_, height_, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+    slot.pbo_.Unbind();
+    slot.fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.pending_ = true;
+
+    next_slot_ = (next_slot_ + 1) % slots_.size();
+    ++captured_num_;
+}
+
+/**
+ * @brief 映射槽位的PBO并拷贝像素，仅渲染线程调用
+ * @details
+ *      Drop策略下队列满时直接丢弃，不映射PBO；正常情况下读回已经完成，等待同步对象不会阻塞
+ * @param slot 输入的槽位
+ */
+void FrameRecorder::ReadSlot(Slot &slot) {
+    slot.pending_ = false;
+    if (slot.fence_) {
+        glClientWaitSync(slot.fence_, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeout);
+        glDeleteSync(slot.fence_);
+        slot.fence_ = nullptr;
+    }
+
+    cv::Mat frame;
+    if (!AcquireFrame(frame)) {
+        ++dropped_num_;
+        return;
+    }
+
+    std::size_t bytes = frame.total() * frame.elemSize();
+    slot.pbo_.Bind();
+    const void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    if (data) {
+        std::memcpy(frame.data, data, bytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    slot.pbo_.Unbind();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (data)
+            queue_.push_back(std::move(frame));
+        else {
+            pool_.push_back(std::move(frame));
+            --in_flight_;
+        }
+    }
+    if (data)
+        not_empty_.notify_one();
+    else
+        ++dropped_num_;
+}
+
+/**
+ * @brief 获取一个空闲的帧缓冲，并占用队列中的一个位置
+ *
+ * @param frame     输出的帧缓冲，尺寸为录制尺寸
+ * @return true     获取成功
+ * @return false    Drop策略下队列已满，或队列已经关闭
+ */
+bool FrameRecorder::AcquireFrame(cv::Mat &frame) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (policy_ == QueuePolicy::Block)
+        not_full_.wait(lock, [&]() { return in_flight_ < queue_size_ || closed_; });
+    if (closed_ || in_flight_ >= queue_size_)
+        return false;
+
+    ++in_flight_;
+    if (!pool_.empty()) {
+        frame = std::move(pool_.back());
+        pool_.pop_back();
+    }
+    lock.unlock();
+
+    frame.create(height_, width_, CV_8UC3);
+    return true;
+}
+
+/**
+ * @brief 结束录制，仅渲染线程调用
+ * @details
+ *      按照读回顺序拷贝全部未完成的槽位，然后释放PBO并关闭队列，编码线程写完队列中的帧后退出
+ */
+void FrameRecorder::Finish() {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        Slot &slot = slots_[(next_slot_ + i) % slots_.size()];
+        if (slot.pending_)
+            ReadSlot(slot);
+    }
+    slots_.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    not_empty_.notify_one();
+    not_full_.notify_all();
+}
+
+/**
+ * @brief 编码线程主循环
+ * @details
+ *      取出一帧后在锁外翻转并写入，写完后将帧缓冲归还对象池；队列关闭且为空时释放写入器并退出
+ */
+void FrameRecorder::Encode() {
+    while (true) {
+        cv::Mat frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [&]() { return closed_ || !queue_.empty(); });
+            if (queue_.empty())
+                break;
+            frame = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        cv::flip(frame, frame, 0);
+        WriteFrame(frame);
+        ++written_num_;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pool_.push_back(std::move(frame));
+            --in_flight_;
+        }
+        not_full_.notify_one();
+    }
+
+    writer_.release();
+    done_.store(true);
+}
+
+/**
+ * @brief 写入一帧，视频写入器在第一帧时按照帧尺寸打开，打开失败时不再重试
+ *
+ * @param frame 输入的BGR图像
+ */
+void FrameRecorder::WriteFrame(const cv::Mat &frame) {
+    if (path_.find('%') != std::string::npos) {
+        std::vector<char> filename(path_.size() + 32);
+        std::snprintf(filename.data(), filename.size(), path_.c_str(), static_cast<int>(sequence_id_++));
+        cv::imwrite(filename.data(), frame);
+        return;
+    }
+
+    if (sequence_id_++ == 0) {
+        bool is_mp4 = path_.size() >= 4 && path_.compare(path_.size() - 4, 4, ".mp4") == 0;
+        int fourcc = is_mp4 ? cv::VideoWriter::fourcc('m', 'p', '4', 'v') : cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+        writer_.open(path_, fourcc, fps_, frame.size());
+    }
+    if (writer_.isOpened())
+        writer_.write(frame);
+}
+
+} // namespace slam_viewer
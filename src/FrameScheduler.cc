@@ -0,0 +1,107 @@
+#include <thread>
+
+#include "slam_viewer/core/FrameScheduler.h"
+
+namespace slam_viewer {
+
+/// 由频率得到周期，频率小于等于0时返回0
+static FrameScheduler::Clock::duration PeriodFromRate(double rate) {
+    if (rate <= 0)
+        return FrameScheduler::Clock::duration::zero();
+    return std::chrono::duration_cast<FrameScheduler::Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+}
+
+/**
+ * @brief 帧调度器的构造函数，构造后存在一次重绘请求，保证第一帧被绘制
+ *
+ * @param target_fps    输入的目标帧率，小于等于0时不限制帧率
+ * @param poll_rate     输入的空闲时处理窗口事件的轮询频率
+ */
+FrameScheduler::FrameScheduler(double target_fps, double poll_rate)
+    : redraw_(true)
+    , continuous_(false)
+    , frame_period_(PeriodFromRate(target_fps))
+    , poll_period_(PeriodFromRate(poll_rate))
+    , last_frame_(Clock::now() - frame_period_)
+    , frame_count_(0) {}
+
+/// 请求重绘，任意线程调用，多次请求在下一帧开始前合并为一次
+void FrameScheduler::RequestRedraw() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (redraw_)
+            return;
+        redraw_ = true;
+    }
+    condition_.notify_one();
+}
+
+/// 设置目标帧率，小于等于0时不限制帧率
+void FrameScheduler::SetTargetFps(double fps) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_period_ = PeriodFromRate(fps);
+}
+
+/// 设置空闲时的轮询频率
+void FrameScheduler::SetPollRate(double poll_rate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    poll_period_ = PeriodFromRate(poll_rate);
+}
+
+/// 设置是否持续重绘
+void FrameScheduler::SetContinuous(bool continuous) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        continuous_ = continuous;
+    }
+    condition_.notify_one();
+}
+
+/**
+ * @brief 等待下一帧或下一次轮询，仅渲染线程调用
+ * @details
+ *      1. 没有重绘请求时在条件变量上等待，最长等待一个轮询周期，返回false后由调用者处理窗口事件
+ *      2. 有重绘请求时睡眠到上一帧起始时间加最小帧间隔，保证帧率不超过目标帧率
+ * @return true     需要重绘
+ * @return false    到达轮询时间，不需要重绘
+ */
+bool FrameScheduler::WaitForFrame() {
+    Clock::time_point next_frame;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto ready = [&]() { return redraw_ || continuous_; };
+        if (poll_period_ == Clock::duration::zero())
+            condition_.wait(lock, ready);
+        else if (!condition_.wait_for(lock, poll_period_, ready))
+            return false;
+        next_frame = last_frame_ + frame_period_;
+    }
+
+    if (Clock::now() < next_frame)
+        std::this_thread::sleep_until(next_frame);
+    return true;
+}
+
+/**
+ * @brief 开始绘制一帧，仅渲染线程调用
+ * @details
+ *      按时到达时帧起始时间对齐到上一帧加最小帧间隔，避免睡眠误差累积；
+ *      落后超过一个帧间隔时（如场景空闲后的第一帧）从当前时间重新开始计时，不会连续补帧
+ */
+void FrameScheduler::BeginFrame() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    redraw_ = false;
+    ++frame_count_;
+
+    Clock::time_point now = Clock::now();
+    Clock::time_point next_frame = last_frame_ + frame_period_;
+    last_frame_ = now - next_frame < frame_period_ ? next_frame : now;
+}
+
+/// 已经绘制的帧数
+std::size_t FrameScheduler::FrameCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frame_count_;
+}
+
+} // namespace slam_viewer
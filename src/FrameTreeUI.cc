@@ -0,0 +1,337 @@
+#include "slam_viewer/ui/FrameTreeUI.h"
+#include "slam_viewer/ui/CoordinateUI.h"
+
+namespace slam_viewer {
+
+/// 实例化绘制的顶点着色器，坐标轴顶点先经过实例矩阵变换，颜色使用逐顶点颜色
+static const char *kFrameTreeVertexShader = R"(
+#version 120
+attribute mat4 a_pose;
+varying vec4 v_color;
+
+void main() {
+    v_color = gl_Color;
+    gl_Position = gl_ModelViewProjectionMatrix * (a_pose * gl_Vertex);
+}
+)";
+
+/// 实例化绘制的片段着色器
+static const char *kFrameTreeFragmentShader = R"(
+#version 120
+varying vec4 v_color;
+
+void main() {
+    gl_FragColor = v_color;
+}
+)";
+
+/**
+ * @brief 坐标系树的构造函数，构造时不创建OpenGL资源
+ *
+ * @param line_width    输入的坐标轴线宽
+ * @param Twi           输入的UI坐标系在世界坐标系下的位姿，作为模型矩阵在渲染时作用
+ */
+FrameTreeUI::FrameTreeUI(float line_width, SE3 Twi)
+    : UIItem(Vec3(0.0, 0.0, 0.0), line_width, 1.0, Twi)
+    , changed_begin_(0)
+    , changed_end_(0)
+    , need_reset_(false)
+    , pose_buffer_(GL_FLOAT, 16)
+    , program_init_(false)
+    , pose_location_(-1) {}
+
+/**
+ * @brief 添加坐标系，新坐标系的位姿在下次传播时计算
+ *
+ * @param name      输入的坐标系名称
+ * @param parent    输入的父坐标系名称，为空时父坐标系为UI坐标系
+ * @param Tpc       输入的坐标系在父坐标系下的位姿
+ * @param length    输入的坐标轴长度
+ * @return int      输出的坐标系编号，名称重复或父坐标系不存在时返回-1
+ */
+int FrameTreeUI::AddFrame(const std::string &name, const std::string &parent, const SE3 &Tpc, float length) {
+    int id = -1;
+    {
+        auto lock = ProducerLock();
+        if (index_.count(name))
+            return -1;
+
+        int parent_id = -1;
+        if (!parent.empty()) {
+            auto iter = index_.find(parent);
+            if (iter == index_.end())
+                return -1;
+            parent_id = iter->second;
+        }
+
+        id = nodes_.size();
+        Node node;
+        node.name_ = name;
+        node.parent_ = parent_id;
+        node.depth_ = parent_id < 0 ? 0 : nodes_[parent_id].depth_ + 1;
+        node.Tpc_ = Tpc;
+        node.length_ = length;
+        node.dirty_ = false;
+        nodes_.push_back(std::move(node));
+        models_.emplace_back(Mat4::Zero());
+        index_.emplace(name, id);
+        if (parent_id >= 0)
+            nodes_[parent_id].children_.push_back(id);
+
+        MarkDirty(id);
+    }
+
+    MarkUpdate();
+    return id;
+}
+
+/**
+ * @brief 设置坐标系在父坐标系下的位姿，只标记该坐标系，不立即计算子树
+ *
+ * @param name  输入的坐标系名称
+ * @param Tpc   输入的坐标系在父坐标系下的位姿
+ * @return true     设置成功
+ * @return false    坐标系不存在
+ */
+bool FrameTreeUI::SetTransform(const std::string &name, const SE3 &Tpc) {
+    {
+        auto lock = ProducerLock();
+        auto iter = index_.find(name);
+        if (iter == index_.end())
+            return false;
+
+        nodes_[iter->second].Tpc_ = Tpc;
+        MarkDirty(iter->second);
+    }
+
+    MarkUpdate();
+    return true;
+}
+
+/**
+ * @brief 设置坐标系在父坐标系下的位姿，避免高频更新时的名称查找
+ *
+ * @param id    输入的坐标系编号
+ * @param Tpc   输入的坐标系在父坐标系下的位姿
+ * @return true     设置成功
+ * @return false    编号无效
+ */
+bool FrameTreeUI::SetTransform(int id, const SE3 &Tpc) {
+    {
+        auto lock = ProducerLock();
+        if (id < 0 || id >= static_cast<int>(nodes_.size()))
+            return false;
+
+        nodes_[id].Tpc_ = Tpc;
+        MarkDirty(id);
+    }
+
+    MarkUpdate();
+    return true;
+}
+
+/// 查找坐标系编号，不存在时返回-1
+int FrameTreeUI::FindFrame(const std::string &name) {
+    auto lock = ProducerLock();
+    auto iter = index_.find(name);
+    return iter == index_.end() ? -1 : iter->second;
+}
+
+/**
+ * @brief 获取坐标系在UI坐标系下的位姿
+ *
+ * @param name  输入的坐标系名称
+ * @param Tic   输出的坐标系在UI坐标系下的位姿
+ * @return true     获取成功
+ * @return false    坐标系不存在
+ */
+bool FrameTreeUI::GetPose(const std::string &name, SE3 &Tic) {
+    auto lock = ProducerLock();
+    auto iter = index_.find(name);
+    if (iter == index_.end())
+        return false;
+
+    Propagate();
+    Tic = nodes_[iter->second].Tic_;
+    return true;
+}
+
+/// 坐标系数量
+std::size_t FrameTreeUI::Size() {
+    auto lock = ProducerLock();
+    return nodes_.size();
+}
+
+/// 标记坐标系的子树需要重新计算，已被标记时不重复记录，需持有mutex_
+void FrameTreeUI::MarkDirty(int id) {
+    if (nodes_[id].dirty_)
+        return;
+
+    nodes_[id].dirty_ = true;
+    dirty_nodes_.push_back(id);
+}
+
+/**
+ * @brief 传播被标记的子树，需持有mutex_
+ * @details
+ *      1. 被标记的坐标系按深度从浅到深处理，祖先的子树遍历会顺带清除后代的标记，后代不会被重复计算
+ *      2. 每个被标记的子树只遍历一次，代价与变化的坐标系数量成正比，与树的规模无关
+ *      3. 重新计算的坐标系同时更新实例矩阵，并扩展尚未上传的编号区间
+ */
+void FrameTreeUI::Propagate() {
+    if (dirty_nodes_.empty())
+        return;
+
+    std::sort(dirty_nodes_.begin(), dirty_nodes_.end(),
+              [&](const int &lhs, const int &rhs) { return nodes_[lhs].depth_ < nodes_[rhs].depth_; });
+
+    std::vector<int> stack;
+    for (const int &root : dirty_nodes_) {
+        if (!nodes_[root].dirty_)
+            continue;
+
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int id = stack.back();
+            stack.pop_back();
+
+            Node &node = nodes_[id];
+            node.Tic_ = node.parent_ < 0 ? node.Tpc_ : nodes_[node.parent_].Tic_ * node.Tpc_;
+            node.dirty_ = false;
+
+            Mat4 &model = models_[id];
+            model = node.Tic_.matrix();
+            model.topLeftCorner<3, 3>() *= node.length_;
+
+            if (changed_begin_ >= changed_end_) {
+                changed_begin_ = id;
+                changed_end_ = id + 1;
+            } else {
+                changed_begin_ = std::min(changed_begin_, static_cast<std::size_t>(id));
+                changed_end_ = std::max(changed_end_, static_cast<std::size_t>(id + 1));
+            }
+
+            stack.insert(stack.end(), node.children_.begin(), node.children_.end());
+        }
+    }
+    dirty_nodes_.clear();
+}
+
+/**
+ * @brief 更新函数，渲染线程调用
+ * @details
+ *      锁内只传播被标记的子树并拷贝变化区间的实例矩阵，上传在锁外进行
+ */
+void FrameTreeUI::Update() {
+    if (!vbo_.IsValid() || !cbo_.IsValid()) {
+        std::vector<Vec3> xyz;
+        std::vector<Vec4> color;
+        CoordinateUI::BuildAxisGeometry(xyz, color);
+        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, xyz);
+        cbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, color);
+    }
+
+    if (!ConsumeUpdate())
+        return;
+
+    std::vector<Mat4, Eigen::aligned_allocator<Mat4>> models;
+    std::size_t begin = 0;
+    bool need_reset = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Propagate();
+        need_reset = need_reset_;
+        need_reset_ = false;
+
+        if (changed_begin_ < changed_end_) {
+            begin = changed_begin_;
+            models.assign(models_.begin() + changed_begin_, models_.begin() + changed_end_);
+        }
+        changed_begin_ = changed_end_ = 0;
+    }
+
+    if (need_reset)
+        pose_buffer_.Resize(0);
+    pose_buffer_.Upload(models.data(), begin, models.size());
+}
+
+/// 编译实例化绘制的着色器，仅渲染线程调用
+void FrameTreeUI::InitProgram() {
+    program_.AddShader(pangolin::GlSlVertexShader, kFrameTreeVertexShader);
+    program_.AddShader(pangolin::GlSlFragmentShader, kFrameTreeFragmentShader);
+    program_.Link();
+    pose_location_ = program_.GetAttributeHandle("a_pose");
+    program_init_ = true;
+}
+
+/**
+ * @brief 渲染函数，全部坐标系通过一次实例化绘制完成，UI位姿作为模型矩阵
+ *
+ */
+void FrameTreeUI::Render() {
+    if (!IsValid())
+        return;
+
+    if (!program_init_)
+        InitProgram();
+    if (pose_location_ < 0)
+        return;
+
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    glLineWidth(line_width_);
+    program_.Bind();
+
+    cbo_.Bind();
+    glColorPointer(4, GL_FLOAT, 0, nullptr);
+    glEnableClientState(GL_COLOR_ARRAY);
+    vbo_.Bind();
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+    glEnableClientState(GL_VERTEX_ARRAY);
+
+    pose_buffer_.Bind();
+    for (int i = 0; i < 4; ++i) {
+        glVertexAttribPointer(pose_location_ + i, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4),
+                              reinterpret_cast<const void *>(sizeof(Vec4) * i));
+        glEnableVertexAttribArray(pose_location_ + i);
+        glVertexAttribDivisor(pose_location_ + i, 1);
+    }
+    pose_buffer_.Unbind();
+
+    glDrawArraysInstanced(GL_LINES, 0, vbo_.num_elements, pose_buffer_.Size());
+    CountDraw(GL_LINES, vbo_.num_elements, pose_buffer_.Size());
+
+    for (int i = 0; i < 4; ++i) {
+        glVertexAttribDivisor(pose_location_ + i, 0);
+        glDisableVertexAttribArray(pose_location_ + i);
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    vbo_.Unbind();
+
+    program_.Unbind();
+    glLineWidth(1.0);
+    glPopMatrix();
+}
+
+/// 清理函数，删除全部坐标系，显存保留并在渲染线程下次更新时从头写入
+void FrameTreeUI::Clear() {
+    {
+        auto lock = ProducerLock();
+        nodes_.clear();
+        index_.clear();
+        dirty_nodes_.clear();
+        models_.clear();
+        changed_begin_ = changed_end_ = 0;
+        need_reset_ = true;
+    }
+    MarkUpdate();
+}
+
+} // namespace slam_viewer
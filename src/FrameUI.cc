@@ -11,57 +11,55 @@ FrameUI::FrameUI(SE3 Twi, Vec3 color, float line_width, float width, float heigh
     Vec3 rd = Vec3(width / 2.0, -height / 2.0, depth);
 
     origin_points_ = {cp, lu, cp, ld, cp, ru, cp, rd, lu, ru, ru, rd, rd, ld, ld, lu, ld, ru, lu, rd};
-    points_.resize(origin_points_.size());
+    std::vector<Vec3> points(origin_points_.size());
     for (int i = 0; i < origin_points_.size(); ++i)
-        points_[i] = Twi_ * origin_points_[i];
+        points[i] = Twi_ * origin_points_[i];
+    points_.Publish(std::move(points));
+    MarkUpdate();
 }
 
-/// 渲染函数
+/// 渲染函数，不获取mutex_
 void FrameUI::Render() {
     if (IsValid()) {
-        std::unique_lock<std::mutex> lock(mutex_);
-
         glLineWidth(line_width_);
         glColor3f(color_(0), color_(1), color_(2));
 
         pangolin::RenderVbo(vbo_, GL_LINES);
+        CountDraw(GL_LINES, vbo_.num_elements);
         glLineWidth(1.0);
     }
 }
 
 /// 清理函数，线程安全
 void FrameUI::Clear() {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        points_.clear();
-    }
+    points_.Publish({});
+    MarkUpdate();
     origin_points_.clear();
     UIItem::Clear();
 }
 
-/// ui元素的更新函数
+/// ui元素的更新函数，渲染线程调用，上传最近一次发布的点，不获取mutex_
 void FrameUI::Update() {
-    if (need_update_.load()) {
-        need_update_.store(false);
+    if (!points_.Fetch())
+        return;
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, points_);
-    }
+    const auto &points = points_.Front();
+    if (points.empty())
+        vbo_.Free();
+    else
+        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, points);
 }
 
-/// 重置frameui的世界坐标
+/// 重置frameui的世界坐标，点在锁外计算后发布
 void FrameUI::ResetTwi(const SE3 &Twi) {
-    SE3 Tiw_ = Twi_.inverse();
-
-    decltype(points_) points;
-    for (int i = 0; i < points.size(); i++)
+    std::vector<Vec3> points(origin_points_.size());
+    for (int i = 0; i < origin_points_.size(); i++)
         points[i] = Twi * origin_points_[i];
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::swap(points_, points);
+    points_.Publish(std::move(points));
+    MarkUpdate();
 
+    auto lock = ProducerLock();
     Twi_ = Twi;
-    need_update_.store(true);
 }
 
 }
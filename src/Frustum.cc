@@ -0,0 +1,93 @@
+#include <pangolin/pangolin.h>
+
+#include "slam_viewer/core/Frustum.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 由投影矩阵和模型视图矩阵的乘积提取视锥体的6个裁剪平面
+ * @details
+ *      裁剪空间中满足-w <= x, y, z <= w的点可见，因此平面为第4行与第1、2、3行的和与差
+ * @param proj_model_view 输入的投影矩阵和模型视图矩阵的乘积
+ */
+Frustum::Frustum(const Mat4 &proj_model_view) {
+    const Mat4 &m = proj_model_view;
+    planes_.row(0) = m.row(3) + m.row(0); ///< 左
+    planes_.row(1) = m.row(3) - m.row(0); ///< 右
+    planes_.row(2) = m.row(3) + m.row(1); ///< 下
+    planes_.row(3) = m.row(3) - m.row(1); ///< 上
+    planes_.row(4) = m.row(3) + m.row(2); ///< 近
+    planes_.row(5) = m.row(3) - m.row(2); ///< 远
+
+    for (int i = 0; i < 6; ++i) {
+        float norm = planes_.row(i).head<3>().norm();
+        if (norm > 0)
+            planes_.row(i) /= norm;
+    }
+}
+
+/// 由当前OpenGL的投影矩阵和模型视图矩阵构造视锥体，仅渲染线程可用
+Frustum Frustum::FromGlState() {
+    Mat4 proj, model_view;
+    glGetFloatv(GL_PROJECTION_MATRIX, proj.data());
+    glGetFloatv(GL_MODELVIEW_MATRIX, model_view.data());
+    return Frustum(proj * model_view);
+}
+
+/**
+ * @brief 包围球是否与视锥体相交（保守判断）
+ *
+ * @param center    输入的球心
+ * @param radius    输入的半径
+ * @return true     相交或在视锥体内
+ * @return false    完全在视锥体外
+ */
+bool Frustum::Intersects(const Vec3 &center, float radius) const {
+    for (int i = 0; i < 6; ++i) {
+        if (planes_.row(i).head<3>().dot(center) + planes_(i, 3) < -radius)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 轴对齐包围盒是否与视锥体相交（保守判断），对每个平面检查离平面最远的正向顶点
+ *
+ * @param box       输入的轴对齐包围盒
+ * @return true     相交或在视锥体内
+ * @return false    完全在视锥体外
+ */
+bool Frustum::Intersects(const Eigen::AlignedBox3f &box) const {
+    if (box.isEmpty())
+        return false;
+
+    for (int i = 0; i < 6; ++i) {
+        Vec3 normal = planes_.row(i).head<3>().transpose();
+        Vec3 positive = (normal.array() >= 0).select(box.max(), box.min());
+        if (normal.dot(positive) + planes_(i, 3) < 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 轴对齐包围盒是否完全在视锥体内，对每个平面检查离平面最近的负向顶点
+ *
+ * @param box       输入的轴对齐包围盒
+ * @return true     完全在视锥体内
+ * @return false    与视锥体边界相交或在视锥体外
+ */
+bool Frustum::Contains(const Eigen::AlignedBox3f &box) const {
+    if (box.isEmpty())
+        return false;
+
+    for (int i = 0; i < 6; ++i) {
+        Vec3 normal = planes_.row(i).head<3>().transpose();
+        Vec3 negative = (normal.array() >= 0).select(box.min(), box.max());
+        if (normal.dot(negative) + planes_(i, 3) < 0)
+            return false;
+    }
+    return true;
+}
+
+} // namespace slam_viewer
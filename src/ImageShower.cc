@@ -49,6 +49,7 @@ void ImageShower::UpdateImage(const std::string &name, const std::string &conten
         image_ptr->content_ = content;
         image_ptr->cont_update_ = true;
     }
+    RequestRedraw();
 }
 
 /**
@@ -127,7 +128,7 @@ void ImageShower::Render() {
         }
 
         if (image->cont_update_) {
-            image->img_update_ = false;
+            image->cont_update_ = false;
             std::vector<std::string> line_content;
             {
                 std::lock_guard<std::mutex> lock(image->mutex_);
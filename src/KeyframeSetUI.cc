@@ -0,0 +1,297 @@
+#include <algorithm>
+
+#include "slam_viewer/ui/KeyframeSetUI.h"
+
+namespace slam_viewer {
+
+/// 实例化绘制的顶点着色器，视锥顶点先经过关键帧位姿变换，再经过固定管线的模型视图投影矩阵
+static const char *kKeyframeVertexShader = R"(
+#version 120
+attribute mat4 a_pose;
+attribute vec4 a_color;
+varying vec4 v_color;
+
+void main() {
+    v_color = a_color;
+    gl_Position = gl_ModelViewProjectionMatrix * (a_pose * gl_Vertex);
+}
+)";
+
+/// 实例化绘制的片段着色器
+static const char *kKeyframeFragmentShader = R"(
+#version 120
+varying vec4 v_color;
+
+void main() {
+    gl_FragColor = v_color;
+}
+)";
+
+/**
+ * @brief KeyframeSetUI的构造函数，构造时不创建OpenGL资源，非渲染线程也可构造
+ *
+ * @param color         输入的关键帧的默认颜色
+ * @param line_width    输入的线宽
+ * @param width         输入的视锥宽度
+ * @param height        输入的视锥高度
+ * @param depth         输入的视锥深度
+ */
+KeyframeSetUI::KeyframeSetUI(Vec3 color, float line_width, float width, float height, float depth)
+    : UIItem(color, line_width, 1.0)
+    , size_(0)
+    , pose_buffer_(GL_FLOAT, 16)
+    , color_buffer_(GL_FLOAT, 4)
+    , program_init_(false)
+    , pose_location_(-1)
+    , color_location_(-1) {
+    Vec3 cp = Vec3(0, 0, 0);
+    Vec3 lu = Vec3(-width / 2.0, height / 2.0, depth);
+    Vec3 ld = Vec3(-width / 2.0, -height / 2.0, depth);
+    Vec3 ru = Vec3(width / 2.0, height / 2.0, depth);
+    Vec3 rd = Vec3(width / 2.0, -height / 2.0, depth);
+
+    origin_points_ = {cp, lu, cp, ld, cp, ru, cp, rd, lu, ru, ru, rd, rd, ld, ld, lu, ld, ru, lu, rd};
+}
+
+/**
+ * @brief 添加关键帧，编号通过原子计数分配，修改无锁发布给渲染线程
+ *
+ * @param Twc           输入的关键帧在UI坐标系下的位姿
+ * @param color         输入的关键帧颜色
+ * @return std::size_t  输出的关键帧编号，用于后续更新位姿和颜色
+ */
+std::size_t KeyframeSetUI::AddKeyframe(const SE3 &Twc, const Vec3 &color) {
+    std::size_t id = size_.fetch_add(1);
+
+    KeyframeOp op;
+    op.id_ = id;
+    op.has_pose_ = true;
+    op.pose_ = Twc.matrix();
+    op.has_color_ = true;
+    op.color_ << color, 1.0f;
+    pending_.Push(std::move(op));
+    MarkUpdate();
+
+    return id;
+}
+
+/**
+ * @brief 更新关键帧的位姿，渲染线程只上传该关键帧的64字节位姿矩阵
+ *
+ * @param id    输入的关键帧编号
+ * @param Twc   输入的关键帧在UI坐标系下的新位姿
+ */
+void KeyframeSetUI::UpdatePose(std::size_t id, const SE3 &Twc) {
+    if (id >= size_.load())
+        return;
+
+    KeyframeOp op;
+    op.id_ = id;
+    op.has_pose_ = true;
+    op.pose_ = Twc.matrix();
+    pending_.Push(std::move(op));
+    MarkUpdate();
+}
+
+/**
+ * @brief 更新关键帧的颜色
+ *
+ * @param id    输入的关键帧编号
+ * @param color 输入的关键帧的新颜色
+ */
+void KeyframeSetUI::UpdateColor(std::size_t id, const Vec3 &color) {
+    if (id >= size_.load())
+        return;
+
+    KeyframeOp op;
+    op.id_ = id;
+    op.has_color_ = true;
+    op.color_ << color, 1.0f;
+    pending_.Push(std::move(op));
+    MarkUpdate();
+}
+
+/**
+ * @brief 将变化的编号合并为区间并逐段上传，渲染线程调用
+ * @details
+ *      1. 编号排序去重后，间隔不超过kMergeGap的编号合并为同一区间，少量未变化的元素随区间一起上传，换取更少的上传调用
+ *      2. 区间数量超过kMaxUploadRuns时，变化分散在整个范围内，改为一次上传[最小编号, 最大编号]
+ * @param buffer    输入输出的实例属性缓冲区
+ * @param data      输入的渲染线程持有的属性数组
+ * @param ids       输入的变化的编号，上传后清空
+ */
+template <typename T, typename Alloc>
+static void UploadRuns(DynamicBuffer &buffer, const std::vector<T, Alloc> &data, std::vector<std::size_t> &ids) {
+    if (ids.empty())
+        return;
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    std::size_t runs = 1;
+    for (std::size_t i = 1; i < ids.size(); ++i) {
+        if (ids[i] - ids[i - 1] > KeyframeSetUI::kMergeGap)
+            ++runs;
+    }
+
+    auto upload = [&](std::size_t begin, std::size_t end) { buffer.Upload(data.data() + begin, begin, end - begin); };
+    if (runs > KeyframeSetUI::kMaxUploadRuns) {
+        upload(ids.front(), ids.back() + 1);
+        ids.clear();
+        return;
+    }
+
+    std::size_t begin = ids.front(), end = ids.front() + 1;
+    for (std::size_t i = 1; i < ids.size(); ++i) {
+        if (ids[i] - (end - 1) > KeyframeSetUI::kMergeGap) {
+            upload(begin, end);
+            begin = ids[i];
+        }
+        end = ids[i] + 1;
+    }
+    upload(begin, end);
+    ids.clear();
+}
+
+/**
+ * @brief 处理生产者发布的修改并上传，渲染线程调用
+ * @details
+ *      1. 修改先合并到渲染线程持有的位姿和颜色数组中，记录本帧位姿和颜色分别变化的编号
+ *      2. 数组扩展出的编号同样记为变化，尚未到达的关键帧以全零位姿上传，不会绘制显存中的旧数据
+ *      3. 变化的编号合并为若干区间分别上传，分散在长序列两端的少量修改不会上传中间未变化的实例
+ */
+void KeyframeSetUI::Update() {
+    if (!vbo_.IsValid())
+        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, origin_points_);
+
+    if (!ConsumeUpdate())
+        return;
+
+    pending_.Drain([&](KeyframeOp &&op) {
+        if (op.reset_) {
+            poses_.clear();
+            colors_.clear();
+            pose_buffer_.Resize(0);
+            color_buffer_.Resize(0);
+            pose_dirty_.clear();
+            color_dirty_.clear();
+            return;
+        }
+
+        if (op.id_ >= poses_.size()) {
+            for (std::size_t id = poses_.size(); id <= op.id_; ++id) {
+                pose_dirty_.push_back(id);
+                color_dirty_.push_back(id);
+            }
+            poses_.resize(op.id_ + 1, Mat4::Zero());
+            colors_.resize(op.id_ + 1, Vec4::Zero());
+        }
+
+        if (op.has_pose_) {
+            poses_[op.id_] = op.pose_;
+            pose_dirty_.push_back(op.id_);
+        }
+
+        if (op.has_color_) {
+            colors_[op.id_] = op.color_;
+            color_dirty_.push_back(op.id_);
+        }
+    });
+
+    UploadRuns(pose_buffer_, poses_, pose_dirty_);
+    UploadRuns(color_buffer_, colors_, color_dirty_);
+}
+
+/// 编译实例化绘制的着色器，仅渲染线程调用
+void KeyframeSetUI::InitProgram() {
+    program_.AddShader(pangolin::GlSlVertexShader, kKeyframeVertexShader);
+    program_.AddShader(pangolin::GlSlFragmentShader, kKeyframeFragmentShader);
+    program_.Link();
+    pose_location_ = program_.GetAttributeHandle("a_pose");
+    color_location_ = program_.GetAttributeHandle("a_color");
+    program_init_ = true;
+}
+
+/**
+ * @brief 绑定实例属性，每个关键帧前进一次，mat4属性占用连续的4个位置，每个位置对应矩阵的一列
+ *
+ */
+void KeyframeSetUI::BindInstances() {
+    pose_buffer_.Bind();
+    for (int i = 0; i < 4; ++i) {
+        glVertexAttribPointer(pose_location_ + i, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4),
+                              reinterpret_cast<const void *>(sizeof(Vec4) * i));
+        glEnableVertexAttribArray(pose_location_ + i);
+        glVertexAttribDivisor(pose_location_ + i, 1);
+    }
+    pose_buffer_.Unbind();
+
+    color_buffer_.Bind();
+    glVertexAttribPointer(color_location_, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(color_location_);
+    glVertexAttribDivisor(color_location_, 1);
+    color_buffer_.Unbind();
+}
+
+/// 解绑实例属性，恢复属性的前进频率，避免影响其他UI的绘制
+void KeyframeSetUI::UnbindInstances() {
+    for (int i = 0; i < 4; ++i) {
+        glVertexAttribDivisor(pose_location_ + i, 0);
+        glDisableVertexAttribArray(pose_location_ + i);
+    }
+    glVertexAttribDivisor(color_location_, 0);
+    glDisableVertexAttribArray(color_location_);
+}
+
+/**
+ * @brief 渲染函数，全部关键帧通过一次实例化绘制完成
+ *
+ */
+void KeyframeSetUI::Render() {
+    if (!IsValid())
+        return;
+
+    if (!program_init_)
+        InitProgram();
+    if (pose_location_ < 0 || color_location_ < 0)
+        return;
+
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    glLineWidth(line_width_);
+    program_.Bind();
+
+    vbo_.Bind();
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    BindInstances();
+
+    glDrawArraysInstanced(GL_LINES, 0, origin_points_.size(), pose_buffer_.Size());
+    CountDraw(GL_LINES, origin_points_.size(), pose_buffer_.Size());
+
+    UnbindInstances();
+    glDisableClientState(GL_VERTEX_ARRAY);
+    vbo_.Unbind();
+
+    program_.Unbind();
+    glLineWidth(1.0);
+    glPopMatrix();
+}
+
+/// 清理函数，编号从0重新分配，显存保留并在渲染线程下次更新时从头写入
+void KeyframeSetUI::Clear() {
+    size_.store(0);
+
+    KeyframeOp op;
+    op.reset_ = true;
+    pending_.Push(std::move(op));
+    MarkUpdate();
+}
+
+} // namespace slam_viewer
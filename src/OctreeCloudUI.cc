@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+#include "slam_viewer/core/Frustum.h"
+#include "slam_viewer/ui/OctreeCloudUI.hpp"
+
+namespace slam_viewer {
+
+/// 计算点所在的子节点索引
+static int ChildIndex(const Vec3 &center, const Vec3 &pt) {
+    return (pt.x() >= center.x()) | ((pt.y() >= center.y()) << 1) | ((pt.z() >= center.z()) << 2);
+}
+
+/**
+ * @brief 八叉树多层次细节点云UI的构造函数
+ *
+ * @param point_budget      输入的每帧渲染的点数预算
+ * @param gpu_point_budget  输入的显存中驻留的点数预算，超过后淘汰最久未渲染的节点
+ * @param min_node_pixels   输入的节点继续细分的最小屏幕投影半径（像素）
+ * @param min_half_size     输入的节点最小半边长，达到后叶子节点不再分裂
+ * @param color             输入的颜色
+ * @param line_width        输入的线宽
+ * @param point_size        输入的点大小
+ */
+OctreeCloudUI::OctreeCloudUI(std::size_t point_budget, std::size_t gpu_point_budget, float min_node_pixels,
+                             float min_half_size, Vec3 color, float line_width, float point_size)
+    : UIItem(color, line_width, point_size)
+    , min_half_size_(min_half_size)
+    , min_node_pixels_(min_node_pixels)
+    , point_budget_(point_budget)
+    , rendered_points_(0)
+    , gpu_point_budget_(gpu_point_budget)
+    , resident_points_(0)
+    , frame_id_(0) {}
+
+/**
+ * @brief 插入UI坐标系下的点，非渲染线程调用
+ * @details
+ *      节点的上传在渲染时按需进行，插入后只需要请求重绘
+ *
+ * @param cloud_xyz     输入的点的位置
+ * @param cloud_color   输入的点的颜色
+ */
+void OctreeCloudUI::InsertPoints(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color) {
+    Eigen::AlignedBox3f box;
+    for (const auto &pt : cloud_xyz)
+        box.extend(pt);
+
+    {
+        auto lock = ProducerLock();
+        GrowRoot(box);
+        for (std::size_t i = 0; i < cloud_xyz.size(); ++i)
+            InsertPoint(root_.get(), cloud_xyz[i], cloud_color[i]);
+    }
+    MarkRedraw();
+}
+
+/**
+ * @brief 扩展根节点，直到根节点包含box
+ * @details
+ *      每次扩展时新的根节点边长加倍并朝box的方向延伸，旧的根节点成为新根节点的子节点，
+ *      已有节点的指针和显存均保持不变
+ * @param box 输入的待插入点的包围盒
+ */
+void OctreeCloudUI::GrowRoot(const Eigen::AlignedBox3f &box) {
+    if (!root_) {
+        float half_size = min_half_size_;
+        while (half_size * 2 < box.sizes().maxCoeff())
+            half_size *= 2;
+        root_ = std::make_unique<Node>(box.center(), half_size);
+    }
+
+    auto contains = [&](const Node *node) {
+        Vec3 half(node->half_size_, node->half_size_, node->half_size_);
+        return Eigen::AlignedBox3f(node->center_ - half, node->center_ + half).contains(box);
+    };
+
+    while (!contains(root_.get())) {
+        Vec3 dir = (box.center().array() >= root_->center_.array()).select(Vec3::Ones(), -Vec3::Ones());
+        auto root = std::make_unique<Node>(root_->center_ + dir * root_->half_size_, root_->half_size_ * 2);
+        root->leaf_ = false;
+        root->occupied_.assign(kGridCells, false);
+
+        int index = ChildIndex(root->center_, root_->center_);
+        root->children_[index] = std::move(root_);
+        root_ = std::move(root);
+    }
+}
+
+/**
+ * @brief 从node开始向下插入一个点
+ * @details
+ *      1. 叶子节点直接保存点，超过kLeafPoints时分裂
+ *      2. 内部节点的采样网格对应格子为空时保存该点，作为该节点的粗粒度代表点
+ *      3. 否则下沉到对应的子节点，子节点不存在时创建
+ * @param node  输入的起始节点
+ * @param pt    输入的点的位置
+ * @param color 输入的点的颜色
+ */
+void OctreeCloudUI::InsertPoint(Node *node, const Vec3 &pt, const Vec4 &color) {
+    while (true) {
+        if (node->leaf_) {
+            node->xyz_.push_back(pt);
+            node->color_.push_back(color);
+            if (node->xyz_.size() > kLeafPoints && node->half_size_ > min_half_size_)
+                Split(node);
+            return;
+        }
+
+        Vec3 local = (pt - node->center_) / (2 * node->half_size_) + Vec3::Constant(0.5f);
+        Eigen::Vector3i cell = (local * kGridDim).cast<int>().cwiseMax(0).cwiseMin(kGridDim - 1);
+        int cell_id = (cell.z() * kGridDim + cell.y()) * kGridDim + cell.x();
+        if (!node->occupied_[cell_id]) {
+            node->occupied_[cell_id] = true;
+            node->xyz_.push_back(pt);
+            node->color_.push_back(color);
+            return;
+        }
+
+        int index = ChildIndex(node->center_, pt);
+        auto &child = node->children_[index];
+        if (!child) {
+            float half_size = node->half_size_ * 0.5f;
+            Vec3 dir((index & 1) ? 1 : -1, (index & 2) ? 1 : -1, (index & 4) ? 1 : -1);
+            child = std::make_unique<Node>(node->center_ + dir * half_size, half_size);
+        }
+        node = child.get();
+    }
+}
+
+/**
+ * @brief 叶子节点分裂为内部节点，节点的点被重新分配到采样网格和子节点中
+ *
+ * @param node 输入的待分裂的叶子节点
+ */
+void OctreeCloudUI::Split(Node *node) {
+    std::vector<Vec3> cloud_xyz;
+    std::vector<Vec4> cloud_color;
+    std::swap(cloud_xyz, node->xyz_);
+    std::swap(cloud_color, node->color_);
+
+    node->leaf_ = false;
+    node->need_reset_ = true;
+    node->occupied_.assign(kGridCells, false);
+    for (std::size_t i = 0; i < cloud_xyz.size(); ++i)
+        InsertPoint(node, cloud_xyz[i], cloud_color[i]);
+}
+
+/**
+ * @brief 将节点未上传的点拷贝到暂存区，渲染线程在持有mutex_时调用
+ * @details
+ *      节点被分裂过时从头拷贝并清除分裂标志，上传时先清空节点的显存
+ * @param node          输入的节点
+ * @return std::size_t  输出的拷贝的点数
+ */
+std::size_t OctreeCloudUI::StageNode(Node *node) {
+    bool reset = node->need_reset_;
+    node->need_reset_ = false;
+
+    std::size_t begin = reset ? 0 : node->xyz_buffer_.Size();
+    std::size_t num = node->xyz_.size() - begin;
+    if (num == 0 && !reset)
+        return 0;
+
+    staged_nodes_.push_back({node, reset, staged_xyz_.size(), num});
+    staged_xyz_.insert(staged_xyz_.end(), node->xyz_.begin() + begin, node->xyz_.end());
+    staged_color_.insert(staged_color_.end(), node->color_.begin() + begin, node->color_.end());
+    return num;
+}
+
+/**
+ * @brief 上传暂存区中的一个节点，渲染线程在释放mutex_后调用
+ *
+ * @param staged 输入的暂存区中的节点
+ */
+void OctreeCloudUI::UploadStaged(const StagedNode &staged) {
+    Node *node = staged.node_;
+    if (staged.reset_) {
+        resident_points_ -= node->xyz_buffer_.Size();
+        node->xyz_buffer_.Resize(0);
+        node->color_buffer_.Resize(0);
+    }
+    if (staged.num_ == 0)
+        return;
+
+    if (!node->xyz_buffer_.IsValid())
+        resident_nodes_.push_back(node);
+
+    node->xyz_buffer_.Append(staged_xyz_.data() + staged.offset_, staged.num_);
+    node->color_buffer_.Append(staged_color_.data() + staged.offset_, staged.num_);
+    resident_points_ += staged.num_;
+}
+
+/**
+ * @brief 显存中驻留的点数超过预算时，按最近渲染帧号淘汰节点，当前帧渲染的节点不淘汰
+ *
+ */
+void OctreeCloudUI::EvictNodes() {
+    if (resident_points_ <= gpu_point_budget_)
+        return;
+
+    std::sort(resident_nodes_.begin(), resident_nodes_.end(),
+              [](const Node *a, const Node *b) { return a->last_frame_ < b->last_frame_; });
+
+    std::size_t evicted = 0;
+    for (; evicted < resident_nodes_.size() && resident_points_ > gpu_point_budget_; ++evicted) {
+        Node *node = resident_nodes_[evicted];
+        if (node->last_frame_ == frame_id_)
+            break;
+
+        resident_points_ -= node->xyz_buffer_.Size();
+        node->xyz_buffer_.Free();
+        node->color_buffer_.Free();
+    }
+    resident_nodes_.erase(resident_nodes_.begin(), resident_nodes_.begin() + evicted);
+}
+
+/**
+ * @brief 渲染函数，渲染线程调用
+ * @details
+ *      1. 模型视图矩阵和投影矩阵来自View3D激活的Camera::RenderState()
+ *      2. 从根节点开始，按节点包围球的屏幕投影半径从大到小选择节点，直到达到点数预算
+ *      3. 不在视锥体内或投影半径小于min_node_pixels_的子节点不再细分
+ *      4. 被选中但未上传的节点按需上传，单帧上传量不超过kMaxUploadPoints
+ *      5. 只有节点选择和待上传点的拷贝持有mutex_，上传、绘制和显存淘汰均在锁外进行；
+ *         节点只会随Clear整棵树退役，退役的树由渲染线程释放，因此锁外访问选中的节点是安全的
+ *      6. 显存驻留点数超过预算时淘汰最久未渲染的节点，因此帧时间与地图规模无关
+ */
+void OctreeCloudUI::Render() {
+    Mat4 Twi;
+    std::vector<std::unique_ptr<Node>> retired_roots;
+    selected_nodes_.clear();
+    staged_nodes_.clear();
+    staged_xyz_.clear();
+    staged_color_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired_roots.swap(retired_roots_);
+        if (root_) {
+            Twi = Twi_.matrix();
+            SelectNodes(Twi);
+        }
+    }
+
+    if (!retired_roots.empty()) {
+        resident_nodes_.clear();
+        resident_points_ = 0;
+        retired_roots.clear();
+    }
+
+    if (selected_nodes_.empty() && staged_nodes_.empty())
+        return;
+    ++frame_id_;
+
+    for (const auto &staged : staged_nodes_)
+        UploadStaged(staged);
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+
+    std::size_t rendered_points = 0;
+    glPointSize(point_size_);
+    for (Node *node : selected_nodes_) {
+        node->last_frame_ = frame_id_;
+        rendered_points += node->xyz_buffer_.Size();
+        RenderBuffer(node->xyz_buffer_, &node->color_buffer_, GL_POINTS, 0, node->xyz_buffer_.Size());
+    }
+    glPointSize(1.0);
+    glPopMatrix();
+
+    rendered_points_.store(rendered_points);
+    EvictNodes();
+}
+
+/**
+ * @brief 选择本帧渲染的节点，并将其中待上传的点拷贝到暂存区，渲染线程在持有mutex_时调用
+ * @details
+ *      节点按屏幕投影半径从大到小出队，点数超过预算时停止；选中的节点在上传后显存非空，
+ *      上传预算用尽时，显存中已有点且未被分裂过的节点仍以其已上传的点绘制
+ * @param Twi 输入的UI在世界坐标系下的位姿矩阵
+ */
+void OctreeCloudUI::SelectNodes(const Mat4 &Twi) {
+    Mat4 proj, model_view;
+    GLint viewport[4];
+    glGetFloatv(GL_PROJECTION_MATRIX, proj.data());
+    glGetFloatv(GL_MODELVIEW_MATRIX, model_view.data());
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    model_view = model_view * Twi;
+
+    Frustum frustum(proj * model_view);
+    const float pixel_scale = proj(1, 1) * viewport[3] * 0.5f;
+    const float sqrt3 = std::sqrt(3.0f);
+
+    /// 节点包围球的屏幕投影半径，包围球包含相机时视为无穷大
+    auto screen_size = [&](const Node *node) {
+        float radius = node->half_size_ * sqrt3;
+        float depth = -(model_view * node->center_.homogeneous()).z();
+        if (depth <= radius)
+            return std::numeric_limits<float>::max();
+        return radius / depth * pixel_scale;
+    };
+
+    typedef std::pair<float, Node *> NodeItem;
+    std::priority_queue<NodeItem> queue;
+    if (frustum.Intersects(root_->center_, root_->half_size_ * sqrt3))
+        queue.push({screen_size(root_.get()), root_.get()});
+
+    std::size_t budget = point_budget_.load();
+    std::size_t upload_budget = kMaxUploadPoints;
+    while (!queue.empty()) {
+        Node *node = queue.top().second;
+        queue.pop();
+
+        std::size_t num = node->xyz_.size();
+        if (num > budget)
+            break;
+        budget -= num;
+
+        std::size_t gpu_num = node->need_reset_ ? 0 : node->xyz_buffer_.Size();
+        if (upload_budget > 0 && gpu_num < num) {
+            std::size_t staged = StageNode(node);
+            upload_budget -= std::min(staged, upload_budget);
+            gpu_num = num;
+        }
+
+        if (gpu_num > 0)
+            selected_nodes_.push_back(node);
+
+        for (const auto &child : node->children_) {
+            if (!child || !frustum.Intersects(child->center_, child->half_size_ * sqrt3))
+                continue;
+
+            float size = screen_size(child.get());
+            if (size >= min_node_pixels_)
+                queue.push({size, child.get()});
+        }
+    }
+}
+
+/// 清理函数，节点的显存在渲染线程中随节点释放，请求重绘使退役的树在下一帧被释放
+void OctreeCloudUI::Clear() {
+    {
+        auto lock = ProducerLock();
+        if (root_)
+            retired_roots_.push_back(std::move(root_));
+    }
+    MarkRedraw();
+}
+
+/**
+ * @brief 重置八叉树点云在世界坐标系下的位姿
+ * @details
+ *      八叉树在点云坐标系下划分，位姿变化不需要重建；下一帧按新的模型矩阵计算节点的屏幕尺寸，
+ *      节点选择随之变化，因此需要请求重绘
+ * @param Twi 输入的新的位姿
+ */
+void OctreeCloudUI::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
+}
+
+} // namespace slam_viewer
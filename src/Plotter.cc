@@ -15,6 +15,23 @@ void Plotter::UpdatePlotterItem(const std::string &plot_name, const std::vector<
         return;
 
     plotter_items_[plot_name]->Update(data);
+    RequestRedraw();
+}
+
+/**
+ * @brief 渲染线程调用，记录绘图数据但不请求重绘
+ * @details
+ *      用于记录渲染过程自身产生的数据，如每帧的渲染统计；若像UpdatePlotterItem一样请求重绘，
+ *      每一帧都会触发下一帧，按需重绘退化为持续重绘
+ * @param plot_name 输入的绘图元素名称
+ * @param data      输入的数据
+ */
+void Plotter::LogPlotterItem(const std::string &plot_name, const std::vector<float> &data) {
+    auto iter = plotter_items_.find(plot_name);
+    if (iter == plotter_items_.end())
+        return;
+
+    iter->second->Update(data);
 }
 
 /// 创建绘图元素
@@ -0,0 +1,266 @@
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "slam_viewer/ui/PoseGraphUI.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 位姿图UI的构造函数，构造时不创建OpenGL资源
+ *
+ * @param node_color    输入的节点颜色
+ * @param odom_color    输入的里程计边颜色
+ * @param loop_color    输入的回环边颜色
+ * @param line_width    输入的边的线宽
+ * @param point_size    输入的节点大小
+ * @param Twi           输入的位姿图在世界坐标系下的位姿，作为模型矩阵在渲染时作用
+ */
+PoseGraphUI::PoseGraphUI(Vec3 node_color, Vec3 odom_color, Vec3 loop_color, float line_width, float point_size,
+                         SE3 Twi)
+    : UIItem(node_color, line_width, point_size, Twi)
+    , dirty_begin_(0)
+    , dirty_end_(0)
+    , uploaded_odom_(0)
+    , uploaded_loop_(0)
+    , need_reset_(false)
+    , odom_color_(odom_color)
+    , loop_color_(loop_color)
+    , xyz_buffer_(GL_FLOAT, 3)
+    , odom_buffer_(GL_UNSIGNED_INT, 1, pangolin::GlElementArrayBuffer)
+    , loop_buffer_(GL_UNSIGNED_INT, 1, pangolin::GlElementArrayBuffer) {}
+
+/**
+ * @brief 添加节点，节点位置被变换到位姿图坐标系下存储
+ *
+ * @param Twc           输入的世界坐标系下的节点位姿
+ * @return std::size_t  输出的节点编号
+ */
+std::size_t PoseGraphUI::AddNode(const SE3 &Twc) {
+    std::size_t id = 0;
+    {
+        auto lock = ProducerLock();
+        id = positions_.size();
+        positions_.push_back(Twi_.inverse() * Twc.translation());
+
+        if (dirty_begin_ >= dirty_end_)
+            dirty_begin_ = id;
+        dirty_end_ = id + 1;
+    }
+
+    MarkUpdate();
+    return id;
+}
+
+/**
+ * @brief 添加边，只保存两个端点的节点编号
+ *
+ * @param from      输入的起点编号
+ * @param to        输入的终点编号
+ * @param type      输入的边的类型
+ * @return true     添加成功
+ * @return false    节点编号无效
+ */
+bool PoseGraphUI::AddEdge(std::size_t from, std::size_t to, EdgeType type) {
+    {
+        auto lock = ProducerLock();
+        if (from >= positions_.size() || to >= positions_.size())
+            return false;
+
+        auto &edges = type == EdgeType::Loop ? loop_edges_ : odom_edges_;
+        edges.push_back(static_cast<GLuint>(from));
+        edges.push_back(static_cast<GLuint>(to));
+    }
+
+    MarkUpdate();
+    return true;
+}
+
+/**
+ * @brief 批量更新节点位姿
+ * @details
+ *      1. 节点位置在锁外并行变换到位姿图坐标系下
+ *      2. 更新全部节点时直接交换位置数组，锁内代价为O(1)，边的端点通过索引自动跟随
+ *      3. 渲染线程只上传一次[0, num)区间的节点位置
+ * @param poses     输入的世界坐标系下的节点位姿
+ * @param num       输入的位姿数量
+ * @return true     更新成功
+ * @return false    位姿数量超过节点数量
+ */
+bool PoseGraphUI::UpdatePoses(const SE3 *poses, std::size_t num) {
+    if (num == 0)
+        return true;
+
+    SE3 Tiw;
+    {
+        auto lock = ProducerLock();
+        Tiw = Twi_.inverse();
+    }
+
+    std::vector<Vec3> positions(num);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, num), [&](const tbb::blocked_range<std::size_t> &range) {
+        for (std::size_t id = range.begin(); id != range.end(); ++id)
+            positions[id] = Tiw * poses[id].translation();
+    });
+
+    {
+        auto lock = ProducerLock();
+        if (num > positions_.size())
+            return false;
+
+        if (num == positions_.size())
+            positions_.swap(positions);
+        else
+            std::copy(positions.begin(), positions.end(), positions_.begin());
+
+        dirty_end_ = dirty_begin_ < dirty_end_ ? std::max(dirty_end_, num) : num;
+        dirty_begin_ = 0;
+    }
+
+    MarkUpdate();
+    return true;
+}
+
+/// 节点数量
+std::size_t PoseGraphUI::Size() {
+    auto lock = ProducerLock();
+    return positions_.size();
+}
+
+/**
+ * @brief 更新函数，渲染线程调用
+ * @details
+ *      1. 锁内只拷贝变化的节点位置区间和新增的边，上传在锁外进行
+ *      2. 变化的区间覆盖全部节点时（如回环后的批量更新）重新计算包围盒，否则扩展包围盒
+ */
+void PoseGraphUI::Update() {
+    if (!ConsumeUpdate())
+        return;
+
+    std::vector<Vec3> xyz;
+    std::vector<GLuint> odom_edges, loop_edges;
+    std::size_t xyz_begin = 0, odom_begin = 0, loop_begin = 0, node_num = 0;
+    bool need_reset = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        need_reset = need_reset_;
+        need_reset_ = false;
+        node_num = positions_.size();
+
+        if (dirty_begin_ < dirty_end_) {
+            xyz_begin = dirty_begin_;
+            xyz.assign(positions_.begin() + dirty_begin_, positions_.begin() + dirty_end_);
+        }
+        dirty_begin_ = dirty_end_ = 0;
+
+        odom_begin = uploaded_odom_;
+        odom_edges.assign(odom_edges_.begin() + uploaded_odom_, odom_edges_.end());
+        uploaded_odom_ = odom_edges_.size();
+
+        loop_begin = uploaded_loop_;
+        loop_edges.assign(loop_edges_.begin() + uploaded_loop_, loop_edges_.end());
+        uploaded_loop_ = loop_edges_.size();
+    }
+
+    if (need_reset) {
+        xyz_buffer_.Resize(0);
+        odom_buffer_.Resize(0);
+        loop_buffer_.Resize(0);
+    }
+
+    Eigen::AlignedBox3f box;
+    for (const auto &pt : xyz)
+        box.extend(pt);
+    if (need_reset || (xyz_begin == 0 && xyz.size() == node_num))
+        SetLocalBounds(box);
+    else
+        ExtendLocalBounds(box);
+
+    xyz_buffer_.Upload(xyz.data(), xyz_begin, xyz.size());
+    odom_buffer_.Upload(odom_edges.data(), odom_begin, odom_edges.size());
+    loop_buffer_.Upload(loop_edges.data(), loop_begin, loop_edges.size());
+}
+
+/**
+ * @brief 以节点位置为顶点数组，绘制索引缓冲区中的边，仅渲染线程调用
+ *
+ * @param edge_buffer   输入的边索引缓冲区
+ * @param color         输入的边颜色
+ */
+void PoseGraphUI::DrawEdges(const DynamicBuffer &edge_buffer, const Vec3 &color) {
+    if (edge_buffer.Size() == 0)
+        return;
+
+    glColor3f(color[0], color[1], color[2]);
+    xyz_buffer_.Bind();
+    glVertexPointer(3, GL_FLOAT, 0, nullptr);
+    glEnableClientState(GL_VERTEX_ARRAY);
+
+    edge_buffer.Bind();
+    glDrawElements(GL_LINES, edge_buffer.Size(), GL_UNSIGNED_INT, nullptr);
+    CountDraw(GL_LINES, edge_buffer.Size());
+    edge_buffer.Unbind();
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    xyz_buffer_.Unbind();
+}
+
+/**
+ * @brief 渲染函数，位姿图在自身坐标系下存储，Twi_作为模型矩阵在渲染时作用
+ *
+ */
+void PoseGraphUI::Render() {
+    if (!IsValid())
+        return;
+
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+
+    glLineWidth(line_width_);
+    DrawEdges(odom_buffer_, odom_color_);
+    DrawEdges(loop_buffer_, loop_color_);
+    glLineWidth(1.0);
+
+    glPointSize(point_size_);
+    glColor3f(color_[0], color_[1], color_[2]);
+    RenderBuffer(xyz_buffer_, nullptr, GL_POINTS, 0, xyz_buffer_.Size());
+    glPointSize(1.0);
+
+    glPopMatrix();
+}
+
+/// 清理函数，删除全部节点和边，显存保留并在渲染线程下次更新时从头写入
+void PoseGraphUI::Clear() {
+    {
+        auto lock = ProducerLock();
+        positions_.clear();
+        odom_edges_.clear();
+        loop_edges_.clear();
+        dirty_begin_ = dirty_end_ = 0;
+        uploaded_odom_ = uploaded_loop_ = 0;
+        need_reset_ = true;
+    }
+    MarkUpdate();
+}
+
+/**
+ * @brief 重置位姿图在世界坐标系下的位姿
+ * @details
+ *      节点位置在位姿图坐标系下存储，边按节点编号索引，位姿变化只替换模型矩阵；
+ *      之后UpdatePoses传入的世界位姿按新的Twi_变换到位姿图坐标系
+ * @param Twi 输入的新的位姿
+ */
+void PoseGraphUI::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
+}
+
+} // namespace slam_viewer
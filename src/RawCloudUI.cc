@@ -0,0 +1,155 @@
+#include "slam_viewer/core/Frustum.h"
+#include "slam_viewer/ui/RawCloudUI.hpp"
+
+namespace slam_viewer {
+
+/**
+ * @brief 更新函数，渲染线程调用
+ * @details
+ *      点云内存原样追加到显存尾部，不经过中间的位置和颜色数组，上传完成后释放对点云的持有；
+ *      上传前按照步长遍历一次位置字段得到各段的包围盒
+ */
+void RawCloudUI::Update() {
+    if (!ConsumeUpdate())
+        return;
+
+    std::vector<PendingCloud, Eigen::aligned_allocator<PendingCloud>> pending_clouds;
+    bool need_reset;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(pending_clouds, pending_clouds_);
+        need_reset = need_reset_;
+        need_reset_ = false;
+    }
+
+    if (need_reset) {
+        buffer_.Resize(0);
+        segments_.clear();
+        SetLocalBounds(Eigen::AlignedBox3f());
+    }
+
+    for (auto &pending : pending_clouds) {
+        Segment segment = pending.segment_;
+        segment.box_ = TransformBox(ComputeBox(pending.data_, segment.count_, segment.layout_), segment.Tij_);
+        ExtendLocalBounds(segment.box_);
+        segment.offset_ = buffer_.Size();
+        buffer_.Append(pending.data_, segment.count_ * segment.layout_.stride_);
+        segments_.push_back(segment);
+    }
+}
+
+/**
+ * @brief 按照内存布局计算一段点云在点云坐标系下的包围盒，仅渲染线程调用
+ *
+ * @param data                  输入的点云内存
+ * @param count                 输入的点数量
+ * @param layout                输入的内存布局
+ * @return Eigen::AlignedBox3f  输出的包围盒
+ */
+Eigen::AlignedBox3f RawCloudUI::ComputeBox(const void *data, std::size_t count, const Layout &layout) {
+    Eigen::AlignedBox3f box;
+    const auto *bytes = static_cast<const std::uint8_t *>(data) + layout.xyz_offset_;
+    for (std::size_t i = 0; i < count; ++i) {
+        Eigen::Map<const Vec3> pt(reinterpret_cast<const float *>(bytes + i * layout.stride_));
+        if (pt.allFinite())
+            box.extend(pt);
+    }
+    return box;
+}
+
+/**
+ * @brief 按照内存布局绑定顶点和颜色属性并绘制一段点云，仅渲染线程调用
+ *
+ * @param segment   输入的点云段
+ * @param Twi       输入的UI在世界坐标系下的位姿，标量颜色映射计算高度时使用
+ * @param color_map 输入的GPU颜色映射，可以为nullptr
+ */
+void RawCloudUI::DrawSegment(const Segment &segment, const Mat4 &Twi, const ColorMap::Ptr &color_map) {
+    const Layout &layout = segment.layout_;
+    auto pointer = [&](std::size_t offset) { return reinterpret_cast<const void *>(segment.offset_ + offset); };
+
+    bool use_color_map = layout.source_ == ColorSource::Scalar && color_map;
+    if (use_color_map) {
+        color_map->Bind();
+        color_map->SetModel(Twi * segment.Tij_);
+        color_map->BindScalar(buffer_, layout.color_type_, layout.stride_, segment.offset_ + layout.color_offset_);
+    }
+
+    buffer_.Bind();
+    if (layout.source_ == ColorSource::Rgb) {
+        glColorPointer(GL_BGRA, GL_UNSIGNED_BYTE, layout.stride_, pointer(layout.color_offset_));
+        glEnableClientState(GL_COLOR_ARRAY);
+    } else if (!use_color_map)
+        glColor3f(color_[0], color_[1], color_[2]);
+
+    glVertexPointer(3, GL_FLOAT, layout.stride_, pointer(layout.xyz_offset_));
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glDrawArrays(GL_POINTS, 0, segment.count_);
+    CountDraw(GL_POINTS, segment.count_);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    if (use_color_map) {
+        color_map->UnbindScalar();
+        color_map->Unbind();
+    } else if (layout.source_ == ColorSource::Rgb)
+        glDisableClientState(GL_COLOR_ARRAY);
+    buffer_.Unbind();
+}
+
+/**
+ * @brief 渲染函数，每段点云以自身位姿作为模型矩阵绘制，在UI坐标系中与视锥体求交，跳过视野外的段
+ * @details
+ *      只在拷贝位姿和颜色映射时持有mutex_，显存和分段仅由渲染线程访问，绘制期间生产者不会被阻塞
+ */
+void RawCloudUI::Render() {
+    if (!IsValid())
+        return;
+
+    Mat4 Twi;
+    ColorMap::Ptr color_map;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+        color_map = color_map_;
+    }
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    glPointSize(point_size_);
+    Frustum frustum = Frustum::FromGlState();
+    for (const auto &segment : segments_) {
+        if (!frustum.Intersects(segment.box_))
+            continue;
+
+        glPushMatrix();
+        glMultMatrixf(segment.Tij_.data());
+        DrawSegment(segment, Twi, color_map);
+        glPopMatrix();
+    }
+    glPointSize(1.0);
+    glPopMatrix();
+}
+
+/// 清理函数，显存保留，下次更新时从头写入
+void RawCloudUI::Clear() {
+    auto lock = ProducerLock();
+    pending_clouds_.clear();
+    need_reset_ = true;
+    MarkUpdate();
+}
+
+/**
+ * @brief 重置原始点云在世界坐标系下的位姿
+ * @details
+ *      每段点云记录相对UI坐标系的Tij，位姿变化只替换各段共用的模型矩阵，显存中的PCL点不需要重新上传
+ * @param Twi 输入的新的位姿
+ */
+void RawCloudUI::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
+}
+
+} // namespace slam_viewer
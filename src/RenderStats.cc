@@ -0,0 +1,61 @@
+#include "slam_viewer/core/RenderStats.h"
+
+namespace slam_viewer {
+
+static std::atomic<std::uint64_t> global_wait_ns(0);       ///< 全部LockProfiler的生产者累计等待纳秒数
+static std::atomic<std::uint64_t> global_contended_num(0); ///< 全部LockProfiler的生产者竞争次数
+
+/// 由累计纳秒数和竞争次数得到等待统计
+static LockStats MakeLockStats(std::uint64_t wait_ns, std::uint64_t contended_num) {
+    LockStats stats;
+    stats.producer_wait_ms_ = wait_ns * 1e-6;
+    stats.producer_contended_num_ = contended_num;
+    return stats;
+}
+
+/**
+ * @brief 对mutex加锁，任意线程调用
+ * @details
+ *      try_lock失败说明发生竞争，此时才读取时钟；只统计非渲染线程的等待，即生产者被渲染线程或其他生产者阻塞的时间
+ * @param mutex                         输入的互斥量
+ * @return std::unique_lock<std::mutex> 输出的持有锁的unique_lock
+ */
+std::unique_lock<std::mutex> LockProfiler::Lock(std::mutex &mutex) {
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (lock.owns_lock())
+        return lock;
+
+    if (ThreadRenderCounters().render_thread_) {
+        lock.lock();
+        return lock;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    wait_ns_.fetch_add(wait.count(), std::memory_order_relaxed);
+    contended_num_.fetch_add(1, std::memory_order_relaxed);
+    global_wait_ns.fetch_add(wait.count(), std::memory_order_relaxed);
+    global_contended_num.fetch_add(1, std::memory_order_relaxed);
+    return lock;
+}
+
+/// 该统计器的生产者等待统计
+LockStats LockProfiler::Stats() const { return MakeLockStats(wait_ns_.load(), contended_num_.load()); }
+
+/// 全部LockProfiler的生产者等待统计
+LockStats LockProfiler::GlobalStats() { return MakeLockStats(global_wait_ns.load(), global_contended_num.load()); }
+
+/// 绘图的标签
+std::vector<std::string> FrameStats::PlotLabels() {
+    return {"render_ms", "draw_calls", "points_k", "upload_kb", "lock_wait_ms"};
+}
+
+/// 绘图的数据
+std::vector<float> FrameStats::PlotValues() const {
+    return {static_cast<float>(render_ms_), static_cast<float>(draw_calls_), static_cast<float>(points_ * 1e-3),
+            static_cast<float>(upload_bytes_ / 1024.0), static_cast<float>(producer_wait_ms_)};
+}
+
+} // namespace slam_viewer
@@ -0,0 +1,182 @@
+#include "slam_viewer/ui/ScanWindowUI.hpp"
+
+namespace slam_viewer {
+
+/**
+ * @brief 滑动窗口点云UI的构造函数
+ *
+ * @param max_scans     输入的窗口内最大扫描数量，为0时不限制
+ * @param max_duration  输入的窗口最大时间跨度，小于等于0时不限制
+ * @param max_points    输入的环形缓冲区容量（点数），决定了显存占用
+ * @param color         输入的颜色
+ * @param line_width    输入的线宽
+ * @param point_size    输入的点大小
+ */
+ScanWindowUI::ScanWindowUI(std::size_t max_scans, double max_duration, std::size_t max_points, Vec3 color,
+                           float line_width, float point_size)
+    : UIItem(color, line_width, point_size)
+    , xyz_buffer_(GL_FLOAT, 3)
+    , color_buffer_(GL_FLOAT, 4)
+    , pending_points_(0)
+    , need_reset_(false)
+    , head_(0)
+    , used_points_(0)
+    , max_scans_(max_scans)
+    , max_duration_(max_duration)
+    , max_points_(max_points) {}
+
+/**
+ * @brief 更新窗口，渲染线程调用
+ * @details
+ *      1. 首次更新时一次性分配max_points_大小的显存，之后不再扩容
+ *      2. 将等待上传的扫描依次写入环形缓冲区，只上传该扫描所在的子区间
+ */
+void ScanWindowUI::Update() {
+    if (!ConsumeUpdate())
+        return;
+
+    std::deque<PendingScan> pending_scans;
+    bool need_reset;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(pending_scans, pending_scans_);
+        pending_points_ = 0;
+        need_reset = need_reset_;
+        need_reset_ = false;
+    }
+
+    if (need_reset) {
+        scans_.clear();
+        head_ = 0;
+        used_points_ = 0;
+    }
+
+    xyz_buffer_.Reserve(max_points_);
+    color_buffer_.Reserve(max_points_);
+
+    for (const auto &scan : pending_scans)
+        WriteScan(scan);
+}
+
+/**
+ * @brief 淘汰最旧的待上传扫描，生产者在持有mutex_时调用
+ * @details
+ *      与WriteScan的淘汰规则一致，时间跨度以最新的扫描为准；最新的扫描总是保留，
+ *      因此ui_item不可见、Update长时间不运行时，待上传的扫描也不会无限增长
+ */
+void ScanWindowUI::TrimPending() {
+    while (pending_scans_.size() > 1) {
+        const auto &oldest = pending_scans_.front();
+        bool over_count = max_scans_ > 0 && pending_scans_.size() > max_scans_;
+        bool over_time = max_duration_ > 0 && pending_scans_.back().stamp_ - oldest.stamp_ > max_duration_;
+        bool over_space = pending_points_ > max_points_;
+        if (!over_count && !over_time && !over_space)
+            break;
+
+        pending_points_ -= oldest.xyz_.size();
+        pending_scans_.pop_front();
+    }
+}
+
+/**
+ * @brief 将一帧扫描写入环形缓冲区
+ * @details
+ *      1. 按照扫描数量和时间跨度淘汰最旧的扫描
+ *      2. 空间不足时继续淘汰最旧的扫描，新扫描原地覆盖其所在位置
+ *      3. 超过缓冲区容量的扫描只保留前max_points_个点
+ * @param scan 输入的待写入的扫描
+ */
+void ScanWindowUI::WriteScan(const PendingScan &scan) {
+    std::size_t num = std::min(scan.xyz_.size(), max_points_);
+    if (num == 0)
+        return;
+
+    while (!scans_.empty()) {
+        const auto &oldest = scans_.front();
+        bool over_count = max_scans_ > 0 && scans_.size() >= max_scans_;
+        bool over_time = max_duration_ > 0 && scan.stamp_ - oldest.stamp_ > max_duration_;
+        bool over_space = used_points_ + num > max_points_;
+        if (!over_count && !over_time && !over_space)
+            break;
+
+        used_points_ -= oldest.size_;
+        scans_.pop_front();
+    }
+
+    if (scans_.empty())
+        head_ = 0;
+
+    WriteRing(scan, head_, num);
+    scans_.push_back({head_, num, scan.stamp_});
+    head_ = (head_ + num) % max_points_;
+    used_points_ += num;
+}
+
+/**
+ * @brief 将扫描数据写入环形缓冲区的[offset, offset + num)，越过缓冲区尾部时分两段上传
+ *
+ * @param scan      输入的扫描
+ * @param offset    输入的写入位置
+ * @param num       输入的写入点数
+ */
+void ScanWindowUI::WriteRing(const PendingScan &scan, std::size_t offset, std::size_t num) {
+    std::size_t first = std::min(num, max_points_ - offset);
+    xyz_buffer_.Upload(scan.xyz_.data(), offset, first);
+    color_buffer_.Upload(scan.color_.data(), offset, first);
+
+    if (num > first) {
+        xyz_buffer_.Upload(scan.xyz_.data() + first, 0, num - first);
+        color_buffer_.Upload(scan.color_.data() + first, 0, num - first);
+    }
+}
+
+/**
+ * @brief 渲染窗口内的扫描，有效区间越过缓冲区尾部时分两段绘制
+ *
+ */
+void ScanWindowUI::Render() {
+    if (!IsValid() || scans_.empty())
+        return;
+
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+
+    std::size_t start = scans_.front().offset_;
+    std::size_t first = std::min(used_points_, max_points_ - start);
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    glPointSize(point_size_);
+    RenderBuffer(xyz_buffer_, &color_buffer_, GL_POINTS, start, first);
+    RenderBuffer(xyz_buffer_, &color_buffer_, GL_POINTS, 0, used_points_ - first);
+    glPointSize(1.0);
+    glPopMatrix();
+}
+
+/// 清理函数，显存大小固定，不释放，仅在下次更新时清空窗口
+void ScanWindowUI::Clear() {
+    auto lock = ProducerLock();
+    pending_scans_.clear();
+    pending_points_ = 0;
+    need_reset_ = true;
+    MarkUpdate();
+}
+
+/**
+ * @brief 重置扫描窗口在世界坐标系下的位姿
+ * @details
+ *      环形缓冲区中的扫描在添加时已经变换到窗口坐标系，位姿变化只替换模型矩阵，不改写环形缓冲区
+ * @param Twi 输入的新的位姿
+ */
+void ScanWindowUI::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
+}
+
+} // namespace slam_viewer
@@ -0,0 +1,328 @@
+#include "slam_viewer/ui/StampedTrajectoryUI.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 带时间戳的轨迹UI的构造函数，构造时不创建OpenGL资源
+ *
+ * @param color         输入的固定颜色，未设置颜色映射时使用
+ * @param line_width    输入的线宽
+ * @param point_size    输入的点大小
+ */
+StampedTrajectoryUI::StampedTrajectoryUI(Vec3 color, float line_width, float point_size)
+    : UIItem(color, line_width, point_size)
+    , uploaded_(0)
+    , dirty_begin_(0)
+    , dirty_end_(0)
+    , need_reset_(false)
+    , color_channel_(ColorChannel::None)
+    , xyz_buffer_(GL_FLOAT, 3)
+    , scalar_buffer_(GL_FLOAT, kChannels) {}
+
+/// 析构函数，注销在ColorMap上注册的重绘回调
+StampedTrajectoryUI::~StampedTrajectoryUI() {
+    if (ColorMap::Ptr color_map = std::atomic_load(&color_map_))
+        color_map->RemoveListener(this);
+}
+
+/**
+ * @brief 添加位姿，位姿被变换到轨迹坐标系下按列存储，速度由与上一个位姿的位置差和时间差计算
+ *
+ * @param stamp         输入的时间戳
+ * @param Twc           输入的世界坐标系下的位姿
+ * @param error         输入的位姿误差
+ * @param covariance    输入的位姿协方差的标量度量
+ * @return true         添加成功
+ * @return false        时间戳不是严格递增的
+ */
+bool StampedTrajectoryUI::AddPose(double stamp, const SE3 &Twc, float error, float covariance) {
+    {
+        auto lock = ProducerLock();
+        if (!stamps_.empty() && stamp <= stamps_.back())
+            return false;
+
+        SE3 Tic = Twi_.inverse() * Twc;
+        float speed = 0.f;
+        if (!stamps_.empty())
+            speed = (Tic.translation() - positions_.back()).norm() / (stamp - stamps_.back());
+
+        stamps_.push_back(stamp);
+        positions_.push_back(Tic.translation());
+        rotations_.push_back(Tic.unit_quaternion());
+        scalars_.insert(scalars_.end(), {speed, error, covariance});
+    }
+
+    MarkUpdate();
+    return true;
+}
+
+/**
+ * @brief 设置第id个位姿的误差或协方差标量，只标记被修改的区间，在渲染线程下次更新时上传
+ *
+ * @param channel   输入的着色通道，速度由轨迹计算，不能设置
+ * @param id        输入的位姿编号
+ * @param value     输入的标量
+ * @return true     设置成功
+ * @return false    编号或通道无效
+ */
+bool StampedTrajectoryUI::SetScalar(ColorChannel channel, std::size_t id, float value) {
+    if (channel != ColorChannel::Error && channel != ColorChannel::Covariance)
+        return false;
+
+    {
+        auto lock = ProducerLock();
+        if (id >= stamps_.size())
+            return false;
+
+        scalars_[id * kChannels + static_cast<int>(channel) - 1] = value;
+        MarkDirtyScalars(id, id + 1);
+    }
+
+    MarkUpdate();
+    return true;
+}
+
+/**
+ * @brief 批量设置误差或协方差标量，用于对齐变化后一次性刷新整条轨迹的误差着色
+ *
+ * @param channel   输入的着色通道，速度由轨迹计算，不能设置
+ * @param begin     输入的第一个位姿编号
+ * @param values    输入的标量
+ * @return true     设置成功
+ * @return false    起始编号或通道无效
+ */
+bool StampedTrajectoryUI::SetScalars(ColorChannel channel, std::size_t begin, const std::vector<float> &values) {
+    if (channel != ColorChannel::Error && channel != ColorChannel::Covariance)
+        return false;
+
+    {
+        auto lock = ProducerLock();
+        if (begin >= stamps_.size())
+            return false;
+
+        std::size_t end = std::min(stamps_.size(), begin + values.size());
+        int offset = static_cast<int>(channel) - 1;
+        for (std::size_t id = begin; id < end; ++id)
+            scalars_[id * kChannels + offset] = values[id - begin];
+        MarkDirtyScalars(begin, end);
+    }
+
+    MarkUpdate();
+    return true;
+}
+
+/// 扩展需要重新上传标量的区间，尚未上传的位姿会随新位姿一起上传，不需要标记，需持有mutex_
+void StampedTrajectoryUI::MarkDirtyScalars(std::size_t begin, std::size_t end) {
+    end = std::min(end, uploaded_);
+    if (begin >= end)
+        return;
+
+    if (dirty_begin_ >= dirty_end_) {
+        dirty_begin_ = begin;
+        dirty_end_ = end;
+    } else {
+        dirty_begin_ = std::min(dirty_begin_, begin);
+        dirty_end_ = std::max(dirty_end_, end);
+    }
+}
+
+/// 时间戳不小于stamp的第一个位姿，二分查找，需持有mutex_
+std::size_t StampedTrajectoryUI::LowerBound(double stamp) const {
+    return std::lower_bound(stamps_.begin(), stamps_.end(), stamp) - stamps_.begin();
+}
+
+/**
+ * @brief 插值得到stamp时刻的位姿，旋转球面线性插值，平移线性插值
+ *
+ * @param stamp     输入的查询时间戳
+ * @param Twc       输出的世界坐标系下的位姿
+ * @return true     插值成功
+ * @return false    stamp超出轨迹的时间范围
+ */
+bool StampedTrajectoryUI::Interpolate(double stamp, SE3 &Twc) {
+    auto lock = ProducerLock();
+    if (stamps_.empty() || stamp < stamps_.front() || stamp > stamps_.back())
+        return false;
+
+    std::size_t id = LowerBound(stamp);
+    if (stamps_[id] == stamp) {
+        Twc = Twi_ * LocalPose(id);
+        return true;
+    }
+
+    float t = (stamp - stamps_[id - 1]) / (stamps_[id] - stamps_[id - 1]);
+    Eigen::Quaternionf q = rotations_[id - 1].slerp(t, rotations_[id]);
+    Vec3 p = positions_[id - 1] + t * (positions_[id] - positions_[id - 1]);
+    Twc = Twi_ * SE3(q, p);
+    return true;
+}
+
+/**
+ * @brief 获取最新的位姿
+ *
+ * @param stamp     输出的最新位姿的时间戳
+ * @param Twc       输出的世界坐标系下的最新位姿
+ * @return true     获取成功
+ * @return false    轨迹为空
+ */
+bool StampedTrajectoryUI::GetLatest(double &stamp, SE3 &Twc) {
+    auto lock = ProducerLock();
+    if (stamps_.empty())
+        return false;
+
+    stamp = stamps_.back();
+    Twc = Twi_ * LocalPose(stamps_.size() - 1);
+    return true;
+}
+
+/**
+ * @brief 获取时间戳在[begin, end]范围内的位姿，区间起点通过二分查找确定
+ *
+ * @param begin         输入的起始时间戳
+ * @param end           输入的终止时间戳
+ * @param stamps        输出的时间戳
+ * @param poses         输出的世界坐标系下的位姿
+ * @return std::size_t  输出的位姿数量
+ */
+std::size_t StampedTrajectoryUI::QueryRange(double begin, double end, std::vector<double> &stamps,
+                                            std::vector<SE3> &poses) {
+    stamps.clear();
+    poses.clear();
+
+    auto lock = ProducerLock();
+    for (std::size_t id = LowerBound(begin); id < stamps_.size() && stamps_[id] <= end; ++id) {
+        stamps.push_back(stamps_[id]);
+        poses.push_back(Twi_ * LocalPose(id));
+    }
+    return stamps.size();
+}
+
+/// 位姿数量
+std::size_t StampedTrajectoryUI::Size() {
+    auto lock = ProducerLock();
+    return stamps_.size();
+}
+
+/**
+ * @brief 更新函数，渲染线程调用
+ * @details
+ *      锁内只拷贝新位姿的位置和标量以及被修改的标量区间，上传在锁外进行
+ */
+void StampedTrajectoryUI::Update() {
+    if (!ConsumeUpdate())
+        return;
+
+    std::vector<Vec3> xyz;
+    std::vector<float> scalars, dirty_scalars;
+    std::size_t begin = 0, dirty_begin = 0;
+    bool need_reset = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        need_reset = need_reset_;
+        need_reset_ = false;
+
+        begin = uploaded_;
+        xyz.assign(positions_.begin() + uploaded_, positions_.end());
+        scalars.assign(scalars_.begin() + uploaded_ * kChannels, scalars_.end());
+        uploaded_ = positions_.size();
+
+        if (dirty_begin_ < dirty_end_) {
+            dirty_begin = dirty_begin_;
+            dirty_scalars.assign(scalars_.begin() + dirty_begin_ * kChannels,
+                                 scalars_.begin() + dirty_end_ * kChannels);
+        }
+        dirty_begin_ = dirty_end_ = 0;
+    }
+
+    if (need_reset) {
+        xyz_buffer_.Resize(0);
+        scalar_buffer_.Resize(0);
+        SetLocalBounds(Eigen::AlignedBox3f());
+    }
+
+    Eigen::AlignedBox3f box;
+    for (const auto &pt : xyz)
+        box.extend(pt);
+    ExtendLocalBounds(box);
+
+    xyz_buffer_.Upload(xyz.data(), begin, xyz.size());
+    scalar_buffer_.Upload(scalars.data(), begin, xyz.size());
+    scalar_buffer_.Upload(dirty_scalars.data(), dirty_begin, dirty_scalars.size() / kChannels);
+}
+
+/**
+ * @brief 渲染函数，轨迹在轨迹坐标系下存储，Twi_作为模型矩阵在渲染时作用
+ * @details
+ *      设置了颜色映射且着色通道不为None时，通过步长和偏移将标量缓冲区中的对应通道绑定到着色器，
+ *      相邻位姿之间的线段颜色由两端的标量插值得到
+ */
+void StampedTrajectoryUI::Render() {
+    if (!IsValid())
+        return;
+
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+    ColorChannel channel = color_channel_.load();
+    ColorMap::Ptr color_map = std::atomic_load(&color_map_);
+    if (channel == ColorChannel::None)
+        color_map = nullptr;
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    if (color_map) {
+        color_map->Bind();
+        color_map->SetModel(Twi);
+        color_map->BindScalar(scalar_buffer_, GL_FLOAT, sizeof(float) * kChannels,
+                              sizeof(float) * (static_cast<int>(channel) - 1));
+    } else
+        glColor3f(color_[0], color_[1], color_[2]);
+
+    glLineWidth(line_width_);
+    RenderBuffer(xyz_buffer_, nullptr, GL_LINE_STRIP, 0, xyz_buffer_.Size());
+    glLineWidth(1.0);
+
+    glPointSize(point_size_);
+    RenderBuffer(xyz_buffer_, nullptr, GL_POINTS, 0, xyz_buffer_.Size());
+    glPointSize(1.0);
+
+    if (color_map) {
+        color_map->UnbindScalar();
+        color_map->Unbind();
+    }
+    glPopMatrix();
+}
+
+/// 清空轨迹，显存保留并在渲染线程下次更新时从头写入
+void StampedTrajectoryUI::Clear() {
+    {
+        auto lock = ProducerLock();
+        stamps_.clear();
+        positions_.clear();
+        rotations_.clear();
+        scalars_.clear();
+        uploaded_ = 0;
+        dirty_begin_ = dirty_end_ = 0;
+        need_reset_ = true;
+    }
+    MarkUpdate();
+}
+
+/**
+ * @brief 重置轨迹在世界坐标系下的位姿
+ * @details
+ *      位姿在轨迹坐标系下存储，位姿变化只替换模型矩阵；Interpolate、GetLatest等查询在返回前左乘Twi_，
+ *      因此查询结果随之变化，不需要修改已存储的位姿
+ * @param Twi 输入的新的位姿
+ */
+void StampedTrajectoryUI::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
+}
+
+} // namespace slam_viewer
@@ -0,0 +1,167 @@
+#include "slam_viewer/core/Frustum.h"
+#include "slam_viewer/ui/SubmapMapUI.hpp"
+
+namespace slam_viewer {
+
+/**
+ * @brief 子图地图UI的构造函数，构造时不创建OpenGL资源
+ *
+ * @param color         输入的颜色
+ * @param line_width    输入的线宽
+ * @param point_size    输入的点大小
+ */
+SubmapMapUI::SubmapMapUI(Vec3 color, float line_width, float point_size)
+    : UIItem(color, line_width, point_size) {}
+
+/**
+ * @brief 设置子图锚点的位姿，只修改一个4x4矩阵，不涉及任何点
+ *
+ * @param id        输入的子图编号
+ * @param Twa       输入的子图锚点在世界坐标系下的位姿
+ * @return true     设置成功
+ * @return false    子图编号无效
+ */
+bool SubmapMapUI::SetAnchor(std::size_t id, const SE3 &Twa) {
+    {
+        auto lock = ProducerLock();
+        if (id >= anchors_.size())
+            return false;
+
+        anchors_[id] = (Twi_.inverse() * Twa).matrix();
+    }
+    MarkUpdate();
+    return true;
+}
+
+/**
+ * @brief 批量设置子图锚点的位姿，回环之后调用，代价为O(子图数量)
+ *
+ * @param anchors   输入的世界坐标系下的子图锚点位姿，第i个元素对应编号为i的子图
+ * @return true     设置成功
+ * @return false    位姿数量超过子图数量
+ */
+bool SubmapMapUI::SetAnchors(const std::vector<SE3> &anchors) {
+    {
+        auto lock = ProducerLock();
+        if (anchors.size() > anchors_.size())
+            return false;
+
+        SE3 Tiw = Twi_.inverse();
+        for (std::size_t id = 0; id < anchors.size(); ++id)
+            anchors_[id] = (Tiw * anchors[id]).matrix();
+    }
+    MarkUpdate();
+    return true;
+}
+
+/// 子图数量
+std::size_t SubmapMapUI::Size() {
+    auto lock = ProducerLock();
+    return anchors_.size();
+}
+
+/**
+ * @brief 取走生产者发布的子图点并追加上传，渲染线程调用
+ * @details
+ *      上传不获取mutex_；之后只在拷贝锚点矩阵时短暂持有mutex_，由各子图的包围盒和锚点重新计算地图的包围盒，
+ *      代价为O(子图数量)
+ */
+void SubmapMapUI::Update() {
+    if (!ConsumeUpdate())
+        return;
+
+    pending_.Drain([&](PendingPoints &&pending) {
+        if (pending.reset_) {
+            submaps_.clear();
+            return;
+        }
+
+        while (submaps_.size() <= pending.id_)
+            submaps_.push_back(std::make_unique<Submap>());
+
+        Submap &submap = *submaps_[pending.id_];
+        for (const auto &pt : pending.xyz_)
+            submap.box_.extend(pt);
+        submap.xyz_buffer_.Append(pending.xyz_.data(), pending.xyz_.size());
+        submap.color_buffer_.Append(pending.color_.data(), pending.color_.size());
+    });
+
+    std::vector<Mat4, Eigen::aligned_allocator<Mat4>> anchors;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        anchors = anchors_;
+    }
+
+    Eigen::AlignedBox3f box;
+    std::size_t num = std::min(anchors.size(), submaps_.size());
+    for (std::size_t id = 0; id < num; ++id)
+        box.extend(TransformBox(submaps_[id]->box_, anchors[id]));
+    SetLocalBounds(box);
+}
+
+/**
+ * @brief 渲染函数，每个子图以Twi_和子图锚点位姿的乘积作为模型矩阵
+ * @details
+ *      1. 锁内只拷贝锚点矩阵，代价为O(子图数量)，绘制期间生产者不会被阻塞
+ *      2. 在地图坐标系中与视锥体求交，跳过视野外的子图
+ */
+void SubmapMapUI::Render() {
+    if (!IsValid())
+        return;
+
+    Mat4 Twi;
+    std::vector<Mat4, Eigen::aligned_allocator<Mat4>> anchors;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+        anchors = anchors_;
+    }
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    glPointSize(point_size_);
+    Frustum frustum = Frustum::FromGlState();
+    std::size_t num = std::min(anchors.size(), submaps_.size());
+    for (std::size_t id = 0; id < num; ++id) {
+        const Submap &submap = *submaps_[id];
+        if (submap.xyz_buffer_.Size() == 0 || !frustum.Intersects(TransformBox(submap.box_, anchors[id])))
+            continue;
+
+        glPushMatrix();
+        glMultMatrixf(anchors[id].data());
+        RenderBuffer(submap.xyz_buffer_, &submap.color_buffer_, GL_POINTS, 0, submap.xyz_buffer_.Size());
+        glPopMatrix();
+    }
+    glPointSize(1.0);
+    glPopMatrix();
+}
+
+/// 清理函数，删除全部子图，显存在渲染线程下次更新时释放
+void SubmapMapUI::Clear() {
+    {
+        auto lock = ProducerLock();
+        anchors_.clear();
+    }
+
+    PendingPoints pending;
+    pending.reset_ = true;
+    pending_.Push(std::move(pending));
+    MarkUpdate();
+}
+
+/**
+ * @brief 重置地图在世界坐标系下的位姿
+ * @details
+ *      子图锚点在地图坐标系下存储，子图点在各自的锚点坐标系下存储，位姿变化只替换最外层的模型矩阵；
+ *      之后AddSubmap和SetAnchor传入的世界位姿按新的Twi_变换
+ * @param Twi 输入的新的位姿
+ */
+void SubmapMapUI::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
+}
+
+} // namespace slam_viewer
@@ -0,0 +1,237 @@
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "slam_viewer/core/TrajectoryEvaluator.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 流式轨迹评估器的构造函数
+ *
+ * @param segment_lengths   输入的RPE段长（米）
+ * @param with_scale        输入的对齐是否估计尺度
+ * @param rpe_step          输入的RPE起点之间间隔的位姿数量
+ * @param realign_interval  输入的重新计算全部位姿误差的间隔位姿数量
+ */
+TrajectoryEvaluator::TrajectoryEvaluator(std::vector<double> segment_lengths, bool with_scale, std::size_t rpe_step,
+                                         std::size_t realign_interval)
+    : with_scale_(with_scale)
+    , rpe_step_(std::max<std::size_t>(rpe_step, 1))
+    , realign_interval_(realign_interval)
+    , aligner_(with_scale)
+    , generation_(0)
+    , realigned_size_(0)
+    , plot_interval_(1) {
+    for (const double &length : segment_lengths)
+        segments_.push_back({length, 0, 0, 0.0, 0.0});
+    Reset();
+}
+
+/// 设置位姿误差着色的轨迹，轨迹中的位姿编号与评估器一一对应
+void TrajectoryEvaluator::SetTrajectory(StampedTrajectoryUI::Ptr trajectory) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trajectory_ = std::move(trajectory);
+}
+
+/**
+ * @brief 设置结果推送的绘图空间，绘图元素需由Plotter::AddPlotterItem以PlotLabels()创建
+ *
+ * @param plotter       输入的绘图空间
+ * @param plot_name     输入的绘图元素名称
+ * @param plot_interval 输入的推送间隔位姿数量
+ */
+void TrajectoryEvaluator::SetPlotter(Plotter::Ptr plotter, std::string plot_name, std::size_t plot_interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    plotter_ = std::move(plotter);
+    plot_name_ = std::move(plot_name);
+    plot_interval_ = std::max<std::size_t>(plot_interval, 1);
+}
+
+/// 绘图元素的标签，依次为ATE和各段长的平移RPE
+std::vector<std::string> TrajectoryEvaluator::PlotLabels() const {
+    std::vector<std::string> labels{"ATE"};
+    for (const auto &segment : segments_)
+        labels.push_back("RPE_" + std::to_string(static_cast<int>(segment.length_)));
+    return labels;
+}
+
+/**
+ * @brief 添加一对估计位姿和真值位姿
+ * @details
+ *      1. 累加充分统计量并重新求解对齐，代价为一次3x3的SVD
+ *      2. 新位姿在当前对齐下的误差写入轨迹的误差通道，每realign_interval_个位姿在新的对齐下刷新全部误差
+ *      3. 刷新全部误差时只在锁内拍摄快照，O(N)的计算和写入在释放mutex_之后进行
+ * @param stamp     输入的时间戳
+ * @param Twc_est   输入的估计位姿
+ * @param Twc_gt    输入的真值位姿
+ * @return true     添加成功
+ * @return false    时间戳不是严格递增的
+ */
+bool TrajectoryEvaluator::AddPose(double stamp, const SE3 &Twc_est, const SE3 &Twc_gt) {
+    RealignTask task;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stamps_.empty() && stamp <= stamps_.back())
+            return false;
+
+        Vec3d x = Twc_est.translation().cast<double>();
+        Vec3d y = Twc_gt.translation().cast<double>();
+        double distance = 0.0;
+        if (!gt_.empty())
+            distance = distances_.back() + (Twc_gt.translation() - gt_.back().translation()).norm();
+
+        std::size_t id = est_.size();
+        if (id % kBlockPoses == 0)
+            blocks_.push_back(std::make_shared<PositionBlock>());
+        blocks_.back()->est_[id % kBlockPoses] = x;
+        blocks_.back()->gt_[id % kBlockPoses] = y;
+
+        stamps_.push_back(stamp);
+        est_.push_back(Twc_est);
+        gt_.push_back(Twc_gt);
+        distances_.push_back(distance);
+
+        aligner_.Add(x, y);
+        aligner_.Solve();
+        UpdateSegments();
+
+        if (trajectory_) {
+            trajectory_->AddPose(stamp, Twc_est, PoseError(id));
+            if (realign_interval_ > 0 && est_.size() % realign_interval_ == 0)
+                task = MakeRealignTask();
+        }
+
+        if (plotter_ && est_.size() % plot_interval_ == 0)
+            Plot();
+    }
+
+    if (task.trajectory_)
+        Realign(task);
+    return true;
+}
+
+/// 当前对齐下第id个位姿的平移误差，需持有mutex_
+float TrajectoryEvaluator::PoseError(std::size_t id) const {
+    const PositionBlock &block = *blocks_[id / kBlockPoses];
+    return static_cast<float>(aligner_.Error(block.est_[id % kBlockPoses], block.gt_[id % kBlockPoses]));
+}
+
+/**
+ * @brief 以新位姿为终点更新各段长的RPE，需持有mutex_
+ * @details
+ *      每个段长的起点只会前进，起点到新位姿的真值行驶距离达到段长时计算一对相对位姿误差，
+ *      因此每个位姿的均摊代价与段长数量成正比；段长数量很少，串行计算
+ */
+void TrajectoryEvaluator::UpdateSegments() {
+    std::size_t end = est_.size() - 1;
+    for (auto &segment : segments_) {
+        while (segment.start_ < end && distances_[end] - distances_[segment.start_] >= segment.length_) {
+            std::size_t start = segment.start_;
+            SE3 delta_gt = gt_[start].inverse() * gt_[end];
+            SE3 delta_est = est_[start].inverse() * est_[end];
+            SE3 error = delta_gt.inverse() * delta_est;
+
+            segment.trans_sum_ += error.translation().norm() / segment.length_ * 100.0;
+            segment.rot_sum_ += error.so3().log().norm() * 180.0 / M_PI / segment.length_;
+            ++segment.count_;
+            segment.start_ += rpe_step_;
+        }
+    }
+}
+
+/**
+ * @brief 拍摄重新计算误差的快照，需持有mutex_
+ * @details
+ *      只拷贝位置块的指针和当前的对齐，代价为O(N / kBlockPoses)
+ * @return TrajectoryEvaluator::RealignTask 输出的快照
+ */
+TrajectoryEvaluator::RealignTask TrajectoryEvaluator::MakeRealignTask() const {
+    RealignTask task;
+    task.blocks_.assign(blocks_.begin(), blocks_.end());
+    task.size_ = est_.size();
+    task.generation_ = generation_;
+    task.aligner_ = aligner_;
+    task.trajectory_ = trajectory_;
+    return task;
+}
+
+/**
+ * @brief 在快照的对齐下并行重新计算全部位姿的误差，并一次性写入轨迹的误差通道，不持有mutex_
+ * @details
+ *      1. 快照之后追加的位置写在位置块中快照范围之外的位置，与这里的读取互不重叠
+ *      2. realign_mutex_串行化各次刷新，快照之后发生过Reset或已经写入了更新的快照时直接返回
+ * @param task 输入的快照
+ */
+void TrajectoryEvaluator::Realign(const RealignTask &task) {
+    std::lock_guard<std::mutex> lock(realign_mutex_);
+    if (task.generation_ != generation_ || task.size_ <= realigned_size_)
+        return;
+
+    std::vector<float> errors(task.size_);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, errors.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range) {
+                          for (std::size_t id = range.begin(); id != range.end(); ++id) {
+                              const PositionBlock &block = *task.blocks_[id / kBlockPoses];
+                              errors[id] = static_cast<float>(
+                                  task.aligner_.Error(block.est_[id % kBlockPoses], block.gt_[id % kBlockPoses]));
+                          }
+                      });
+    task.trajectory_->SetScalars(StampedTrajectoryUI::ColorChannel::Error, 0, errors);
+    realigned_size_ = task.size_;
+}
+
+/// 推送ATE和各段长的平移RPE，尚无统计的段长推送0，需持有mutex_
+void TrajectoryEvaluator::Plot() {
+    std::vector<float> data{static_cast<float>(std::sqrt(aligner_.SquaredError() / aligner_.Size()))};
+    for (const auto &segment : segments_)
+        data.push_back(segment.count_ ? static_cast<float>(segment.trans_sum_ / segment.count_) : 0.f);
+    plotter_->UpdatePlotterItem(plot_name_, data);
+}
+
+/// 获取当前的评估结果
+TrajectoryEvaluator::Result TrajectoryEvaluator::GetResult() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Result result;
+    result.size_ = est_.size();
+    result.ate_rmse_ = aligner_.Size() > 0 ? std::sqrt(aligner_.SquaredError() / aligner_.Size()) : 0.0;
+    result.scale_ = aligner_.Scale();
+    for (const auto &segment : segments_) {
+        double count = std::max<double>(segment.count_, 1);
+        result.segments_.push_back(
+            {segment.length_, segment.count_, segment.trans_sum_ / count, segment.rot_sum_ / count});
+    }
+    return result;
+}
+
+/// 获取当前的对齐变换
+Eigen::Matrix4d TrajectoryEvaluator::GetAlignment() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aligner_.Matrix();
+}
+
+/**
+ * @brief 清空评估状态和误差着色的轨迹，已设置的轨迹和绘图空间保留
+ * @details
+ *      先持有realign_mutex_，等待正在进行的刷新写完，并使已经拍摄但尚未写入的快照失效；
+ *      轨迹同时清空，重新开始的时间戳不会被轨迹拒绝，位姿编号也与评估器保持一致
+ */
+void TrajectoryEvaluator::Reset() {
+    std::lock_guard<std::mutex> realign_lock(realign_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stamps_.clear();
+    est_.clear();
+    gt_.clear();
+    blocks_.clear();
+    distances_.clear();
+    for (auto &segment : segments_)
+        segment = {segment.length_, 0, 0, 0.0, 0.0};
+
+    aligner_.Reset();
+    ++generation_;
+    realigned_size_ = 0;
+    if (trajectory_)
+        trajectory_->Clear();
+}
+
+} // namespace slam_viewer
@@ -1,24 +1,184 @@
+#include <algorithm>
+
 #include "slam_viewer/ui/TrajectoryUI.h"
 
 namespace slam_viewer{
 
+/**
+ * @brief 渲染函数，轨迹点在轨迹坐标系下存储，Twi_作为模型矩阵在渲染时作用
+ * @details
+ *      1. 每个分块独立选择层级，相邻且层级相同的分块合并为一个绘制区间，区间之间以线段连接
+ *      2. 最后一个区间为简化折线时，将其最后一个保留顶点与最新的轨迹点相连
+ *      3. 绘制全部轨迹点的区间在环形缓冲区中越过尾部时分两段绘制，两段之间的接缝单独连接
+ */
 void TrajectoryUI::Render() {
     if (!IsValid())
         return;
 
-    glColor3f(color_[0], color_[1], color_[2]);
-
-    // 点线形式绘制
+    Mat4 Twi;
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+
+    std::size_t size = poses_.size();
+    const Vec3 &newest = poses_[(head_ + size - 1) % size];
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    glColor3f(color_[0], color_[1], color_[2]);
+
+    BuildRuns();
+    joins_.clear();
+    bool has_prev = false;
+    Vec3 prev_back;
+    for (const auto &run : runs_) {
+        Vec3 front, back;
+        if (!DrawRunBuffer(run, front, back))
+            continue;
+
+        if (has_prev) {
+            joins_.push_back(prev_back);
+            joins_.push_back(front);
+        }
+        prev_back = back;
+        has_prev = true;
+    }
+    if (has_prev && prev_back != newest) {
+        joins_.push_back(prev_back);
+        joins_.push_back(newest);
+    }
+
+    if (!joins_.empty()) {
         glLineWidth(line_width_);
-        pangolin::RenderVbo(vbo_, GL_LINE_STRIP);
+        glBegin(GL_LINES);
+        for (const auto &pt : joins_)
+            glVertex3fv(pt.data());
+        glEnd();
         glLineWidth(1.0);
+    }
+    glPopMatrix();
+}
+
+/**
+ * @brief 为每个分块选择层级，并将相邻且层级相同的分块合并为绘制区间，需在模型矩阵作用之后调用
+ * @details
+ *      1. 简化折线的顶点按序号排列，分块对应的顶点区间通过二分查找得到
+ *      2. 分块被环形缓冲区部分淘汰时，只绘制未被淘汰的轨迹点
+ *      3. max_pixel_error_小于等于0时整条轨迹作为一个绘制全部轨迹点的区间
+ */
+void TrajectoryUI::BuildRuns() {
+    runs_.clear();
+    float max_pixel_error = max_pixel_error_.load();
+    std::uint64_t oldest = total_ - poses_.size();
+    if (max_pixel_error <= 0 || chunks_.empty()) {
+        runs_.push_back({nullptr, oldest, total_});
+        return;
+    }
+
+    Mat4 proj, model_view;
+    GLint viewport[4];
+    glGetFloatv(GL_PROJECTION_MATRIX, proj.data());
+    glGetFloatv(GL_MODELVIEW_MATRIX, model_view.data());
+    glGetIntegerv(GL_VIEWPORT, viewport);
 
+    const float pixel_scale = proj(1, 1) * viewport[3] * 0.5f;
+    const Vec3 camera_position = model_view.inverse().col(3).head<3>();
+    for (const auto &chunk : chunks_) {
+        std::uint64_t begin = std::max<std::uint64_t>(chunk.begin_seq_, oldest);
+        std::uint64_t end = std::min<std::uint64_t>(chunk.begin_seq_ + kChunkPoints, total_);
+        const Level *level = SelectLevel(chunk, camera_position, pixel_scale, max_pixel_error);
+        if (level) {
+            auto seq_begin = level->seq_.begin() + level->start_;
+            begin = std::lower_bound(seq_begin, level->seq_.end(), begin) - level->seq_.begin();
+            end = std::lower_bound(seq_begin, level->seq_.end(), end) - level->seq_.begin();
+        }
+
+        if (!runs_.empty() && runs_.back().level_ == level && runs_.back().end_ == begin)
+            runs_.back().end_ = end;
+        else
+            runs_.push_back({level, begin, end});
+    }
+}
+
+/**
+ * @brief 选择分块的层级
+ * @details
+ *      1. 容差为t的层级在距离d处的屏幕误差不超过t / d * pixel_scale，d取相机到分块包围盒的距离
+ *      2. 从最粗的层级开始，选择第一个屏幕误差不超过max_pixel_error的层级
+ *      3. 相机位于分块包围盒内部或没有满足条件的层级时返回nullptr，该分块绘制全部轨迹点
+ * @param chunk                         输入的分块
+ * @param camera_position               输入的轨迹坐标系下的相机位置
+ * @param pixel_scale                   输入的单位距离处单位长度对应的像素数
+ * @param max_pixel_error               输入的最大屏幕误差（像素）
+ * @return const TrajectoryUI::Level*   输出的选择的层级
+ */
+const TrajectoryUI::Level *TrajectoryUI::SelectLevel(const Chunk &chunk, const Vec3 &camera_position,
+                                                     float pixel_scale, float max_pixel_error) const {
+    float distance = chunk.box_.exteriorDistance(camera_position);
+    if (distance <= 0)
+        return nullptr;
+
+    for (auto iter = levels_.rbegin(); iter != levels_.rend(); ++iter) {
+        if (iter->tolerance_ * pixel_scale <= max_pixel_error * distance)
+            return &*iter;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 绘制一个区间的折线和点
+ *
+ * @param run       输入的绘制区间
+ * @param front     输出的区间的第一个轨迹点
+ * @param back      输出的区间的最后一个轨迹点
+ * @return true     区间非空，已经绘制
+ * @return false    区间为空
+ */
+bool TrajectoryUI::DrawRunBuffer(const DrawRun &run, Vec3 &front, Vec3 &back) {
+    if (run.end_ <= run.begin_)
+        return false;
+
+    std::size_t count = run.end_ - run.begin_;
+    if (run.level_) {
+        const Level &level = *run.level_;
+        front = level.xyz_[run.begin_];
+        back = level.xyz_[run.end_ - 1];
+
+        glLineWidth(line_width_);
+        RenderBuffer(level.buffer_, nullptr, GL_LINE_STRIP, run.begin_, count);
+        glLineWidth(1.0);
         glPointSize(point_size_);
-        pangolin::RenderVbo(vbo_, GL_POINTS);
+        RenderBuffer(level.buffer_, nullptr, GL_POINTS, run.begin_, count);
         glPointSize(1.0);
+        return true;
+    }
+
+    std::size_t size = poses_.size();
+    std::uint64_t oldest = total_ - size;
+    std::size_t first = (head_ + (run.begin_ - oldest)) % size;
+    std::size_t tail = std::min(count, size - first);
+    front = poses_[first];
+    back = poses_[(first + count - 1) % size];
+
+    glLineWidth(line_width_);
+    RenderBuffer(pose_buffer_, nullptr, GL_LINE_STRIP, first, tail);
+    if (tail < count) {
+        RenderBuffer(pose_buffer_, nullptr, GL_LINE_STRIP, 0, count - tail);
+
+        glBegin(GL_LINES);
+        glVertex3fv(poses_[size - 1].data());
+        glVertex3fv(poses_[0].data());
+        glEnd();
     }
+    glLineWidth(1.0);
+
+    glPointSize(point_size_);
+    RenderBuffer(pose_buffer_, nullptr, GL_POINTS, first, tail);
+    if (tail < count)
+        RenderBuffer(pose_buffer_, nullptr, GL_POINTS, 0, count - tail);
+    glPointSize(1.0);
+    return true;
 }
 
 /**
@@ -27,75 +187,182 @@ void TrajectoryUI::Render() {
  * @param color         颜色
  * @param line_width    线宽
  * @param point_size    点大小
- * @param max_capicity  轨迹ui最大容量
+ * @param max_capicity      轨迹ui最大容量
+ * @param max_pixel_error   简化折线允许的最大屏幕误差（像素）
  */
-TrajectoryUI::TrajectoryUI(Vec3 color, float line_width, float point_size, std::size_t max_capicity)
+TrajectoryUI::TrajectoryUI(Vec3 color, float line_width, float point_size, std::size_t max_capicity,
+                           float max_pixel_error)
     : UIItem(color, line_width, point_size)
-    , max_capicity_(std::move(max_capicity)) {
-    poses_.reserve(max_capicity_);
+    , max_capicity_(std::max<std::size_t>(max_capicity, 1))
+    , head_(0)
+    , pose_buffer_(GL_FLOAT, 3)
+    , total_(0)
+    , max_pixel_error_(max_pixel_error) {
+    levels_.reserve(kLevels);
+    float tolerance = kBaseTolerance;
+    for (int i = 0; i < kLevels; ++i, tolerance *= kToleranceFactor)
+        levels_.emplace_back(tolerance);
 }
 
 /**
- * @brief 向轨迹UI中添加轨迹点
+ * @brief 向轨迹UI中添加轨迹点，只在变换到轨迹坐标系时短暂持有mutex_
  *
- * @param pt 输入的轨迹点
+ * @param pt 输入的世界坐标系下的轨迹点
  */
 void TrajectoryUI::AddPt(const Vec3 &pt) {
+    Vec3 local_pt;
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (poses_.size() >= max_capicity_)
-            poses_.erase(poses_.begin(), poses_.end() + 2e7);
-
-        poses_.push_back(pt);
+        auto lock = ProducerLock();
+        local_pt = Twi_.inverse() * pt;
     }
-    need_update_.store(true);
+    pending_.Push({false, local_pt});
+    MarkUpdate();
 }
 
 /**
- * @brief 判断元素是否需要更新，若需要更新，需要将need_update_标识置为false
- *
+ * @brief 取走生产者发布的轨迹点并上传，渲染线程调用
+ * @details
+ *      1. 新轨迹点在环形意义下连续写入，记录起点和数量，只上传这一区间，越过尾部时分两段上传
+ *      2. 每个轨迹点的CPU和显存代价均为均摊O(1)，与轨迹长度无关
+ *      3. 简化折线只追加上传新保留的顶点，被淘汰的顶点压缩后整体重新上传，代价同样为均摊O(1)
  */
 void TrajectoryUI::Update() {
-    if (!need_update_.load())
+    if (!ConsumeUpdate())
         return;
 
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        vbo_ = pangolin::GlBuffer(pangolin::GlArrayBuffer, poses_);
+    std::size_t begin = 0, num = 0;
+    pending_.Drain([&](PendingPt &&pending) {
+        if (pending.reset_) {
+            ResetPoses();
+            num = 0;
+            return;
+        }
+
+        std::size_t offset = WritePt(pending.pt_);
+        SimplifyPt(pending.pt_);
+        if (num++ == 0)
+            begin = offset;
+    });
+    SetLocalBounds(box_);
+
+    if (num == 0)
+        return;
+
+    for (auto &level : levels_) {
+        level.buffer_.Upload(level.xyz_.data() + level.uploaded_, level.uploaded_,
+                             level.xyz_.size() - level.uploaded_);
+        level.uploaded_ = level.xyz_.size();
     }
-    need_update_.store(false);
+
+    std::size_t size = poses_.size();
+    if (num >= size) {
+        pose_buffer_.Upload(poses_.data(), 0, size);
+        return;
+    }
+
+    std::size_t first = std::min(num, size - begin);
+    pose_buffer_.Upload(poses_.data() + begin, begin, first);
+    pose_buffer_.Upload(poses_.data(), 0, num - first);
 }
 
 /**
- * @brief 清除轨迹的内容
+ * @brief 写入一个轨迹点，未达到最大容量时追加，达到之后覆盖最早的轨迹点
  *
+ * @param pt            输入的轨迹坐标系下的轨迹点
+ * @return std::size_t  输出的写入位置
  */
-void TrajectoryUI::Clear() {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        poses_.clear();
-        poses_.reserve(max_capicity_);
+std::size_t TrajectoryUI::WritePt(const Vec3 &pt) {
+    if (poses_.size() < max_capicity_) {
+        poses_.push_back(pt);
+        return poses_.size() - 1;
     }
 
-    vbo_.Free();
+    std::size_t offset = head_;
+    poses_[offset] = pt;
+    head_ = (head_ + 1) % max_capicity_;
+    return offset;
 }
 
 /**
- * @brief 重置轨迹在世界坐标系下的位姿
+ * @brief 将新轨迹点加入各层简化折线
+ * @details
+ *      1. 与上一个保留顶点的距离不小于容差时保留该点，因此被跳过的点到折线的距离小于容差
+ *      2. 每层只与上一个保留顶点比较，代价为O(kLevels)
+ *      3. 环形缓冲区覆盖的轨迹点对应的顶点被淘汰，淘汰数量超过一半时压缩并重新上传
+ *      4. 每kChunkPoints个轨迹点开始一个新的分块，全部轨迹点被覆盖的分块从队首移除
+ * @param pt 输入的轨迹坐标系下的轨迹点
+ */
+void TrajectoryUI::SimplifyPt(const Vec3 &pt) {
+    std::uint64_t seq = total_++;
+    std::uint64_t oldest = total_ - poses_.size();
+    box_.extend(pt);
+
+    if (seq % kChunkPoints == 0)
+        chunks_.push_back({seq, Eigen::AlignedBox3f()});
+    chunks_.back().box_.extend(pt);
+    while (chunks_.front().begin_seq_ + kChunkPoints <= oldest)
+        chunks_.pop_front();
+
+    for (auto &level : levels_) {
+        bool empty = level.start_ == level.xyz_.size();
+        if (empty || (pt - level.xyz_.back()).norm() >= level.tolerance_) {
+            level.xyz_.push_back(pt);
+            level.seq_.push_back(seq);
+        }
+
+        while (level.start_ < level.xyz_.size() && level.seq_[level.start_] < oldest)
+            ++level.start_;
+
+        if (level.start_ >= kMinCompact && level.start_ * 2 > level.xyz_.size()) {
+            level.xyz_.erase(level.xyz_.begin(), level.xyz_.begin() + level.start_);
+            level.seq_.erase(level.seq_.begin(), level.seq_.begin() + level.start_);
+            level.start_ = 0;
+            level.uploaded_ = 0;
+            level.buffer_.Resize(0);
+        }
+    }
+}
+
+/// 清空轨迹点和简化折线，显存保留并在之后从头写入
+void TrajectoryUI::ResetPoses() {
+    poses_.clear();
+    head_ = 0;
+    pose_buffer_.Resize(0);
+
+    total_ = 0;
+    box_.setEmpty();
+    chunks_.clear();
+    for (auto &level : levels_) {
+        level.xyz_.clear();
+        level.seq_.clear();
+        level.start_ = 0;
+        level.uploaded_ = 0;
+        level.buffer_.Resize(0);
+    }
+}
+
+/**
+ * @brief 清除轨迹的内容，渲染线程下次更新时清空轨迹点和显存
  *
+ */
+void TrajectoryUI::Clear() {
+    pending_.Push({true, Vec3::Zero()});
+    MarkUpdate();
+}
+
+/**
+ * @brief 重置轨迹在世界坐标系下的位姿
+ * @details
+ *      轨迹点、简化折线和分块包围盒都在轨迹坐标系下维护，位姿变化只替换模型矩阵；
+ *      之后AddPt传入的世界坐标系下的点按新的Twi_变换
  * @param Twi   输入的重之后的世界坐标系下的位姿
  */
 void TrajectoryUI::ResetTwi(const SE3 &Twi) {
-    std::vector<Vec3> poses(poses_.size());
-    auto Tiw_ = Twi_.inverse();
-    for (int i = 0; i < poses_.size(); ++i)
-        poses[i] = Twi * Tiw_ * poses_[i];
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::swap(poses, poses_);
-    Twi_ = Twi;
-
-    need_update_.store(true);
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <limits>
+
+#include <Eigen/LU>
+#include <Eigen/SVD>
+
+#include "slam_viewer/core/Umeyama.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 流式Umeyama对齐的构造函数
+ *
+ * @param with_scale 输入的是否估计尺度，单目时使用
+ */
+UmeyamaAligner::UmeyamaAligner(bool with_scale)
+    : with_scale_(with_scale) {
+    Reset();
+}
+
+/**
+ * @brief 添加一对点，只累加充分统计量，不重新求解
+ *
+ * @param x 输入的源点
+ * @param y 输入的目标点
+ */
+void UmeyamaAligner::Add(const Vec3d &x, const Vec3d &y) {
+    n_ += 1.0;
+    sum_x_ += x;
+    sum_y_ += y;
+    sum_yx_ += y * x.transpose();
+    sum_xx_ += x.squaredNorm();
+    sum_yy_ += y.squaredNorm();
+}
+
+/**
+ * @brief 由充分统计量求解Umeyama对齐
+ * @details
+ *      互协方差为sum_yx_ / n - mu_y * mu_x^T，SVD分解后得到旋转，尺度为奇异值加权和与源点方差之比
+ */
+void UmeyamaAligner::Solve() {
+    if (n_ < 3) {
+        R_.setIdentity();
+        s_ = 1.0;
+        t_ = n_ > 0 ? Vec3d((sum_y_ - sum_x_) / n_) : Vec3d::Zero();
+        return;
+    }
+
+    Vec3d mu_x = sum_x_ / n_;
+    Vec3d mu_y = sum_y_ / n_;
+    Mat3d sigma = sum_yx_ / n_ - mu_y * mu_x.transpose();
+
+    Eigen::JacobiSVD<Mat3d> svd(sigma, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Vec3d d(1.0, 1.0, 1.0);
+    if (svd.matrixU().determinant() * svd.matrixV().determinant() < 0)
+        d.z() = -1.0;
+
+    R_ = svd.matrixU() * d.asDiagonal() * svd.matrixV().transpose();
+    s_ = 1.0;
+    if (with_scale_) {
+        double var_x = sum_xx_ / n_ - mu_x.squaredNorm();
+        if (var_x > std::numeric_limits<double>::epsilon())
+            s_ = svd.singularValues().dot(d) / var_x;
+    }
+    t_ = mu_y - s_ * R_ * mu_x;
+}
+
+/**
+ * @brief 当前对齐下全部点对的误差平方和
+ * @details
+ *      将sum |y - sRx - t|^2展开，只用到各充分统计量，代价为O(1)
+ */
+double UmeyamaAligner::SquaredError() const {
+    double error = sum_yy_ + s_ * s_ * sum_xx_ + n_ * t_.squaredNorm();
+    error -= 2.0 * s_ * R_.cwiseProduct(sum_yx_).sum();
+    error -= 2.0 * t_.dot(sum_y_);
+    error += 2.0 * s_ * t_.dot(R_ * sum_x_);
+    return std::max(error, 0.0);
+}
+
+/// 当前对齐的4x4变换
+Eigen::Matrix4d UmeyamaAligner::Matrix() const {
+    Eigen::Matrix4d alignment = Eigen::Matrix4d::Identity();
+    alignment.topLeftCorner<3, 3>() = s_ * R_;
+    alignment.topRightCorner<3, 1>() = t_;
+    return alignment;
+}
+
+/// 清空充分统计量
+void UmeyamaAligner::Reset() {
+    n_ = 0.0;
+    sum_x_.setZero();
+    sum_y_.setZero();
+    sum_yx_.setZero();
+    sum_xx_ = 0.0;
+    sum_yy_ = 0.0;
+    R_.setIdentity();
+    t_.setZero();
+    s_ = 1.0;
+}
+
+} // namespace slam_viewer
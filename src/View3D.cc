@@ -1,28 +1,168 @@
+#include <algorithm>
+
 #include "slam_viewer/core/View3D.h"
 
 namespace slam_viewer{
 
 /**
  * @brief View3D空间渲染函数
- *
+ * @details
+ *      1. 被删除的ui_item在渲染线程中释放，保证显存在持有OpenGL上下文的线程中回收
+ *      2. 只有压入脏队列的ui_item才会调用Update，每帧的更新开销与变化的数量成正比，与场景规模无关
+ *      3. 维护了包围盒的ui_item通过BVH与当前视锥体求交，只渲染可见且在视野内的ui_item，
+ *         渲染代价与屏幕上的内容成正比，与已建图的规模无关
+ *      4. 更新后统计显存占用，超出上限时淘汰最早添加的ui_item
  */
 void View3D::Render() {
     camera_->Update();
 
+    std::vector<UIItem::Ptr> retired_items;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(retired_items, retired_items_);
+    }
+    retired_items.clear();
+
     auto &display_3d = pangolin::Display(name_);
     if (display_3d.IsShown()) {
         display_3d.Activate(camera_->RenderState());
         camera_->BindDisplay(name_);
 
         std::lock_guard<std::mutex> lock(mutex_);
-        if (ui_items_.empty())
+        UpdateDirtyItems();
+        if (items_.empty())
             return;
 
-        for (const auto &item : ui_items_) {
-            item->Update();
-            item->Render();
+        CullItems(Frustum::FromGlState());
+        for (const auto &dense : render_items_)
+            items_[dense].item_->Render();
+        rendered_num_.store(render_items_.size());
+
+        Evict();
+        gpu_bytes_.store(total_gpu_bytes_);
+    }
+}
+
+/**
+ * @brief 取出脏队列并更新其中的ui_item，仅渲染线程调用，需持有mutex_
+ * @details
+ *      1. 已删除的ui_item的句柄失效后直接跳过，同一ui_item的重复句柄通过Entry::dirty_去重
+ *      2. 更新前将ui_item的queued_置回，更新期间的新标记会重新压入脏队列，不会丢失
+ *      3. 不可见的ui_item保留在dirty_handles_中，重新显示后再更新
+ *      4. 记录每次Update的时间和渲染线程计数器上的上传字节数，累计到ui_item的统计中
+ */
+void View3D::UpdateDirtyItems() {
+    dirty_queue_->Drain([&](ItemHandle &&handle) {
+        std::uint32_t dense = Find(handle);
+        if (dense == kNone || items_[dense].dirty_)
+            return;
+
+        items_[dense].dirty_ = true;
+        dirty_handles_.push_back(handle);
+    });
+
+    const RenderCounters &counters = ThreadRenderCounters();
+    std::size_t kept = 0;
+    for (const auto &handle : dirty_handles_) {
+        std::uint32_t dense = Find(handle);
+        if (dense == kNone)
+            continue;
+
+        Entry &entry = items_[dense];
+        if (!entry.visible_ || !group_visible_[entry.group_]) {
+            dirty_handles_[kept++] = handle;
+            continue;
         }
+
+        entry.dirty_ = false;
+        entry.item_->queued_.store(false);
+
+        std::size_t upload_bytes = counters.upload_bytes_;
+        auto start = std::chrono::steady_clock::now();
+        entry.item_->Update();
+        auto update_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        entry.item_->RecordUpdate(update_ns.count(), counters.upload_bytes_ - upload_bytes);
+
+        UpdateBounds(entry);
+
+        std::size_t gpu_bytes = entry.item_->GpuBytes();
+        total_gpu_bytes_ = total_gpu_bytes_ - entry.gpu_bytes_ + gpu_bytes;
+        entry.gpu_bytes_ = gpu_bytes;
+    }
+    dirty_handles_.resize(kept);
+}
+
+/**
+ * @brief 重新计算ui_item在世界坐标系下的包围盒并修正BVH，仅渲染线程调用，需持有mutex_
+ * @details
+ *      1. ui_item在Update中维护自身坐标系下的包围盒，位姿变化通过MarkMoved通知，两者都会递增bounds_version_
+ *      2. 叶子节点保存放大后的包围盒，增量增长的几何体大多数情况下不需要修改树
+ *      3. 包围盒为空时从树中移除，没有需要绘制的内容，不会被渲染
+ *      4. 不维护包围盒的ui_item移入unbounded_slots_，剔除时不需要遍历全部ui_item
+ * @param entry 输入的ui_item
+ */
+void View3D::UpdateBounds(Entry &entry) {
+    std::uint64_t version = entry.item_->bounds_version_.load();
+    if (version == entry.bounds_version_)
+        return;
+    entry.bounds_version_ = version;
+
+    Eigen::AlignedBox3f box;
+    SetBounded(entry, entry.item_->WorldBounds(box));
+    if (!entry.bounded_ || box.isEmpty()) {
+        if (entry.proxy_ != AabbTree::kNull)
+            tree_.Remove(entry.proxy_);
+        entry.proxy_ = AabbTree::kNull;
+        return;
     }
+
+    if (entry.proxy_ == AabbTree::kNull)
+        entry.proxy_ = tree_.Insert(box, entry.slot_);
+    else
+        tree_.Move(entry.proxy_, box);
+}
+
+/**
+ * @brief 设置ui_item是否维护了包围盒，需持有mutex_
+ * @details
+ *      unbounded_slots_与末尾元素交换后弹出，代价为O(1)
+ * @param entry     输入的ui_item
+ * @param bounded   输入的是否维护了包围盒
+ */
+void View3D::SetBounded(Entry &entry, bool bounded) {
+    entry.bounded_ = bounded;
+    if (!bounded && entry.unbounded_ == kNone) {
+        entry.unbounded_ = unbounded_slots_.size();
+        unbounded_slots_.push_back(entry.slot_);
+    } else if (bounded && entry.unbounded_ != kNone) {
+        std::uint32_t last = unbounded_slots_.back();
+        unbounded_slots_[entry.unbounded_] = last;
+        items_[slots_[last].dense_].unbounded_ = entry.unbounded_;
+        unbounded_slots_.pop_back();
+        entry.unbounded_ = kNone;
+    }
+}
+
+/**
+ * @brief 收集本帧需要渲染的稠密下标，仅渲染线程调用，需持有mutex_
+ * @details
+ *      未维护包围盒的ui_item从unbounded_slots_中取出，总是渲染，其余的通过BVH查询，完全在视锥体内的子树整体接受；
+ *      两部分的代价都只与结果数量成正比，结果按稠密下标排序，保持与剔除前一致的绘制顺序
+ * @param frustum 输入的世界坐标系下的视锥体
+ */
+void View3D::CullItems(const Frustum &frustum) {
+    render_items_.clear();
+    auto collect = [&](std::uint32_t slot) {
+        std::uint32_t dense = slots_[slot].dense_;
+        const Entry &entry = items_[dense];
+        if (entry.visible_ && group_visible_[entry.group_])
+            render_items_.push_back(dense);
+    };
+
+    for (const auto &slot : unbounded_slots_)
+        collect(slot);
+    tree_.Query(frustum, collect);
+    std::sort(render_items_.begin(), render_items_.end());
 }
 
 /// 创建3d布局
@@ -36,16 +176,212 @@ void View3D::CreateDisplayLayout(pangolin::Layout layout) {
 /**
  * @brief View 3d添加渲染的UIItem，非初始化阶段，线程安全
  * @note View 3d的添加UIItem api并不是初始化过程，可以随时向其中添加渲染物体
- * @param ui_item 待添加的UIItem
+ * @param ui_item       输入的待添加的UIItem
+ * @param group         输入的分组名称，用于整体显示、隐藏和删除
+ * @param evictable     输入的是否参与自动淘汰，坐标系、轨迹等常驻元素应设置为false
+ * @return ItemHandle   输出的句柄，ui_item为空时返回无效句柄
  */
-void View3D::AddUIItem(UIItem::Ptr ui_item) {
+ItemHandle View3D::AddUIItem(UIItem::Ptr ui_item, const std::string &group, bool evictable) {
     if (!ui_item)
-        return;
+        return ItemHandle();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uint32_t slot_id;
+    if (free_slots_.empty()) {
+        slot_id = slots_.size();
+        slots_.emplace_back();
+    } else {
+        slot_id = free_slots_.back();
+        free_slots_.pop_back();
+    }
+
+    Slot &slot = slots_[slot_id];
+    slot.dense_ = items_.size();
+    slot.evictable_ = evictable;
+    if (evictable) {
+        slot.older_ = newest_;
+        slot.newer_ = kNone;
+        if (newest_ != kNone)
+            slots_[newest_].newer_ = slot_id;
+        else
+            oldest_ = slot_id;
+        newest_ = slot_id;
+        ++evictable_num_;
+    }
+
+    ItemHandle handle{slot_id, slot.generation_};
+    ui_item->AddDirtyQueue(dirty_queue_, handle);
+    dirty_queue_->Push(handle);
 
+    items_.push_back(
+        {std::move(ui_item), slot_id, GroupIndex(group), true, false, 0, true, AabbTree::kNull, 0, kNone});
+    SetBounded(items_.back(), false);
+    Evict();
+
+    return handle;
+}
+
+/**
+ * @brief 删除UIItem，线程安全
+ *
+ * @param handle    输入的AddUIItem返回的句柄
+ * @return true     删除成功
+ * @return false    句柄已失效
+ */
+bool View3D::RemoveUIItem(const ItemHandle &handle) {
     std::lock_guard<std::mutex> lock(mutex_);
-    ui_items_.push_back(std::move(ui_item));
+    std::uint32_t dense = Find(handle);
+    if (dense == kNone)
+        return false;
+
+    RemoveAt(dense);
+    RequestRedraw();
+    return true;
 }
 
+/**
+ * @brief 删除分组内的全部UIItem，线程安全
+ *
+ * @param group         输入的分组名称
+ * @return std::size_t  输出的删除的数量
+ */
+std::size_t View3D::RemoveGroup(const std::string &group) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = group_index_.find(group);
+    if (iter == group_index_.end())
+        return 0;
+
+    std::size_t count = 0;
+    for (std::uint32_t dense = 0; dense < items_.size();) {
+        if (items_[dense].group_ == iter->second) {
+            RemoveAt(dense);
+            ++count;
+        } else
+            ++dense;
+    }
+
+    if (count)
+        RequestRedraw();
+    return count;
+}
+
+/**
+ * @brief 设置UIItem是否可见，线程安全
+ *
+ * @param handle    输入的句柄
+ * @param visible   输入的是否可见
+ * @return true     设置成功
+ * @return false    句柄已失效
+ */
+bool View3D::SetVisible(const ItemHandle &handle, bool visible) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uint32_t dense = Find(handle);
+    if (dense == kNone)
+        return false;
+
+    items_[dense].visible_ = visible;
+    RequestRedraw();
+    return true;
+}
+
+/**
+ * @brief 设置分组是否可见，分组不存在时会创建，线程安全
+ *
+ * @param group     输入的分组名称
+ * @param visible   输入的是否可见
+ */
+void View3D::SetGroupVisible(const std::string &group, bool visible) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    group_visible_[GroupIndex(group)] = visible;
+    RequestRedraw();
+}
+
+/// 获取句柄对应的UIItem，句柄已失效时返回nullptr，线程安全
+UIItem::Ptr View3D::GetUIItem(const ItemHandle &handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uint32_t dense = Find(handle);
+    return dense == kNone ? nullptr : items_[dense].item_;
+}
+
+/// 句柄是否仍然有效，线程安全
+bool View3D::Contains(const ItemHandle &handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Find(handle) != kNone;
+}
+
+/// UIItem的数量，线程安全
+std::size_t View3D::Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return items_.size();
+}
+
+/**
+ * @brief 设置自动淘汰策略，线程安全
+ * @details
+ *      数量上限在添加时检查，显存上限在渲染线程更新后检查，均从最早添加的可淘汰UIItem开始删除
+ * @param max_items     输入的可淘汰UIItem的数量上限，0表示不限制
+ * @param max_gpu_bytes 输入的全部UIItem的显存上限，0表示不限制
+ */
+void View3D::SetEvictionPolicy(std::size_t max_items, std::size_t max_gpu_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_items_ = max_items;
+    max_gpu_bytes_ = max_gpu_bytes;
+    Evict();
+    RequestRedraw();
+}
+
+/// 查找句柄对应的稠密下标，句柄已失效时返回kNone，需持有mutex_
+std::uint32_t View3D::Find(const ItemHandle &handle) const {
+    if (handle.index_ >= slots_.size())
+        return kNone;
+
+    const Slot &slot = slots_[handle.index_];
+    if (slot.generation_ != handle.generation_)
+        return kNone;
+    return slot.dense_;
+}
+
+/**
+ * @brief 删除稠密下标处的UIItem，需持有mutex_
+ * @details
+ *      1. 末尾元素移动到被删除的位置，并修正其槽位记录的稠密下标，代价为O(1)
+ *      2. 槽位代数递增后回收，旧句柄随之失效
+ *      3. UIItem注销脏队列后移入retired_items_，由渲染线程释放
+ *      4. 同时从BVH和unbounded_slots_中移除
+ * @param dense 输入的稠密下标
+ */
+void View3D::RemoveAt(std::uint32_t dense) {
+    std::uint32_t slot_id = items_[dense].slot_;
+    const Slot slot = slots_[slot_id];
+
+    if (slot.evictable_) {
+        if (slot.older_ != kNone)
+            slots_[slot.older_].newer_ = slot.newer_;
+        else
+            oldest_ = slot.newer_;
+        if (slot.newer_ != kNone)
+            slots_[slot.newer_].older_ = slot.older_;
+        else
+            newest_ = slot.older_;
+        --evictable_num_;
+    }
+
+    total_gpu_bytes_ -= items_[dense].gpu_bytes_;
+    if (items_[dense].proxy_ != AabbTree::kNull)
+        tree_.Remove(items_[dense].proxy_);
+    SetBounded(items_[dense], true);
+    items_[dense].item_->RemoveDirtyQueue(dirty_queue_.get());
+    retired_items_.push_back(std::move(items_[dense].item_));
+    if (dense + 1 != items_.size()) {
+        items_[dense] = std::move(items_.back());
+        slots_[items_[dense].slot_].dense_ = dense;
+    }
+    items_.pop_back();
+
+    slots_[slot_id] = Slot();
+    slots_[slot_id].generation_ = slot.generation_ + 1;
+    free_slots_.push_back(slot_id);
+}
 /**
  * @brief 向View 3d中设置相机，仅初始化阶段调用，非线程安全
  *
@@ -54,6 +390,47 @@ void View3D::AddUIItem(UIItem::Ptr ui_item) {
 void View3D::SetCamera(Camera::Ptr camera) {
     camera_ = std::move(camera);
     camera_->BindDisplay(name_);
+    camera_->SetScheduler(std::atomic_load(&scheduler_));
+}
+
+/**
+ * @brief 设置所在窗口的帧调度器，WindowImpl添加View时调用
+ * @details
+ *      调度器同时交给脏队列和相机，ui_item的更新和相机状态的变化都会唤醒渲染循环
+ * @param scheduler 输入的帧调度器
+ */
+void View3D::SetScheduler(FrameScheduler::Ptr scheduler) {
+    dirty_queue_->SetScheduler(scheduler);
+    if (camera_)
+        camera_->SetScheduler(scheduler);
+    View::SetScheduler(std::move(scheduler));
+}
+
+/**
+ * @brief 按照淘汰策略删除最早添加的可淘汰UIItem，需持有mutex_
+ *
+ */
+void View3D::Evict() {
+    while (oldest_ != kNone) {
+        bool over_items = max_items_ && evictable_num_ > max_items_;
+        bool over_bytes = max_gpu_bytes_ && total_gpu_bytes_ > max_gpu_bytes_;
+        if (!over_items && !over_bytes)
+            break;
+
+        RemoveAt(slots_[oldest_].dense_);
+    }
+}
+
+/// 获取分组下标，不存在时创建，新分组默认可见，需持有mutex_
+int View3D::GroupIndex(const std::string &group) {
+    auto iter = group_index_.find(group);
+    if (iter != group_index_.end())
+        return iter->second;
+
+    int index = group_visible_.size();
+    group_index_.emplace(group, index);
+    group_visible_.push_back(true);
+    return index;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include "slam_viewer/core/Frustum.h"
+#include "slam_viewer/ui/VoxelMapUI.hpp"
+
+namespace slam_viewer {
+
+/**
+ * @brief 体素哈希地图UI的构造函数
+ *
+ * @param voxel_size    输入的体素大小
+ * @param color         输入的颜色
+ * @param line_width    输入的线宽
+ * @param point_size    输入的点大小
+ */
+VoxelMapUI::VoxelMapUI(float voxel_size, Vec3 color, float line_width, float point_size)
+    : UIItem(color, line_width, point_size)
+    , voxel_size_(voxel_size)
+    , voxel_num_(0)
+    , need_reset_(false)
+    , slot_end_(0)
+    , xyz_buffer_(GL_FLOAT, 3)
+    , color_buffer_(GL_FLOAT, 4) {}
+
+/**
+ * @brief 并行插入点，非渲染线程调用
+ * @details
+ *      1. 点的坐标按照voxel_size_量化为体素坐标，体素坐标再按kBlockDim划分为体素块和块内索引
+ *      2. 各线程通过concurrent_hash_map的accessor独占访问体素块，同一体素仅保留第一个到达的点；
+ *         并行阶段只共享持有blocks_mutex_，不持有mutex_，多个生产者和渲染线程的拷贝之间只在同一体素块上竞争
+ *      3. 首次产生新增点的体素块在并行阶段结束后，以一次短暂的加锁追加到脏块列表中，供渲染线程增量上传
+ * @param cloud_xyz     输入的地图坐标系下的点
+ * @param cloud_color   输入的点的颜色
+ */
+void VoxelMapUI::InsertPoints(const std::vector<Vec3> &cloud_xyz, const std::vector<Vec4> &cloud_color) {
+    const float inv_voxel_size = 1.0f / voxel_size_;
+    tbb::concurrent_vector<BlockKey> dirty_blocks;
+
+    auto insert_range = [&](const tbb::blocked_range<std::size_t> &range) {
+        std::size_t new_voxels = 0;
+        for (std::size_t i = range.begin(); i < range.end(); ++i) {
+            const Vec3 &pt = cloud_xyz[i];
+            Eigen::Vector3i voxel = (pt * inv_voxel_size).array().floor().cast<int>();
+
+            /// kBlockDim为8，算术右移和按位与分别实现向下取整的除法和非负取模
+            BlockKey key{voxel.x() >> 3, voxel.y() >> 3, voxel.z() >> 3};
+            int local = ((voxel.z() & 7) * kBlockDim + (voxel.y() & 7)) * kBlockDim + (voxel.x() & 7);
+
+            BlockMap::accessor accessor;
+            blocks_.insert(accessor, key);
+            Block &block = accessor->second;
+            if (block.occupied_.test(local))
+                continue;
+
+            block.occupied_.set(local);
+            block.xyz_.push_back(pt);
+            block.color_.push_back(cloud_color[i]);
+            ++new_voxels;
+
+            if (!block.dirty_) {
+                block.dirty_ = true;
+                dirty_blocks.push_back(key);
+            }
+        }
+        voxel_num_.fetch_add(new_voxels);
+    };
+
+    {
+        std::shared_lock<std::shared_mutex> blocks_lock(blocks_mutex_);
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, cloud_xyz.size()), insert_range);
+    }
+
+    if (dirty_blocks.empty())
+        return;
+
+    {
+        auto lock = ProducerLock();
+        dirty_blocks_.insert(dirty_blocks_.end(), dirty_blocks.begin(), dirty_blocks.end());
+    }
+    MarkUpdate();
+}
+
+/**
+ * @brief 在槽位缓冲区末尾为体素块分配一个显存槽位
+ * @details
+ *      槽位记录体素块的包围盒，用于槽位级的视锥体剔除
+ * @param key           输入的体素块索引
+ * @param capacity      输入的槽位容量
+ * @return std::size_t  输出的槽位编号
+ */
+std::size_t VoxelMapUI::AllocateSlot(const BlockKey &key, std::size_t capacity) {
+    float block_size = voxel_size_ * kBlockDim;
+    Vec3 min = Vec3(key.x_, key.y_, key.z_) * block_size;
+    Eigen::AlignedBox3f box(min, min + Vec3::Constant(block_size));
+    ExtendLocalBounds(box);
+
+    slot_firsts_.push_back(slot_end_);
+    slot_counts_.push_back(0);
+    slot_boxes_.push_back(box);
+    slot_end_ += capacity;
+    return slot_firsts_.size() - 1;
+}
+
+/**
+ * @brief 上传体素块的新增点
+ * @details
+ *      体素块的点按插入顺序存放在其槽位中，槽位容量从kMinSlotPoints开始逐个翻倍，
+ *      只有1、2个体素的体素块也只占用kMinSlotPoints个点的显存，每个体素块浪费的显存不超过其点数；
+ *      槽位写满后再为其分配下一个槽位，已上传的点不会再次传输
+ * @param staged 输入的暂存区中的体素块
+ */
+void VoxelMapUI::UploadStaged(const StagedBlock &staged) {
+    std::vector<std::size_t> &slots = block_slots_[staged.key_];
+    std::size_t begin = staged.begin_, offset = staged.offset_, num = staged.num_;
+    std::size_t slot_id = 0, slot_begin = 0;
+    while (num > 0) {
+        std::size_t capacity = SlotCapacity(slot_id);
+        if (begin >= slot_begin + capacity) {
+            slot_begin += capacity;
+            ++slot_id;
+            continue;
+        }
+        if (slot_id >= slots.size())
+            slots.push_back(AllocateSlot(staged.key_, capacity));
+
+        std::size_t slot = slots[slot_id];
+        std::size_t in_slot = begin - slot_begin;
+        std::size_t count = std::min(num, capacity - in_slot);
+        xyz_buffer_.Upload(staged_xyz_.data() + offset, slot_firsts_[slot] + in_slot, count);
+        color_buffer_.Upload(staged_color_.data() + offset, slot_firsts_[slot] + in_slot, count);
+        slot_counts_[slot] = in_slot + count;
+
+        begin += count;
+        offset += count;
+        num -= count;
+    }
+}
+
+/**
+ * @brief 更新函数，渲染线程调用，仅处理脏块列表中的体素块
+ * @details
+ *      1. 在mutex_下交换出脏块列表和重置标志，加锁时间与地图规模无关
+ *      2. 共享持有blocks_mutex_，逐个体素块通过accessor将新增点拷贝到暂存区，生产者只在同一体素块上等待拷贝
+ *      3. 释放全部锁后再上传到显存，上传期间生产者可以继续插入
+ */
+void VoxelMapUI::Update() {
+    if (!ConsumeUpdate())
+        return;
+
+    bool need_reset = false;
+    update_blocks_.clear();
+    {
+        std::shared_lock<std::shared_mutex> blocks_lock(blocks_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            update_blocks_.swap(dirty_blocks_);
+            std::swap(need_reset, need_reset_);
+        }
+
+        staged_blocks_.clear();
+        staged_xyz_.clear();
+        staged_color_.clear();
+        for (const auto &key : update_blocks_) {
+            BlockMap::accessor accessor;
+            if (!blocks_.find(accessor, key))
+                continue;
+
+            Block &block = accessor->second;
+            block.dirty_ = false;
+            if (block.staged_ == block.xyz_.size())
+                continue;
+
+            staged_blocks_.push_back({key, block.staged_, staged_xyz_.size(), block.xyz_.size() - block.staged_});
+            staged_xyz_.insert(staged_xyz_.end(), block.xyz_.begin() + block.staged_, block.xyz_.end());
+            staged_color_.insert(staged_color_.end(), block.color_.begin() + block.staged_, block.color_.end());
+            block.staged_ = block.xyz_.size();
+        }
+    }
+
+    if (need_reset) {
+        block_slots_.clear();
+        slot_end_ = 0;
+        slot_firsts_.clear();
+        slot_counts_.clear();
+        slot_boxes_.clear();
+        SetLocalBounds(Eigen::AlignedBox3f());
+        xyz_buffer_.Resize(0);
+        color_buffer_.Resize(0);
+    }
+
+    for (const auto &staged : staged_blocks_)
+        UploadStaged(staged);
+}
+
+/**
+ * @brief 渲染函数，在地图坐标系中与视锥体求交，视野内的槽位通过一次glMultiDrawArrays绘制
+ *
+ */
+void VoxelMapUI::Render() {
+    if (!IsValid())
+        return;
+
+    Mat4 Twi;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Twi = Twi_.matrix();
+    }
+
+    glPushMatrix();
+    glMultMatrixf(Twi.data());
+    visible_firsts_.clear();
+    visible_counts_.clear();
+    Frustum frustum = Frustum::FromGlState();
+    for (std::size_t slot = 0; slot < slot_firsts_.size(); ++slot) {
+        if (!frustum.Intersects(slot_boxes_[slot]))
+            continue;
+        visible_firsts_.push_back(slot_firsts_[slot]);
+        visible_counts_.push_back(slot_counts_[slot]);
+    }
+
+    glPointSize(point_size_);
+    RenderBuffer(xyz_buffer_, &color_buffer_, GL_POINTS, visible_firsts_.data(), visible_counts_.data(),
+                 visible_firsts_.size());
+    glPointSize(1.0);
+    glPopMatrix();
+}
+
+/// 清理函数，独占持有blocks_mutex_，等待进行中的插入和拷贝结束；显存保留，下次更新时重新分配槽位
+void VoxelMapUI::Clear() {
+    std::unique_lock<std::shared_mutex> blocks_lock(blocks_mutex_);
+    auto lock = ProducerLock();
+    blocks_.clear();
+    dirty_blocks_.clear();
+    voxel_num_.store(0);
+    need_reset_ = true;
+    MarkUpdate();
+}
+
+/**
+ * @brief 重置地图在世界坐标系下的位姿
+ * @details
+ *      体素按地图坐标系划分，位姿变化不改变体素哈希和槽位，只替换模型矩阵；
+ *      之后插入的世界坐标系下的点按新的Twi_变换到地图坐标系后再体素化
+ * @param Twi 输入的新的位姿
+ */
+void VoxelMapUI::ResetTwi(const SE3 &Twi) {
+    {
+        auto lock = ProducerLock();
+        Twi_ = Twi;
+    }
+    MarkMoved();
+}
+
+} // namespace slam_viewer
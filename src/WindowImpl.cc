@@ -8,48 +8,270 @@ namespace slam_viewer{
  * @param win_name  输入的窗口名称
  * @param width     输入的窗口宽度
  * @param height    输入的窗口高度
- * @param cam_focus 输入的焦距
- * @param cam_z_near 输入的最近可视距离
- * @param cam_z_far  输入的远视可视距离
+ * @param backend   输入的窗口后端，Headless使用pangolin的EGL无窗口上下文，不需要显示器
  */
-WindowImpl::WindowImpl(std::string win_name, int width, int height)
+WindowImpl::WindowImpl(std::string win_name, int width, int height, Backend backend)
     : window_name_(std::move(win_name))
     , width_(std::move(width))
     , height_(std::move(height))
-    , request_stop_(false) {
-    pangolin::CreateWindowAndBind(window_name_, width_, height_);
+    , backend_(backend)
+    , context_ready_(false)
+    , request_stop_(false)
+    , scheduler_(std::make_shared<FrameScheduler>())
+    , stats_overlay_(false) {
+    if (backend_ == Backend::Headless)
+        pangolin::CreateWindowAndBind(window_name_, width_, height_, pangolin::Params({{"scheme", "headless"}}));
+    else
+        pangolin::CreateWindowAndBind(window_name_, width_, height_);
     pangolin::GetBoundWindow()->RemoveCurrent(); ///< 将该窗口从主线程中移除
 }
 
 /**
- * @brief 窗口运行主流程，可以单独线程运行
+ * @brief 初始化渲染线程的OpenGL状态，Run和RenderOnce共用，仅第一次调用时生效
  * @details
- *      1. 3D空间的可视化
- *      2. 图像可视化
- *      3. plot可视化部分在pangolin中已经做好了，线程安全
+ *      1. 将上下文绑定到当前线程并标记为渲染线程，设置深度测试和混合，并创建View布局
+ *      2. Window后端将输入事件连接到帧调度器
+ *      3. Headless后端创建与窗口同尺寸的离屏帧缓冲，不依赖pbuffer表面是否可读
  */
-void WindowImpl::Run() {
+void WindowImpl::InitContext() {
+    if (context_ready_)
+        return;
+
     pangolin::BindToContext(window_name_);
+    ThreadRenderCounters().render_thread_ = true;
 
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     CreateDisplayLayout();
+    if (backend_ == Backend::Window) {
+        ConnectInputSignals();
+    } else {
+        color_texture_ = std::make_unique<pangolin::GlTexture>(width_, height_, GL_RGBA8, false, 0, GL_RGBA,
+                                                               GL_UNSIGNED_BYTE);
+        depth_buffer_ = std::make_unique<pangolin::GlRenderBuffer>(width_, height_, GL_DEPTH_COMPONENT24);
+        framebuffer_ = std::make_unique<pangolin::GlFramebuffer>(*color_texture_, *depth_buffer_);
+    }
+    context_ready_ = true;
+}
+
+/**
+ * @brief 清空并绘制一帧，Headless后端绑定离屏帧缓冲，绘制结束后仍保持绑定，供读回使用
+ */
+void WindowImpl::DrawFrame() {
+    if (framebuffer_)
+        framebuffer_->Bind();
+
+    glClearColor(1.0, 1.0, 1.0, 1.0);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    Render();
+
+    if (stats_overlay_.load())
+        DrawStatsOverlay(GetFrameStats());
+}
+
+/**
+ * @brief 在窗口左上角绘制渲染统计，仅渲染线程调用
+ * @details
+ *      1. 第一行为整帧的渲染时间、绘制调用、点数、上传量和生产者等待，之后每个View一行
+ *      2. 以整个窗口为视口按照像素坐标绘制，关闭深度测试，文字始终位于所有View之上；叠加层本身的绘制不计入统计
+ * @param stats 输入的最近一帧的渲染统计
+ */
+void WindowImpl::DrawStatsOverlay(const FrameStats &stats) {
+    std::vector<std::string> lines;
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer), "frame %zu: %.2f ms, %zu draws, %.1fk pts, %.1f KB, wait %.2f ms (%zu)",
+                  stats.frame_id_, stats.render_ms_, stats.draw_calls_, stats.points_ * 1e-3,
+                  stats.upload_bytes_ / 1024.0, stats.producer_wait_ms_, stats.producer_contended_num_);
+    lines.emplace_back(buffer);
+    for (const auto &view_stats : stats.views_) {
+        std::snprintf(buffer, sizeof(buffer), "  %s: %.2f ms, %zu draws, %.1fk pts, %.1f KB", view_stats.name_.c_str(),
+                      view_stats.render_ms_, view_stats.draw_calls_, view_stats.points_ * 1e-3,
+                      view_stats.upload_bytes_ / 1024.0);
+        lines.emplace_back(buffer);
+    }
+
+    pangolin::View &display = pangolin::DisplayBase();
+    display.Activate();
+    glDisable(GL_DEPTH_TEST);
+    glColor3f(0.0, 0.0, 0.0);
+    float y = display.v.h - kOverlayMargin - kOverlayLineHeight;
+    for (const auto &line : lines) {
+        pangolin::default_font().Text(line).DrawWindow(display.v.l + kOverlayMargin, display.v.b + y);
+        y -= kOverlayLineHeight;
+    }
+    glEnable(GL_DEPTH_TEST);
+}
+
+/**
+ * @brief 读回当前帧缓冲的图像
+ * @details
+ *      OpenGL的行序自下而上，读回后上下翻转为OpenCV的行序；打包对齐设置为1，宽度不是4的倍数时也不会错行
+ * @param image 输出的BGR图像，尺寸与窗口相同
+ */
+void WindowImpl::ReadPixels(cv::Mat &image) {
+    cv::Mat flipped(height_, width_, CV_8UC3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width_, height_, GL_BGR, GL_UNSIGNED_BYTE, flipped.data);
+    cv::flip(flipped, image, 0);
+}
+
+/**
+ * @brief 同步渲染一帧并读回图像，仅渲染线程调用，不能与Run同时使用
+ * @details
+ *      1. 不经过帧调度器和事件循环，每次调用都完整地更新并绘制一帧，可以以最大吞吐量离线渲染
+ *      2. 同一场景在相同的相机位姿下得到相同的图像，Headless后端配合Mesa的软件渲染可在无显示器的环境中使用
+ *      3. Window后端读回的是后缓冲，读回后交换缓冲并处理窗口事件
+ * @param image 输出的BGR图像
+ */
+void WindowImpl::RenderOnce(cv::Mat &image) {
+    InitContext();
+
+    scheduler_->BeginFrame();
+    DrawFrame();
+    CaptureFrame();
+    glFinish();
+    ReadPixels(image);
+
+    if (framebuffer_)
+        framebuffer_->Unbind();
+    else
+        pangolin::FinishFrame();
+}
+
+/**
+ * @brief 窗口运行主流程，可以单独线程运行
+ * @details
+ *      1. 3D空间的可视化
+ *      2. 图像可视化
+ *      3. plot可视化部分在pangolin中已经做好了，线程安全
+ *      4. 只有ui_item更新、View或相机状态变化以及窗口有输入时才重绘，帧率由帧调度器限制在目标帧率以内；
+ *         空闲时渲染线程在调度器上等待，只按照轮询频率处理窗口事件
+ *      5. Headless后端绘制到离屏帧缓冲，没有输入事件，只在场景变化时重绘
+ *      6. 退出循环后在上下文仍然有效时结束录制，PBO中尚未读回的帧写入视频后才返回
+ */
+void WindowImpl::Run() {
+    InitContext();
 
     while (!pangolin::ShouldQuit() && !request_stop_.load()) {
-        glClearColor(1.0, 1.0, 1.0, 1.0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        bool redraw = scheduler_->WaitForFrame();
+        for (const auto &view : views_)
+            view->ProcessEvents();
 
-        Render();
+        if (!redraw) {
+            pangolin::GetBoundWindow()->ProcessEvents();
+            continue;
+        }
+
+        scheduler_->BeginFrame();
+        DrawFrame();
+        CaptureFrame();
+        if (framebuffer_)
+            framebuffer_->Unbind();
         pangolin::FinishFrame();
-        cv::waitKey(30);
     }
+
+    FinishRecording();
+}
+
+/**
+ * @brief 将窗口的输入事件连接到帧调度器，仅渲染线程在绑定上下文后调用
+ * @details
+ *      鼠标、键盘和窗口尺寸变化都会请求重绘，鼠标悬停不改变显示内容，不请求重绘；
+ *      事件在FinishFrame或空闲轮询的ProcessEvents中分发，下一次循环即重绘
+ */
+void WindowImpl::ConnectInputSignals() {
+    pangolin::WindowInterface *window = pangolin::GetBoundWindow();
+    if (!window)
+        return;
+
+    FrameScheduler::Ptr scheduler = scheduler_;
+    auto request_redraw = [scheduler](auto &&...) { scheduler->RequestRedraw(); };
+    window->MouseSignal.connect(request_redraw);
+    window->MouseMotionSignal.connect(request_redraw);
+    window->KeyboardSignal.connect(request_redraw);
+    window->SpecialInputSignal.connect(request_redraw);
+    window->ResizeSignal.connect(request_redraw);
+}
+
+/**
+ * @brief 开始录制，任意线程调用
+ * @details
+ *      帧录制器在渲染线程的下一帧开始读回；按需重绘时只录制实际重绘的帧，
+ *      需要时间均匀的视频时配合SetContinuous(true)使用
+ * @param path                  输入的输出路径，包含'%'时为图像序列的printf格式，如"frames/%06d.png"
+ * @param fps                   输入的视频帧率
+ * @param queue_size            输入的编码队列的最大帧数
+ * @param policy                输入的队列满时的策略
+ * @return FrameRecorder::Ptr   输出的帧录制器，可用于查询录制和丢帧数量
+ */
+FrameRecorder::Ptr WindowImpl::StartRecording(std::string path, double fps, std::size_t queue_size,
+                                              FrameRecorder::QueuePolicy policy) {
+    auto recorder = std::make_shared<FrameRecorder>(std::move(path), fps, queue_size, policy);
+    std::atomic_store(&recorder_, recorder);
+    scheduler_->RequestRedraw();
+    return recorder;
+}
+
+/// 结束录制，任意线程调用，请求一次重绘保证渲染线程及时释放录制资源
+void WindowImpl::StopRecording() {
+    std::atomic_store(&recorder_, FrameRecorder::Ptr());
+    scheduler_->RequestRedraw();
+}
+
+/**
+ * @brief 将当前帧交给帧录制器，仅渲染线程在绘制完成、交换缓冲之前调用
+ * @details
+ *      1. 请求的帧录制器变化时结束正在录制的帧录制器，其编码线程在后台写完剩余的帧
+ *      2. 编码线程退出后才释放结束的帧录制器，析构时的join不会阻塞渲染线程
+ *      3. 读回整个窗口，只发起异步读回，录制带来的额外开销为一次PBO映射和一帧像素的拷贝
+ */
+void WindowImpl::CaptureFrame() {
+    FrameRecorder::Ptr recorder = std::atomic_load(&recorder_);
+    if (recorder != active_recorder_) {
+        if (active_recorder_) {
+            active_recorder_->Finish();
+            finishing_recorders_.push_back(std::move(active_recorder_));
+        }
+        active_recorder_ = std::move(recorder);
+    }
+
+    finishing_recorders_.erase(std::remove_if(finishing_recorders_.begin(), finishing_recorders_.end(),
+                                              [](const FrameRecorder::Ptr &recorder) { return recorder->Done(); }),
+                               finishing_recorders_.end());
+
+    if (active_recorder_) {
+        const pangolin::Viewport &viewport = pangolin::DisplayBase().v;
+        active_recorder_->Capture(viewport.w, viewport.h);
+    }
+}
+
+/**
+ * @brief 结束全部录制，仅渲染线程在退出渲染循环、上下文销毁之前调用
+ * @details
+ *      1. 正在录制的帧录制器读回PBO环中未完成的帧并释放PBO和同步对象，不会在上下文销毁后或其他线程中析构显存
+ *      2. 清空请求的帧录制器，之后的RenderOnce不会继续使用已经结束的帧录制器
+ *      3. 等待各帧录制器的编码线程写完剩余的帧后释放，外部仍持有帧录制器时也保证文件已经写完
+ */
+void WindowImpl::FinishRecording() {
+    std::atomic_store(&recorder_, FrameRecorder::Ptr());
+    if (active_recorder_) {
+        active_recorder_->Finish();
+        finishing_recorders_.push_back(std::move(active_recorder_));
+    }
+
+    for (const auto &recorder : finishing_recorders_) {
+        while (!recorder->Done())
+            std::this_thread::sleep_for(1ms);
+    }
+    finishing_recorders_.clear();
 }
 
 /// 添加渲染View
 void WindowImpl::AddView(View::Ptr view, pangolin::Attach bottom, pangolin::Attach top, pangolin::Attach left,
                          pangolin::Attach right, pangolin::Layout layout) {
+    view->SetScheduler(scheduler_);
     views_.push_back(view);
     auto task = [=]() {
         view->CreateDisplayLayout(layout);
@@ -72,12 +294,61 @@ void WindowImpl::CreateDisplayLayout() {
 }
 
 /**
- * @brief 渲染窗口内的所有View
- *
+ * @brief 渲染窗口内的所有View，并统计本帧的渲染开销
+ * @details
+ *      1. 每个View的渲染时间、绘制调用、绘制的点数和上传字节数由渲染线程计数器在Render前后的差值得到
+ *      2. 生产者等待ui_item互斥量的时间取全局统计在两帧之间的差值
+ *      3. 设置了统计Plotter时记录本帧的统计，不请求重绘
  */
 void WindowImpl::Render() {
-    for (size_t i = 0; i < views_.size(); ++i)
+    const RenderCounters &counters = ThreadRenderCounters();
+    FrameStats stats;
+    stats.views_.resize(views_.size());
+    for (size_t i = 0; i < views_.size(); ++i) {
+        RenderCounters before = counters;
+        auto start = std::chrono::steady_clock::now();
         views_[i]->Render();
+
+        ViewStats &view_stats = stats.views_[i];
+        view_stats.name_ = views_[i]->GetName();
+        view_stats.render_ms_ = ElapsedMs(start, std::chrono::steady_clock::now());
+        view_stats.draw_calls_ = counters.draw_calls_ - before.draw_calls_;
+        view_stats.points_ = counters.points_ - before.points_;
+        view_stats.upload_bytes_ = counters.upload_bytes_ - before.upload_bytes_;
+
+        stats.render_ms_ += view_stats.render_ms_;
+        stats.draw_calls_ += view_stats.draw_calls_;
+        stats.points_ += view_stats.points_;
+        stats.upload_bytes_ += view_stats.upload_bytes_;
+    }
+
+    LockStats lock_stats = LockProfiler::GlobalStats();
+    stats.producer_wait_ms_ = lock_stats.producer_wait_ms_ - last_lock_stats_.producer_wait_ms_;
+    stats.producer_contended_num_ = lock_stats.producer_contended_num_ - last_lock_stats_.producer_contended_num_;
+    last_lock_stats_ = lock_stats;
+    stats.frame_id_ = scheduler_->FrameCount();
+
+    if (stats_plotter_)
+        stats_plotter_->LogPlotterItem(stats_plot_name_, stats.PlotValues());
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    frame_stats_ = std::move(stats);
+}
+
+/**
+ * @brief 将每帧的渲染统计记录到Plotter中，在渲染线程启动之前的初始化阶段使用
+ * @details
+ *      在plotter中添加名为plot_name的绘图元素，标签为FrameStats::PlotLabels；plotter需要另外通过AddView添加到窗口
+ * @param plotter   输入的Plotter
+ * @param plot_name 输入的绘图元素名称
+ * @param frames    输入的横轴显示的帧数
+ * @param y_max     输入的纵轴上限，各统计量共用一个纵轴
+ */
+void WindowImpl::SetStatsPlotter(Plotter::Ptr plotter, std::string plot_name, float frames, float y_max) {
+    plotter->AddPlotterItem(plot_name, FrameStats::PlotLabels(), -frames / 60, frames, 0, y_max,
+                            frames / kStatsPlotTicks, y_max / kStatsPlotTicks);
+    stats_plotter_ = std::move(plotter);
+    stats_plot_name_ = std::move(plot_name);
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cmath>
+
+#include "slam_viewer/core/Types.h"
+
+namespace slam_viewer {
+
+/**
+ * @brief 构造OpenGL列主序的透视投影矩阵，与gluPerspective一致
+ *
+ * @param fovy      输入的垂直视场角（度）
+ * @param aspect    输入的宽高比
+ * @param z_near    输入的近平面距离
+ * @param z_far     输入的远平面距离
+ * @return Mat4     输出的投影矩阵
+ */
+inline Mat4 Perspective(float fovy, float aspect, float z_near, float z_far) {
+    float f = 1.0f / std::tan(fovy * static_cast<float>(M_PI) / 360.0f);
+    Mat4 proj = Mat4::Zero();
+    proj(0, 0) = f / aspect;
+    proj(1, 1) = f;
+    proj(2, 2) = (z_far + z_near) / (z_near - z_far);
+    proj(2, 3) = 2.0f * z_far * z_near / (z_near - z_far);
+    proj(3, 2) = -1.0f;
+    return proj;
+}
+
+/// 位于eye处、沿-z方向观察的模型视图矩阵
+inline Mat4 LookAlongNegZ(const Vec3 &eye) {
+    Mat4 model_view = Mat4::Identity();
+    model_view.topRightCorner<3, 1>() = -eye;
+    return model_view;
+}
+
+/// 由最小点和最大点构造包围盒
+inline Eigen::AlignedBox3f Box(const Vec3 &min, const Vec3 &max) { return Eigen::AlignedBox3f(min, max); }
+
+} // namespace slam_viewer
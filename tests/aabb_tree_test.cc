@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "slam_viewer/core/AabbTree.h"
+
+using namespace slam_viewer;
+
+namespace {
+
+/// 与AabbTree一致的放大包围盒，查询结果不会超出该范围
+Eigen::AlignedBox3f Fatten(const Eigen::AlignedBox3f &box) {
+    Vec3 margin = (box.sizes() * AabbTree::kMarginRatio).cwiseMax(AabbTree::kMinMargin);
+    return Eigen::AlignedBox3f(box.min() - margin, box.max() + margin);
+}
+
+/// 查询视锥体内的全部user，同时检查每个user只返回一次
+std::set<std::uint32_t> QueryAll(const AabbTree &tree, const Frustum &frustum) {
+    std::set<std::uint32_t> users;
+    tree.Query(frustum, [&](std::uint32_t user) { EXPECT_TRUE(users.insert(user).second) << user; });
+    return users;
+}
+
+/// AVL树的高度上界
+std::int32_t MaxHeight(std::size_t leaf_num) {
+    return static_cast<std::int32_t>(std::ceil(1.45 * std::log2(static_cast<double>(2 * leaf_num)))) + 1;
+}
+
+/// 覆盖[-60, 60]^3的视锥体
+Frustum WholeScene() { return Frustum(Perspective(90.0f, 1.0f, 1.0f, 1000.0f) * LookAlongNegZ(Vec3(0, 0, 200))); }
+
+/// 只看到x大于0一侧的一部分场景
+Frustum PartialScene() { return Frustum(Perspective(40.0f, 1.0f, 1.0f, 80.0f) * LookAlongNegZ(Vec3(20, 0, 60))); }
+
+} // namespace
+
+/// 空树不返回任何结果
+TEST(AabbTreeTest, EmptyTree) {
+    AabbTree tree;
+    EXPECT_EQ(tree.Size(), 0u);
+    EXPECT_EQ(tree.Height(), 0);
+    EXPECT_TRUE(QueryAll(tree, WholeScene()).empty());
+}
+
+/// 查询结果包含全部与视锥体相交的包围盒，且不超出放大后的包围盒
+TEST(AabbTreeTest, QueryMatchesBruteForce) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-50.0f, 50.0f), size(0.01f, 2.0f);
+
+    AabbTree tree;
+    std::vector<Eigen::AlignedBox3f> boxes;
+    for (std::uint32_t i = 0; i < 2000; ++i) {
+        Vec3 min(position(rng), position(rng), position(rng));
+        boxes.emplace_back(min, min + Vec3(size(rng), size(rng), size(rng)));
+        tree.Insert(boxes.back(), i);
+    }
+    EXPECT_EQ(tree.Size(), boxes.size());
+    EXPECT_LE(tree.Height(), MaxHeight(boxes.size()));
+
+    EXPECT_EQ(QueryAll(tree, WholeScene()).size(), boxes.size());
+
+    Frustum frustum = PartialScene();
+    auto users = QueryAll(tree, frustum);
+    std::size_t visible_num = 0;
+    for (std::uint32_t i = 0; i < boxes.size(); ++i) {
+        if (frustum.Intersects(boxes[i])) {
+            EXPECT_TRUE(users.count(i)) << i;
+            ++visible_num;
+        }
+        if (users.count(i)) {
+            EXPECT_TRUE(frustum.Intersects(Fatten(boxes[i]))) << i;
+        }
+    }
+    EXPECT_GT(visible_num, 0u);
+    EXPECT_LT(users.size(), boxes.size());
+}
+
+/// 删除后的user不再返回，空闲节点被后续插入复用
+TEST(AabbTreeTest, RemoveAndReinsert) {
+    AabbTree tree;
+    std::vector<std::int32_t> proxies;
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        Vec3 min(i % 10 * 5.0f - 25.0f, i / 10 * 5.0f - 25.0f, 0.0f);
+        proxies.push_back(tree.Insert(Box(min, min + Vec3::Ones()), i));
+    }
+
+    for (std::uint32_t i = 0; i < 100; i += 2)
+        tree.Remove(proxies[i]);
+    EXPECT_EQ(tree.Size(), 50u);
+    EXPECT_LE(tree.Height(), MaxHeight(50));
+
+    auto users = QueryAll(tree, WholeScene());
+    EXPECT_EQ(users.size(), 50u);
+    for (auto user : users)
+        EXPECT_EQ(user % 2, 1u);
+
+    std::int32_t proxy = tree.Insert(Box(Vec3::Zero(), Vec3::Ones()), 1000);
+    EXPECT_NE(proxy, AabbTree::kNull);
+    EXPECT_TRUE(QueryAll(tree, WholeScene()).count(1000));
+
+    for (std::uint32_t i = 1; i < 100; i += 2)
+        tree.Remove(proxies[i]);
+    tree.Remove(proxy);
+    EXPECT_EQ(tree.Size(), 0u);
+    EXPECT_EQ(tree.Height(), 0);
+    EXPECT_TRUE(QueryAll(tree, WholeScene()).empty());
+}
+
+/// 在余量内移动不改变树结构，移出余量后重新插入，查询结果跟随新位置
+TEST(AabbTreeTest, Move) {
+    AabbTree tree;
+    tree.Insert(Box(Vec3(-40, -1, -1), Vec3(-38, 1, 1)), 0);
+    std::int32_t proxy = tree.Insert(Box(Vec3(-21, -1, -1), Vec3(-19, 1, 1)), 1);
+
+    EXPECT_FALSE(tree.Move(proxy, Box(Vec3(-20.9f, -1, -1), Vec3(-18.9f, 1, 1))));
+    EXPECT_EQ(tree.Size(), 2u);
+
+    Frustum frustum = PartialScene();
+    EXPECT_FALSE(QueryAll(tree, frustum).count(1));
+
+    EXPECT_TRUE(tree.Move(proxy, Box(Vec3(19, -1, -1), Vec3(21, 1, 1))));
+    EXPECT_EQ(tree.Size(), 2u);
+    auto users = QueryAll(tree, frustum);
+    EXPECT_TRUE(users.count(1));
+    EXPECT_FALSE(users.count(0));
+}
+
+/// 按顺序插入和删除时，旋转保持树的平衡
+TEST(AabbTreeTest, SequentialInsertStaysBalanced) {
+    AabbTree tree;
+    std::vector<std::int32_t> proxies;
+    for (std::uint32_t i = 0; i < 4096; ++i) {
+        float x = i * 0.02f - 40.0f;
+        proxies.push_back(tree.Insert(Box(Vec3(x, 0, 0), Vec3(x + 0.01f, 0.01f, 0.01f)), i));
+        ASSERT_LE(tree.Height(), MaxHeight(tree.Size())) << i;
+    }
+
+    std::mt19937 rng(11);
+    std::shuffle(proxies.begin(), proxies.end(), rng);
+    for (std::size_t i = 0; i < 3072; ++i) {
+        tree.Remove(proxies[i]);
+        ASSERT_LE(tree.Height(), MaxHeight(tree.Size())) << i;
+    }
+    EXPECT_EQ(QueryAll(tree, WholeScene()).size(), 1024u);
+}
@@ -0,0 +1,84 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "slam_viewer/core/BatchQueue.h"
+
+using namespace slam_viewer;
+
+/// 单个生产者时按照压入顺序取出
+TEST(BatchQueueTest, DrainKeepsPushOrder) {
+    BatchQueue<int> queue;
+    EXPECT_TRUE(queue.Empty());
+    EXPECT_EQ(queue.Drain([](int &&) {}), 0);
+
+    for (int i = 0; i < 100; ++i)
+        queue.Push(i);
+    EXPECT_FALSE(queue.Empty());
+
+    std::vector<int> values;
+    EXPECT_EQ(queue.Drain([&](int &&value) { values.push_back(value); }), 100);
+    ASSERT_EQ(values.size(), 100);
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(values[i], i);
+    EXPECT_TRUE(queue.Empty());
+}
+
+/// 批次以移动方式交给处理函数，支持只能移动的类型
+TEST(BatchQueueTest, MoveOnlyBatches) {
+    BatchQueue<std::unique_ptr<int>> queue;
+    queue.Push(std::make_unique<int>(1));
+    queue.Push(std::make_unique<int>(2));
+
+    int sum = 0;
+    queue.Drain([&](std::unique_ptr<int> &&value) { sum += *value; });
+    EXPECT_EQ(sum, 3);
+}
+
+/// 析构时释放尚未取走的批次
+TEST(BatchQueueTest, DestructorReleasesPendingBatches) {
+    auto data = std::make_shared<int>(0);
+    {
+        BatchQueue<std::shared_ptr<int>> queue;
+        queue.Push(data);
+        queue.Push(data);
+        EXPECT_EQ(data.use_count(), 3);
+    }
+    EXPECT_EQ(data.use_count(), 1);
+}
+
+/// 多个生产者与消费者并发时不丢失批次，每个生产者的批次保持压入顺序
+TEST(BatchQueueTest, ConcurrentProducers) {
+    constexpr int kProducers = 4;
+    constexpr int kBatches = 20000;
+
+    BatchQueue<std::pair<int, int>> queue;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < kBatches; ++i)
+                queue.Push({p, i});
+        });
+    }
+
+    std::vector<int> next(kProducers, 0);
+    bool ordered = true;
+    auto consume = [&](std::pair<int, int> &&batch) {
+        ordered = ordered && batch.second == next[batch.first];
+        ++next[batch.first];
+    };
+
+    int total = 0;
+    while (total < kProducers * kBatches)
+        total += queue.Drain(consume);
+    for (auto &producer : producers)
+        producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(total, kProducers * kBatches);
+    EXPECT_TRUE(queue.Empty());
+    for (int p = 0; p < kProducers; ++p)
+        EXPECT_EQ(next[p], kBatches);
+}
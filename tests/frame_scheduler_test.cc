@@ -0,0 +1,106 @@
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "slam_viewer/core/FrameScheduler.h"
+
+using namespace slam_viewer;
+
+namespace {
+
+/// 从start到现在经过的毫秒数
+double ElapsedMs(FrameScheduler::Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(FrameScheduler::Clock::now() - start).count();
+}
+
+} // namespace
+
+/// 构造后存在一次重绘请求，绘制后没有请求时到达轮询时间返回false
+TEST(FrameSchedulerTest, InitialRedrawThenPoll) {
+    FrameScheduler scheduler(0.0, 100.0);
+    EXPECT_TRUE(scheduler.WaitForFrame());
+    scheduler.BeginFrame();
+    EXPECT_EQ(scheduler.FrameCount(), 1u);
+
+    auto start = FrameScheduler::Clock::now();
+    EXPECT_FALSE(scheduler.WaitForFrame());
+    EXPECT_GE(ElapsedMs(start), 8.0);
+    EXPECT_EQ(scheduler.FrameCount(), 1u);
+}
+
+/// 轮询频率小于等于0时，只有其他线程的重绘请求能唤醒渲染线程
+TEST(FrameSchedulerTest, RequestWakesWaitingThread) {
+    FrameScheduler scheduler(0.0, 0.0);
+    scheduler.BeginFrame();
+
+    auto start = FrameScheduler::Clock::now();
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        scheduler.RequestRedraw();
+    });
+    EXPECT_TRUE(scheduler.WaitForFrame());
+    EXPECT_GE(ElapsedMs(start), 40.0);
+    producer.join();
+}
+
+/// 下一帧开始前的多次请求合并为一次
+TEST(FrameSchedulerTest, RequestsCoalesce) {
+    FrameScheduler scheduler(0.0, 100.0);
+    scheduler.BeginFrame();
+    for (int i = 0; i < 3; ++i)
+        scheduler.RequestRedraw();
+
+    EXPECT_TRUE(scheduler.WaitForFrame());
+    scheduler.BeginFrame();
+    EXPECT_FALSE(scheduler.WaitForFrame());
+    EXPECT_EQ(scheduler.FrameCount(), 2u);
+}
+
+/// 持续重绘时不需要请求，关闭后恢复按需重绘，开启时唤醒等待中的渲染线程
+TEST(FrameSchedulerTest, Continuous) {
+    FrameScheduler scheduler(0.0, 0.0);
+    scheduler.BeginFrame();
+
+    std::thread controller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        scheduler.SetContinuous(true);
+    });
+    EXPECT_TRUE(scheduler.WaitForFrame());
+    controller.join();
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(scheduler.WaitForFrame());
+        scheduler.BeginFrame();
+    }
+    EXPECT_EQ(scheduler.FrameCount(), 6u);
+
+    scheduler.SetContinuous(false);
+    scheduler.SetPollRate(100.0);
+    EXPECT_FALSE(scheduler.WaitForFrame());
+}
+
+/// 帧率不超过目标帧率，不限制帧率时不睡眠
+TEST(FrameSchedulerTest, TargetFpsPacing) {
+    FrameScheduler scheduler(50.0, 0.0);
+    scheduler.SetContinuous(true);
+    ASSERT_TRUE(scheduler.WaitForFrame());
+    scheduler.BeginFrame();
+
+    auto start = FrameScheduler::Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(scheduler.WaitForFrame());
+        scheduler.BeginFrame();
+    }
+    double elapsed = ElapsedMs(start);
+    EXPECT_GE(elapsed, 190.0);
+    EXPECT_LT(elapsed, 1000.0);
+
+    scheduler.SetTargetFps(0.0);
+    start = FrameScheduler::Clock::now();
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(scheduler.WaitForFrame());
+        scheduler.BeginFrame();
+    }
+    EXPECT_LT(ElapsedMs(start), 100.0);
+    EXPECT_EQ(scheduler.FrameCount(), 111u);
+}
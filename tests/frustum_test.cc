@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "TestUtils.h"
+#include "slam_viewer/core/Frustum.h"
+
+using namespace slam_viewer;
+
+/// 相机位于原点，沿-z方向观察，视场角90度，近平面1，远平面100
+class FrustumTest : public ::testing::Test {
+protected:
+    Frustum frustum_{Perspective(90.0f, 1.0f, 1.0f, 100.0f) * LookAlongNegZ(Vec3::Zero())};
+};
+
+/// 包围球与视锥体的相交判断
+TEST_F(FrustumTest, SphereIntersection) {
+    EXPECT_TRUE(frustum_.Intersects(Vec3(0, 0, -10), 1.0f));
+    EXPECT_TRUE(frustum_.Intersects(Vec3(10.5f, 0, -10), 1.0f));
+    EXPECT_FALSE(frustum_.Intersects(Vec3(20, 0, -10), 1.0f));
+    EXPECT_FALSE(frustum_.Intersects(Vec3(0, 0, 10), 1.0f));
+    EXPECT_FALSE(frustum_.Intersects(Vec3(0, 0, -200), 1.0f));
+    EXPECT_TRUE(frustum_.Intersects(Vec3(0, 0, -100.5f), 1.0f));
+}
+
+/// 包围盒完全在内、跨越边界和完全在外三种情况
+TEST_F(FrustumTest, BoxIntersectionAndContainment) {
+    auto inside = Box(Vec3(-1, -1, -11), Vec3(1, 1, -9));
+    EXPECT_TRUE(frustum_.Intersects(inside));
+    EXPECT_TRUE(frustum_.Contains(inside));
+
+    auto straddle = Box(Vec3(9, -1, -11), Vec3(11, 1, -9));
+    EXPECT_TRUE(frustum_.Intersects(straddle));
+    EXPECT_FALSE(frustum_.Contains(straddle));
+
+    auto across_near = Box(Vec3(-0.1f, -0.1f, -2), Vec3(0.1f, 0.1f, 2));
+    EXPECT_TRUE(frustum_.Intersects(across_near));
+    EXPECT_FALSE(frustum_.Contains(across_near));
+
+    EXPECT_FALSE(frustum_.Intersects(Box(Vec3(20, -1, -11), Vec3(22, 1, -9))));
+    EXPECT_FALSE(frustum_.Intersects(Box(Vec3(-1, -1, 1), Vec3(1, 1, 3))));
+    EXPECT_FALSE(frustum_.Intersects(Box(Vec3(-1, -1, -300), Vec3(1, 1, -200))));
+}
+
+/// 空包围盒既不相交也不包含
+TEST_F(FrustumTest, EmptyBox) {
+    Eigen::AlignedBox3f empty;
+    EXPECT_FALSE(frustum_.Intersects(empty));
+    EXPECT_FALSE(frustum_.Contains(empty));
+}
+
+/// 模型视图矩阵作用后，平面在世界坐标系下
+TEST(FrustumWorldTest, ModelViewMovesPlanes) {
+    Frustum frustum(Perspective(90.0f, 1.0f, 1.0f, 100.0f) * LookAlongNegZ(Vec3(0, 0, 10)));
+    EXPECT_TRUE(frustum.Contains(Box(Vec3(-1, -1, -1), Vec3(1, 1, 1))));
+    EXPECT_FALSE(frustum.Intersects(Box(Vec3(-1, -1, 11), Vec3(1, 1, 12))));
+    EXPECT_TRUE(frustum.Intersects(Vec3(0, 0, -85), 1.0f));
+    EXPECT_FALSE(frustum.Intersects(Vec3(0, 0, -95), 1.0f));
+}
+
+/// 默认构造的视锥体平面全为0，不剔除任何包围盒
+TEST(FrustumWorldTest, DefaultAcceptsEverything) {
+    Frustum frustum;
+    EXPECT_TRUE(frustum.Intersects(Vec3(1e6f, 0, 0), 0.0f));
+    EXPECT_TRUE(frustum.Intersects(Box(Vec3(-1, -1, -1), Vec3(1, 1, 1))));
+}
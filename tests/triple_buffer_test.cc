@@ -0,0 +1,71 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "slam_viewer/core/TripleBuffer.h"
+
+using namespace slam_viewer;
+
+/// 没有发布时不会获取到新状态，每次发布只能被获取一次
+TEST(TripleBufferTest, FetchOnlyAfterPublish) {
+    TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.Fetch());
+
+    buffer.Publish(1);
+    EXPECT_TRUE(buffer.Fetch());
+    EXPECT_EQ(buffer.Front(), 1);
+    EXPECT_FALSE(buffer.Fetch());
+    EXPECT_EQ(buffer.Front(), 1);
+}
+
+/// 两次获取之间的多次发布只保留最后一次
+TEST(TripleBufferTest, FetchReturnsLatest) {
+    TripleBuffer<int> buffer;
+    for (int i = 1; i <= 5; ++i)
+        buffer.Publish(i);
+
+    EXPECT_TRUE(buffer.Fetch());
+    EXPECT_EQ(buffer.Front(), 5);
+
+    buffer.Publish(6);
+    buffer.Publish(7);
+    EXPECT_TRUE(buffer.Fetch());
+    EXPECT_EQ(buffer.Front(), 7);
+}
+
+/// 并发发布和获取时，获取到的快照完整且单调不减，最终获取到最后一次发布
+TEST(TripleBufferTest, ConcurrentSnapshotsAreComplete) {
+    constexpr int kSnapshots = 20000;
+    constexpr std::size_t kSize = 64;
+
+    TripleBuffer<std::vector<int>> buffer;
+    std::atomic<bool> done(false);
+    std::thread producer([&]() {
+        for (int i = 1; i <= kSnapshots; ++i)
+            buffer.Publish(std::vector<int>(kSize, i));
+        done.store(true);
+    });
+
+    int last = 0;
+    bool complete = true, monotonic = true;
+    while (true) {
+        bool finished = done.load();
+        if (buffer.Fetch()) {
+            const auto &snapshot = buffer.Front();
+            complete = complete && snapshot.size() == kSize;
+            for (const auto &value : snapshot)
+                complete = complete && value == snapshot.front();
+            monotonic = monotonic && snapshot.front() > last;
+            last = snapshot.front();
+        } else if (finished) {
+            break;
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(complete);
+    EXPECT_TRUE(monotonic);
+    EXPECT_EQ(last, kSnapshots);
+}
@@ -0,0 +1,123 @@
+#include <cmath>
+#include <random>
+
+#include <Eigen/Geometry>
+#include <gtest/gtest.h>
+
+#include "slam_viewer/core/Umeyama.h"
+
+using namespace slam_viewer;
+typedef UmeyamaAligner::Vec3d Vec3d;
+typedef UmeyamaAligner::Mat3d Mat3d;
+
+namespace {
+
+/// 随机源点及其经过y = sRx + t变换并加噪声后的目标点
+struct PointPairs {
+    Eigen::Matrix3Xd x_, y_;
+
+    PointPairs(const Mat3d &R, const Vec3d &t, double s, int n, double noise, unsigned seed = 3) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> position(-10.0, 10.0);
+        std::normal_distribution<double> gaussian(0.0, noise > 0 ? noise : 1.0);
+        x_.resize(3, n);
+        y_.resize(3, n);
+        for (int i = 0; i < n; ++i) {
+            x_.col(i) = Vec3d(position(rng), position(rng), position(rng));
+            y_.col(i) = s * R * x_.col(i) + t;
+            if (noise > 0)
+                y_.col(i) += Vec3d(gaussian(rng), gaussian(rng), gaussian(rng));
+        }
+    }
+
+    /// 依次添加到aligner并求解
+    void AddTo(UmeyamaAligner &aligner) const {
+        for (int i = 0; i < x_.cols(); ++i)
+            aligner.Add(x_.col(i), y_.col(i));
+        aligner.Solve();
+    }
+};
+
+/// 测试使用的旋转
+Mat3d TestRotation() { return Eigen::AngleAxisd(0.7, Vec3d(1, -2, 0.5).normalized()).toRotationMatrix(); }
+
+} // namespace
+
+/// 无噪声时恢复真实的旋转和平移
+TEST(UmeyamaTest, RecoversRigidTransform) {
+    Mat3d R = TestRotation();
+    Vec3d t(1.0, -2.0, 3.0);
+    PointPairs pairs(R, t, 1.0, 100, 0.0);
+
+    UmeyamaAligner aligner;
+    pairs.AddTo(aligner);
+    EXPECT_EQ(aligner.Size(), 100u);
+    EXPECT_TRUE(aligner.Rotation().isApprox(R, 1e-9));
+    EXPECT_TRUE(aligner.Translation().isApprox(t, 1e-9));
+    EXPECT_DOUBLE_EQ(aligner.Scale(), 1.0);
+    EXPECT_NEAR(aligner.SquaredError(), 0.0, 1e-6);
+}
+
+/// 估计尺度时恢复真实的尺度，不估计尺度时尺度固定为1
+TEST(UmeyamaTest, RecoversSimilarityTransform) {
+    Mat3d R = TestRotation();
+    Vec3d t(0.5, 4.0, -1.0);
+    PointPairs pairs(R, t, 2.5, 100, 0.0);
+
+    UmeyamaAligner aligner(true);
+    pairs.AddTo(aligner);
+    EXPECT_NEAR(aligner.Scale(), 2.5, 1e-9);
+    EXPECT_TRUE(aligner.Rotation().isApprox(R, 1e-9));
+    EXPECT_TRUE(aligner.Translation().isApprox(t, 1e-9));
+
+    UmeyamaAligner rigid;
+    pairs.AddTo(rigid);
+    EXPECT_DOUBLE_EQ(rigid.Scale(), 1.0);
+    EXPECT_GT(rigid.SquaredError(), 1.0);
+}
+
+/// 有噪声时与Eigen::umeyama一致，误差平方和与逐点计算一致
+TEST(UmeyamaTest, MatchesEigenAndBruteForceError) {
+    PointPairs pairs(TestRotation(), Vec3d(3.0, 2.0, 1.0), 1.5, 500, 0.05);
+
+    for (bool with_scale : {false, true}) {
+        UmeyamaAligner aligner(with_scale);
+        pairs.AddTo(aligner);
+
+        Eigen::Matrix4d expected = Eigen::umeyama(pairs.x_, pairs.y_, with_scale);
+        EXPECT_TRUE(aligner.Matrix().isApprox(expected, 1e-8)) << with_scale;
+
+        double error = 0;
+        for (int i = 0; i < pairs.x_.cols(); ++i)
+            error += std::pow(aligner.Error(pairs.x_.col(i), pairs.y_.col(i)), 2);
+        EXPECT_NEAR(aligner.SquaredError(), error, 1e-6 * error) << with_scale;
+    }
+}
+
+/// 点对少于3个时只求解平移
+TEST(UmeyamaTest, TranslationOnlyBelowThreePairs) {
+    UmeyamaAligner aligner(true);
+    aligner.Solve();
+    EXPECT_TRUE(aligner.Matrix().isIdentity());
+
+    aligner.Add(Vec3d(0, 0, 0), Vec3d(1, 2, 3));
+    aligner.Add(Vec3d(1, 0, 0), Vec3d(1, 3, 3));
+    aligner.Solve();
+    EXPECT_TRUE(aligner.Rotation().isIdentity());
+    EXPECT_DOUBLE_EQ(aligner.Scale(), 1.0);
+    EXPECT_TRUE(aligner.Translation().isApprox(Vec3d(0.5, 2.5, 3.0)));
+}
+
+/// 重置后清空点对，对齐恢复为单位变换
+TEST(UmeyamaTest, Reset) {
+    UmeyamaAligner aligner;
+    PointPairs(TestRotation(), Vec3d(1, 1, 1), 1.0, 10, 0.0).AddTo(aligner);
+    aligner.Reset();
+    EXPECT_EQ(aligner.Size(), 0u);
+    EXPECT_TRUE(aligner.Matrix().isIdentity());
+    EXPECT_DOUBLE_EQ(aligner.SquaredError(), 0.0);
+
+    Vec3d t(-1, 0, 2);
+    PointPairs(Mat3d::Identity(), t, 1.0, 10, 0.0).AddTo(aligner);
+    EXPECT_TRUE(aligner.Translation().isApprox(t, 1e-9));
+}